@@ -0,0 +1,18 @@
+include(../../common.pri)
+
+TEMPLATE = app
+TARGET = ModbusDiscovery
+CONFIG += console
+CONFIG -= app_bundle
+
+QT -= gui
+QT += qml concurrent
+
+include(../../cutehmi_utils_1_lib/import.pri)
+include(../../cutehmi_base_1_lib/import.pri)
+include(../../cutehmi_services_1_lib/import.pri)
+include(../../libmodbus.pri)
+include(../../cutehmi_modbus_1_lib/import.pri)
+
+SOURCES += \
+    src/main.cpp
@@ -0,0 +1,96 @@
+#include <modbus/internal/DiscoveryScanner.hpp>
+#include <modbus/internal/TCPConnection.hpp>
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include <QElapsedTimer>
+
+#include <memory>
+
+using namespace cutehmi::modbus::internal;
+
+namespace {
+
+/**
+ * Parse list of unit identifiers.
+ * @param list comma-separated list of identifiers and identifier ranges (e.g. "1,5,10-20").
+ * @param ok set to @p false if list could not be parsed.
+ * @return list of unit identifiers.
+ */
+QList<int> ParseUnitIds(const QString & list, bool & ok)
+{
+	QList<int> result;
+	ok = true;
+	for (const QString & item : list.split(',', QString::SkipEmptyParts)) {
+		bool firstOk, lastOk;
+		int first = item.section('-', 0, 0).trimmed().toInt(& firstOk);
+		int last = item.contains('-') ? item.section('-', 1, 1).trimmed().toInt(& lastOk) : first;
+		if (!item.contains('-'))
+			lastOk = firstOk;
+		if (!firstOk || !lastOk || (first < 0) || (last > 255) || (first > last)) {
+			ok = false;
+			return result;
+		}
+		for (int unitId = first; unitId <= last; unitId++)
+			result.append(unitId);
+	}
+	return result;
+}
+
+}
+
+int main(int argc, char * argv[])
+{
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setApplicationName("ModbusDiscovery");
+
+	QCommandLineParser cmd;
+	cmd.setApplicationDescription("Probes Modbus TCP unit identifiers and address spaces and prints register map XML fragment, which can be pasted into client section of cutehmi_modbus_1 project file.");
+	cmd.addHelpOption();
+	QCommandLineOption nodeOption("node", "Host name or address of the device or gateway.", "node", "127.0.0.1");
+	QCommandLineOption serviceOption("service", "Service name or port number.", "service", "502");
+	QCommandLineOption unitsOption("units", "Comma-separated unit identifiers or ranges of identifiers to probe.", "units", "1-247");
+	QCommandLineOption firstOption("first", "First address to probe.", "address", "0");
+	QCommandLineOption countOption("count", "Number of addresses to probe.", "count", QString::number(DiscoveryScanner::ADDR_SPACE_SIZE));
+	QCommandLineOption blockOption("block", "Number of addresses read in single request (1-125).", "size", "100");
+	QCommandLineOption gapOption("min-gap", "Gaps in address space shorter than this size are not searched for readable addresses (1 searches exhaustively).", "size", "8");
+	QCommandLineOption connectionsOption("connections", "Maximal number of simultaneous connections.", "number", "4");
+	QCommandLineOption rateOption("rate", "Maximal number of requests per second (0 disables the limit).", "rate", "0");
+	cmd.addOptions({nodeOption, serviceOption, unitsOption, firstOption, countOption, blockOption, gapOption, connectionsOption, rateOption});
+	cmd.process(app);
+
+	QTextStream err(stderr);
+	bool ok;
+	QList<int> unitIds = ParseUnitIds(cmd.value(unitsOption), ok);
+	if (!ok || unitIds.isEmpty()) {
+		err << "Invalid list of unit identifiers '" << cmd.value(unitsOption) << "'.\n";
+		return EXIT_FAILURE;
+	}
+
+	QString node = cmd.value(nodeOption);
+	QString service = cmd.value(serviceOption);
+	DiscoveryScanner scanner([node, service](int unitId) {
+		return std::unique_ptr<AbstractConnection>(new TCPConnection(node, service, unitId));
+	});
+	scanner.setUnitIds(unitIds);
+	scanner.setAddressRange(cmd.value(firstOption).toInt(), cmd.value(countOption).toInt());
+	scanner.setBlockSize(cmd.value(blockOption).toInt());
+	scanner.setMinGapSize(cmd.value(gapOption).toInt());
+	scanner.setMaxConnections(cmd.value(connectionsOption).toInt());
+	scanner.setMaxRate(cmd.value(rateOption).toDouble());
+
+	err << "Probing " << unitIds.count() << " unit(s) at " << node << ":" << service << "...\n";
+	err.flush();
+	QElapsedTimer elapsed;
+	elapsed.start();
+	QList<DiscoveryScanner::UnitMap> maps = scanner.scan();
+	err << maps.count() << " unit(s) responded within " << elapsed.elapsed() / 1000.0 << " s.\n";
+
+	QTextStream out(stdout);
+	out << DiscoveryScanner::ToXML(maps);
+	return maps.isEmpty() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
@@ -23,7 +23,8 @@ HEADERS += \
     src/charts/DateTimeAxis.hpp \
     src/charts/PlotArea.hpp \
     src/charts/CartesianAxis.hpp \
-    src/charts/TickedAxis.hpp
+    src/charts/TickedAxis.hpp \
+    src/charts/ScatterPlotMaterial.hpp
 
 SOURCES += \
     src/CuteHMIChartsQMLPlugin.cpp \
@@ -33,7 +34,8 @@ SOURCES += \
     src/charts/PlotArea.cpp \
     src/charts/CartesianAxis.cpp \
     src/charts/LinearAxis.cpp \
-    src/charts/TickedAxis.cpp
+    src/charts/TickedAxis.cpp \
+    src/charts/ScatterPlotMaterial.cpp
 
 DISTFILES += \ 
     qmldir \
@@ -1,26 +1,39 @@
 #include "ScatterPlot.hpp"
+#include "ScatterPlotMaterial.hpp"
 
-#include <QPainter>
+#include <QSGGeometryNode>
+#include <qopengl.h>
+
+#include <cstring>
 
 namespace cutehmi {
 namespace charts {
 
 const QColor ScatterPlot::INITIAL_COLOR = Qt::green;
 constexpr qreal ScatterPlot::INITIAL_POINT_SIZE;
+constexpr int ScatterPlot::INITIAL_CAPACITY;
+constexpr qreal ScatterPlot::MAX_ORIGIN_DISTANCE;
 
 ScatterPlot::ScatterPlot(QQuickItem * parent):
-	QQuickPaintedItem(parent),
+	QQuickItem(parent),
 	m_color(INITIAL_COLOR),
 	m_pointSize(INITIAL_POINT_SIZE),
 	m_series(nullptr),
 	m_xAxis(nullptr),
-	m_yAxis(nullptr)
+	m_yAxis(nullptr),
+	m_syncedCount(0),
+	m_pointCount(0),
+	m_rebuild(true)
 {
+	setFlag(ItemHasContents);
+
 	connect(this, & ScatterPlot::colorChanged, this, & QQuickItem::update);
 	connect(this, & ScatterPlot::pointSizeChanged, this, & QQuickItem::update);
 	connect(this, & ScatterPlot::seriesChanged, this, & QQuickItem::update);
 	connect(this, & ScatterPlot::xAxisChanged, this, & QQuickItem::update);
 	connect(this, & ScatterPlot::yAxisChanged, this, & QQuickItem::update);
+	connect(this, & QQuickItem::widthChanged, this, & QQuickItem::update);
+	connect(this, & QQuickItem::heightChanged, this, & QQuickItem::update);
 }
 
 QColor ScatterPlot::color() const
@@ -60,8 +73,12 @@ void ScatterPlot::setSeries(PointSeries * series)
 		if (m_series != nullptr)
 			m_series->disconnect(this);
 		m_series = series;
-		connect(m_series, & PointSeries::dataChanged, this, & QQuickItem::update);
-//		connect(m_series, & PointSeries::dataChanged, this, & ScatterPlot::updatePoints);	//call update from updatePoints
+		if (m_series != nullptr) {
+			connect(m_series, & PointSeries::dataChanged, this, & ScatterPlot::onDataChanged);
+			connect(m_series, & PointSeries::dataAppended, this, & ScatterPlot::onDataAppended);
+			connect(m_series, & PointSeries::dataInserted, this, & ScatterPlot::onDataInserted);
+		}
+		m_rebuild = true;
 		emit seriesChanged();
 	}
 }
@@ -74,6 +91,7 @@ ValueAxis * ScatterPlot::xAxis() const
 void ScatterPlot::setXAxis(ValueAxis * axis)
 {
 	if (m_xAxis != axis) {
+		connectAxis(m_xAxis, axis);
 		m_xAxis = axis;
 		emit xAxisChanged();
 	}
@@ -87,6 +105,7 @@ ValueAxis * ScatterPlot::yAxis() const
 void ScatterPlot::setYAxis(ValueAxis * axis)
 {
 	if (m_yAxis != axis) {
+		connectAxis(m_yAxis, axis);
 		m_yAxis = axis;
 		emit yAxisChanged();
 	}
@@ -97,44 +116,199 @@ void ScatterPlot::setYAxis(ValueAxis * axis)
 //	return m_series;
 //}
 
-void ScatterPlot::paint(QPainter * painter)
-{
-	QPen pen(m_color, m_pointSize);
-	painter->setPen(pen);
-
-	if (m_series != nullptr) {
-//		painter->drawPoints(m_series->rawData(), m_series->count());
-		for (PointSeries::DataContainer::const_iterator it = m_series->data().begin(); it != m_series->data().end(); ++it) {
-//			qDebug() << "drawing point " << it->x() << " " << it->y();
-			QPointF p(*it);
-			if (m_xAxis != nullptr)
-				p.setX(m_xAxis->mapToPlotArea(p.x()));
-			if (m_yAxis != nullptr)
-				p.setY(m_yAxis->mapToPlotArea(p.y()));
-//			qDebug() << "point: " << p;
-//			if (m_xAxis->contentContains(p.x()) && m_yAxis->contentContains(p.y()))
-			if (qIsFinite(p.x()) && qIsFinite(p.y())) {
-				if (p.y() < 0.0)
-					painter->drawLine(p.x() - m_pointSize, m_pointSize / 2.0, p.x() + m_pointSize, m_pointSize / 2.0);
-				else if (p.y() > height())
-					painter->drawLine(p.x() - m_pointSize, height() - m_pointSize / 2.0, p.x() + m_pointSize, height() - m_pointSize / 2.0);
-				else
-					painter->drawPoint(p);
+QSGNode * ScatterPlot::updatePaintNode(QSGNode * oldNode, UpdatePaintNodeData * data)
+{
+	Q_UNUSED(data);
+
+	QSGGeometryNode * node = static_cast<QSGGeometryNode *>(oldNode);
+	if (node == nullptr) {
+		node = new QSGGeometryNode;
+		node->setGeometry(CreateGeometry(0));
+		node->setFlag(QSGNode::OwnsGeometry);
+		node->setMaterial(new ScatterPlotMaterial);
+		node->setFlag(QSGNode::OwnsMaterial);
+		m_rebuild = true;
+	}
+
+	// Vertices are rebuilt around new origin, when visible range has moved away from the current one.
+	if ((m_pointCount > 0) && (IsFar(m_xAxis, m_origin.x()) || IsFar(m_yAxis, m_origin.y())))
+		m_rebuild = true;
+
+	if (m_rebuild) {
+		// Capacity is retained, so that series, which is rebuilt, does not have to grow the buffer again.
+		m_syncedCount = 0;
+		m_pendingPoints.clear();
+		m_origin = QPointF();
+		if (m_pointCount > 0) {
+			std::memset(node->geometry()->indexData(), 0, m_pointCount * ScatterPlotMaterial::INDICES_PER_POINT * sizeof(quint32));
+			node->geometry()->markIndexDataDirty();
+			node->markDirty(QSGNode::DirtyGeometry);
+			m_pointCount = 0;
+		}
+		m_rebuild = false;
+	}
+
+	// Points, which have not been uploaded yet, are appended to the vertices, which are already there. Order of vertices
+	// does not matter, so points inserted in the middle of the series are appended as well.
+	int count = m_series != nullptr ? m_series->count() : 0;
+	if ((count > m_syncedCount) || !m_pendingPoints.isEmpty()) {
+		struct Span
+		{
+			const QPointF * points;
+			int count;
+		};
+		const Span spans[] = {
+			{m_pendingPoints.constData(), m_pendingPoints.count()},
+			{count > m_syncedCount ? m_series->rawData() + m_syncedCount : nullptr, qMax(0, count - m_syncedCount)}
+		};
+
+		int finiteCount = 0;
+		const QPointF * firstFinite = nullptr;
+		for (const Span & span : spans)
+			for (int i = 0; i < span.count; i++)
+				if (qIsFinite(span.points[i].x()) && qIsFinite(span.points[i].y())) {
+					if (firstFinite == nullptr)
+						firstFinite = & span.points[i];
+					finiteCount++;
+				}
+
+		if (finiteCount > 0) {
+			// Vertices are relative to the origin, because single precision floats can not accurately represent large values, such as timestamps.
+			if (m_pointCount == 0)
+				m_origin = QPointF(Origin(m_xAxis, firstFinite->x()), Origin(m_yAxis, firstFinite->y()));
+
+			QSGGeometry * geometry = node->geometry();
+			int capacity = geometry->vertexCount() / ScatterPlotMaterial::VERTICES_PER_POINT;
+			if (m_pointCount + finiteCount > capacity) {
+				capacity = qMax(capacity * 2, INITIAL_CAPACITY);
+				while (capacity < m_pointCount + finiteCount)
+					capacity *= 2;
+				QSGGeometry * oldGeometry = geometry;
+				geometry = CreateGeometry(capacity);
+				if (m_pointCount > 0) {
+					std::memcpy(geometry->vertexData(), oldGeometry->vertexData(), m_pointCount * ScatterPlotMaterial::VERTICES_PER_POINT * sizeof(ScatterPlotMaterial::Vertex));
+					std::memcpy(geometry->indexData(), oldGeometry->indexData(), m_pointCount * ScatterPlotMaterial::INDICES_PER_POINT * sizeof(quint32));
+				}
+				node->setGeometry(geometry);	// Old geometry is deleted, because node owns it.
 			}
+
+			ScatterPlotMaterial::Vertex * vertices = static_cast<ScatterPlotMaterial::Vertex *>(geometry->vertexData()) + m_pointCount * ScatterPlotMaterial::VERTICES_PER_POINT;
+			quint32 * indices = geometry->indexDataAsUInt() + m_pointCount * ScatterPlotMaterial::INDICES_PER_POINT;
+			for (const Span & span : spans)
+				for (int i = 0; i < span.count; i++) {
+					const QPointF & point = span.points[i];
+					if (qIsFinite(point.x()) && qIsFinite(point.y())) {
+						ScatterPlotMaterial::SetPoint(vertices, point.x() - m_origin.x(), point.y() - m_origin.y());
+						ScatterPlotMaterial::SetIndices(indices, m_pointCount);
+						vertices += ScatterPlotMaterial::VERTICES_PER_POINT;
+						indices += ScatterPlotMaterial::INDICES_PER_POINT;
+						m_pointCount++;
+					}
+				}
+			geometry->markVertexDataDirty();
+			geometry->markIndexDataDirty();
+			node->markDirty(QSGNode::DirtyGeometry);
 		}
+		m_pendingPoints.clear();
+		m_syncedCount = count;
+	}
+
+	// Axis mapping is applied by vertex shader, so only uniforms are updated, when axes change.
+	qreal xScale, xOffset, yScale, yOffset;
+	AxisTransform(m_xAxis, m_origin.x(), xScale, xOffset);
+	AxisTransform(m_yAxis, m_origin.y(), yScale, yOffset);
+	ScatterPlotMaterial * material = static_cast<ScatterPlotMaterial *>(node->material());
+	material->setColor(m_color);
+	material->setPointSize(m_pointSize);
+	material->setTransform(QVector4D(xScale, yScale, xOffset, yOffset));
+	material->setArea(QVector2D(width(), height()));
+	node->markDirty(QSGNode::DirtyMaterial);
+
+	return node;
+}
+
+void ScatterPlot::onDataChanged()
+{
+	m_rebuild = true;
+	update();
+}
+
+void ScatterPlot::onDataAppended(int index, int count)
+{
+	Q_UNUSED(count);
+
+	// Appended points are uploaded incrementally, unless points, which have been uploaded already, are affected.
+	if (index < m_syncedCount)
+		m_rebuild = true;
+	update();
+}
+
+void ScatterPlot::onDataInserted(int index, int count)
+{
+	// Points inserted into the part of the series, which has been uploaded already, are copied, so that they can be
+	// uploaded without rebuilding whole vertex buffer. Points inserted into the rest of the series are uploaded with it.
+	if (index < m_syncedCount) {
+		m_pendingPoints += m_series->data().mid(index, count);
+		m_syncedCount += count;
 	}
+	update();
+}
+
+QSGGeometry * ScatterPlot::CreateGeometry(int capacity)
+{
+	QSGGeometry * geometry = new QSGGeometry(ScatterPlotMaterial::Attributes(), capacity * ScatterPlotMaterial::VERTICES_PER_POINT, capacity * ScatterPlotMaterial::INDICES_PER_POINT, GL_UNSIGNED_INT);
+	geometry->setDrawingMode(GL_TRIANGLES);
+	// Vertices are appended to the buffer, while the buffer is being reused.
+	geometry->setVertexDataPattern(QSGGeometry::DynamicPattern);
+	geometry->setIndexDataPattern(QSGGeometry::DynamicPattern);
+	if (capacity > 0)
+		std::memset(geometry->indexData(), 0, geometry->indexCount() * sizeof(quint32));
+	return geometry;
+}
+
+bool ScatterPlot::IsFar(const ValueAxis * axis, qreal origin)
+{
+	if (axis == nullptr)
+		return false;
+
+	qreal width = qAbs(axis->to() - axis->from());
+	if (width <= 0.0)
+		return false;
 
-	/*
-	const int pointNum = 10000;
-	QPoint * points = new QPoint[pointNum];
-	for (int i = 0; i < pointNum; i++) {
-		points[i].setX(qrand() % 1900);
-		points[i].setY(qrand() % 1000);
+	return qAbs((axis->from() + axis->to()) / 2.0 - origin) > MAX_ORIGIN_DISTANCE * width;
+}
+
+qreal ScatterPlot::Origin(const ValueAxis * axis, qreal fallback)
+{
+	if (axis == nullptr)
+		return fallback;
+
+	return (axis->from() + axis->to()) / 2.0;
+}
+
+void ScatterPlot::AxisTransform(const ValueAxis * axis, qreal origin, qreal & scale, qreal & offset)
+{
+	if (axis == nullptr) {
+		scale = 1.0;
+		offset = origin;
+	} else {
+		scale = (axis->to() != axis->from()) ? (axis->mapToPlotArea(axis->to()) - axis->mapToPlotArea(axis->from())) / (axis->to() - axis->from()) : 0.0;
+		offset = axis->mapToPlotArea(origin);
+	}
+}
+
+void ScatterPlot::connectAxis(ValueAxis * oldAxis, ValueAxis * newAxis)
+{
+	// Range of the axis or its size may change, while the axis remains the same object.
+	if (oldAxis != nullptr)
+		oldAxis->disconnect(this);
+	if (newAxis != nullptr) {
+		connect(newAxis, & ValueAxis::fromChanged, this, & QQuickItem::update);
+		connect(newAxis, & ValueAxis::toChanged, this, & QQuickItem::update);
+		connect(newAxis, & QQuickItem::widthChanged, this, & QQuickItem::update);
+		connect(newAxis, & QQuickItem::heightChanged, this, & QQuickItem::update);
+		connect(newAxis, & ValueAxis::plotAreaChanged, this, & QQuickItem::update);
 	}
-//	painter->drawPoint(100, 100);
-	painter->drawPoints(points, pointNum);
-	delete[] points;
-	*/
 }
 
 }
@@ -1,7 +1,8 @@
 #ifndef CUTEHMI_QML_CUTEHMI_CHARTS_SRC_CHARTS_SCATTERPLOT_HPP
 #define CUTEHMI_QML_CUTEHMI_CHARTS_SRC_CHARTS_SCATTERPLOT_HPP
 
-#include <QQuickPaintedItem>
+#include <QQuickItem>
+#include <QSGGeometry>
 #include <QColor>
 #include <QVector>
 #include <QPoint>
@@ -15,12 +16,17 @@ namespace cutehmi {
 namespace charts {
 
 /**
- * Scatter plot.
+ * Scatter plot. Plot is rendered by scene graph. Data points are uploaded to a vertex buffer and they are mapped to the
+ * plot by vertex shader, so changing range of the axes does not require vertices to be rebuilt. Data appended to the
+ * series is uploaded incrementally. Capacity of the vertex buffer is doubled, whenever it runs out of space, so that
+ * appending data does not reallocate the buffer each time. Axes are assumed to map values linearly.
  *
- * @todo use QSG* and subclass QQuickItem instead of QQuickPaintedItem.
+ * Vertices hold single precision coordinates relative to an origin, which is placed in the middle of visible range of
+ * the axes. Precision of single precision floats decreases with distance from the origin, so vertices are rebuilt
+ * around a new origin, once visible range moves too far away from the origin, compared to its width.
  */
 class ScatterPlot:
-		public QQuickPaintedItem
+		public QQuickItem
 {
 	Q_OBJECT
 
@@ -58,8 +64,6 @@ class ScatterPlot:
 
 		void setYAxis(ValueAxis * axis);
 
-		void paint(QPainter * painter);
-
 	signals:
 		void colorChanged();
 
@@ -71,15 +75,75 @@ class ScatterPlot:
 
 		void yAxisChanged();
 
+	protected:
+		QSGNode * updatePaintNode(QSGNode * oldNode, UpdatePaintNodeData * data) override;
+
+	protected slots:
+		void onDataChanged();
+
+		void onDataAppended(int index, int count);
+
+		void onDataInserted(int index, int count);
+
 	private:
 		typedef QVector<QPointF> PointsContainer;
 
+		static constexpr int INITIAL_CAPACITY = 1024;	///< Initial capacity of the vertex buffer in points.
+
+		/**
+		 * Maximal distance between origin and the middle of visible range of an axis, expressed in widths of the visible
+		 * range. Single precision floats carry 24 significant bits, so with the origin within this distance visible points
+		 * are placed with rounding error below 1/16384 of visible range (2^-24 * 1024 visible ranges).
+		 */
+		static constexpr qreal MAX_ORIGIN_DISTANCE = 1024.0;
+
+		/**
+		 * Check whether origin is too far from visible range of an axis.
+		 * @param axis axis.
+		 * @param origin origin coordinate along the axis.
+		 * @return @p true if distance between origin and the middle of visible range of the axis exceeds
+		 * MAX_ORIGIN_DISTANCE widths of the visible range, @p false otherwise or if axis is @p nullptr.
+		 */
+		static bool IsFar(const ValueAxis * axis, qreal origin);
+
+		/**
+		 * Get origin coordinate along an axis.
+		 * @param axis axis.
+		 * @param fallback coordinate used if axis is @p nullptr.
+		 * @return middle of visible range of the axis or @a fallback if axis is @p nullptr.
+		 */
+		static qreal Origin(const ValueAxis * axis, qreal fallback);
+
+		/**
+		 * Create geometry. Indices of all the points are set to zero, so that points, which have not been filled, form
+		 * degenerate triangles, which are not rasterized.
+		 * @param capacity number of points, which geometry can hold.
+		 * @return geometry.
+		 */
+		static QSGGeometry * CreateGeometry(int capacity);
+
+		/**
+		 * Compute transform of an axis.
+		 * @param axis axis.
+		 * @param origin data value corresponding to relative coordinate @p 0.
+		 * @param scale scale factor.
+		 * @param offset offset.
+		 */
+		static void AxisTransform(const ValueAxis * axis, qreal origin, qreal & scale, qreal & offset);
+
+		void connectAxis(ValueAxis * oldAxis, ValueAxis * newAxis);
+
 		QColor m_color;
 		qreal m_pointSize;
 		PointSeries * m_series;
 		ValueAxis * m_xAxis;
 		ValueAxis * m_yAxis;
 //		PointsContainer m_points;	// Points cache.
+		QPointF m_origin;	///< Origin of relative coordinates of vertices.
+		int m_syncedCount;	///< Number of series points, which have been uploaded to the vertex buffer.
+		int m_pointCount;	///< Number of points stored in the vertex buffer.
+		PointsContainer m_pendingPoints;	///< Points inserted before points, which have been uploaded, waiting to be uploaded.
+		bool m_rebuild;	///< Whether vertex buffer has to be rebuilt from scratch.
 };
 
 }
@@ -0,0 +1,190 @@
+#include "ScatterPlotMaterial.hpp"
+
+#include <QSGMaterialShader>
+#include <QOpenGLShaderProgram>
+#include <qopengl.h>
+
+namespace cutehmi {
+namespace charts {
+
+namespace {
+
+class ScatterPlotShader:
+		public QSGMaterialShader
+{
+	public:
+		const char * const * attributeNames() const override
+		{
+			static const char * const NAMES[] = {"vertex", nullptr};
+			return NAMES;
+		}
+
+		void updateState(const RenderState & state, QSGMaterial * newMaterial, QSGMaterial * oldMaterial) override
+		{
+			Q_UNUSED(oldMaterial);
+
+			if (state.isMatrixDirty())
+				program()->setUniformValue(m_matrixId, state.combinedMatrix());
+			if (state.isOpacityDirty())
+				program()->setUniformValue(m_opacityId, state.opacity());
+
+			const ScatterPlotMaterial * material = static_cast<const ScatterPlotMaterial *>(newMaterial);
+			const QColor & color = material->color();
+			// Scene graph expects premultiplied alpha.
+			program()->setUniformValue(m_colorId, QVector4D(color.redF() * color.alphaF(), color.greenF() * color.alphaF(), color.blueF() * color.alphaF(), color.alphaF()));
+			program()->setUniformValue(m_pointSizeId, static_cast<GLfloat>(material->pointSize()));
+			program()->setUniformValue(m_transformId, material->transform());
+			program()->setUniformValue(m_areaId, material->area());
+		}
+
+	protected:
+		const char * vertexShader() const override
+		{
+			return	"attribute highp vec4 vertex;\n"
+					"uniform highp mat4 qt_Matrix;\n"
+					"uniform highp vec4 transform;\n"
+					"uniform highp vec2 area;\n"
+					"uniform highp float pointSize;\n"
+					"void main() {\n"
+					"	highp vec2 pos = vertex.xy * transform.xy + transform.zw;\n"
+					"	highp float radius = pointSize * 0.5;\n"
+					"	highp vec2 corner = vertex.zw * radius;\n"
+					"	if (pos.x < -radius || pos.x > area.x + radius)\n"
+					"		corner = vec2(0.0, 0.0);\n"	// Degenerate quad is not rasterized.
+					"	else if (pos.y < 0.0 || pos.y > area.y) {\n"
+					"		pos.y = clamp(pos.y, radius, area.y - radius);\n"	// Marker at the edge.
+					"		corner.x *= 2.0;\n"
+					"	}\n"
+					"	gl_Position = qt_Matrix * vec4(pos + corner, 0.0, 1.0);\n"
+					"}\n";
+		}
+
+		const char * fragmentShader() const override
+		{
+			return	"uniform lowp vec4 color;\n"
+					"uniform lowp float qt_Opacity;\n"
+					"void main() {\n"
+					"	gl_FragColor = color * qt_Opacity;\n"
+					"}\n";
+		}
+
+		void initialize() override
+		{
+			m_matrixId = program()->uniformLocation("qt_Matrix");
+			m_opacityId = program()->uniformLocation("qt_Opacity");
+			m_colorId = program()->uniformLocation("color");
+			m_pointSizeId = program()->uniformLocation("pointSize");
+			m_transformId = program()->uniformLocation("transform");
+			m_areaId = program()->uniformLocation("area");
+		}
+
+	private:
+		int m_matrixId;
+		int m_opacityId;
+		int m_colorId;
+		int m_pointSizeId;
+		int m_transformId;
+		int m_areaId;
+};
+
+}
+
+constexpr int ScatterPlotMaterial::VERTICES_PER_POINT;
+constexpr int ScatterPlotMaterial::INDICES_PER_POINT;
+
+const QSGGeometry::AttributeSet & ScatterPlotMaterial::Attributes()
+{
+	static QSGGeometry::Attribute attributes[] = {QSGGeometry::Attribute::create(0, 4, GL_FLOAT, true)};
+	static QSGGeometry::AttributeSet attributeSet = {1, sizeof(Vertex), attributes};
+	return attributeSet;
+}
+
+void ScatterPlotMaterial::SetPoint(Vertex * vertices, float x, float y)
+{
+	static const float CORNERS[VERTICES_PER_POINT][2] = {{-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f}};
+
+	for (int i = 0; i < VERTICES_PER_POINT; i++)
+		vertices[i] = Vertex{x, y, CORNERS[i][0], CORNERS[i][1]};
+}
+
+void ScatterPlotMaterial::SetIndices(quint32 * indices, int point)
+{
+	// Two triangles forming a quad.
+	static const quint32 CORNERS[INDICES_PER_POINT] = {0, 1, 2, 0, 2, 3};
+
+	quint32 first = static_cast<quint32>(point) * VERTICES_PER_POINT;
+	for (int i = 0; i < INDICES_PER_POINT; i++)
+		indices[i] = first + CORNERS[i];
+}
+
+ScatterPlotMaterial::ScatterPlotMaterial():
+	m_color(Qt::green),
+	m_pointSize(1.0),
+	m_transform(1.0f, 1.0f, 0.0f, 0.0f)
+{
+	// Vertices hold data coordinates, so renderer must not merge them with other geometries by transforming them on CPU.
+	setFlag(Blending | RequiresFullMatrix);
+}
+
+QSGMaterialType * ScatterPlotMaterial::type() const
+{
+	static QSGMaterialType type;
+	return & type;
+}
+
+QSGMaterialShader * ScatterPlotMaterial::createShader() const
+{
+	return new ScatterPlotShader;
+}
+
+int ScatterPlotMaterial::compare(const QSGMaterial * other) const
+{
+	// Materials of different plots are never equal, so their geometries are not batched together.
+	return this == other ? 0 : (this < other ? -1 : 1);
+}
+
+const QColor & ScatterPlotMaterial::color() const
+{
+	return m_color;
+}
+
+void ScatterPlotMaterial::setColor(const QColor & color)
+{
+	m_color = color;
+}
+
+qreal ScatterPlotMaterial::pointSize() const
+{
+	return m_pointSize;
+}
+
+void ScatterPlotMaterial::setPointSize(qreal size)
+{
+	m_pointSize = size;
+}
+
+const QVector4D & ScatterPlotMaterial::transform() const
+{
+	return m_transform;
+}
+
+void ScatterPlotMaterial::setTransform(const QVector4D & transform)
+{
+	m_transform = transform;
+}
+
+const QVector2D & ScatterPlotMaterial::area() const
+{
+	return m_area;
+}
+
+void ScatterPlotMaterial::setArea(const QVector2D & area)
+{
+	m_area = area;
+}
+
+}
+}
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
@@ -0,0 +1,106 @@
+#ifndef CUTEHMI_QML_CUTEHMI_CHARTS_SRC_CHARTS_SCATTERPLOTMATERIAL_HPP
+#define CUTEHMI_QML_CUTEHMI_CHARTS_SRC_CHARTS_SCATTERPLOTMATERIAL_HPP
+
+#include <QSGMaterial>
+#include <QSGGeometry>
+#include <QColor>
+#include <QVector2D>
+#include <QVector4D>
+
+namespace cutehmi {
+namespace charts {
+
+/**
+ * Scatter plot material. Each point is drawn as an indexed quad made of two triangles, which makes rendering independent of
+ * point size limits of OpenGL implementation (e.g. Mesa software rasterizer). Vertices carry data coordinates, which are mapped
+ * to item coordinates in vertex shader, so that changes of axes require only uniforms to be updated.
+ */
+class ScatterPlotMaterial:
+		public QSGMaterial
+{
+	public:
+		/**
+		 * Vertex. Data coordinates are relative to an origin, which is chosen by the user of the material, because single
+		 * precision floats can not accurately represent large values, such as timestamps.
+		 */
+		struct Vertex
+		{
+			float x;	///< Data x coordinate relative to origin.
+			float y;	///< Data y coordinate relative to origin.
+			float cornerX;	///< Horizontal direction of the corner of a quad (-1.0 or 1.0).
+			float cornerY;	///< Vertical direction of the corner of a quad (-1.0 or 1.0).
+		};
+
+		static constexpr int VERTICES_PER_POINT = 4;
+
+		static constexpr int INDICES_PER_POINT = 6;
+
+		/**
+		 * Get attribute set matching Vertex layout.
+		 * @return attribute set.
+		 */
+		static const QSGGeometry::AttributeSet & Attributes();
+
+		/**
+		 * Fill vertices of a point.
+		 * @param vertices pointer to the vertex array. VERTICES_PER_POINT vertices are written.
+		 * @param x data x coordinate relative to origin.
+		 * @param y data y coordinate relative to origin.
+		 */
+		static void SetPoint(Vertex * vertices, float x, float y);
+
+		/**
+		 * Fill indices of a point.
+		 * @param indices pointer to the index array. INDICES_PER_POINT indices are written.
+		 * @param point index of the point in the vertex array.
+		 */
+		static void SetIndices(quint32 * indices, int point);
+
+		ScatterPlotMaterial();
+
+		QSGMaterialType * type() const override;
+
+		QSGMaterialShader * createShader() const override;
+
+		int compare(const QSGMaterial * other) const override;
+
+		const QColor & color() const;
+
+		void setColor(const QColor & color);
+
+		qreal pointSize() const;
+
+		void setPointSize(qreal size);
+
+		/**
+		 * Get transform.
+		 * @return transform, which maps relative data coordinates to item coordinates. Components @a x and @a y hold
+		 * scale factors, while components @a z and @a w hold offsets.
+		 */
+		const QVector4D & transform() const;
+
+		void setTransform(const QVector4D & transform);
+
+		/**
+		 * Get area.
+		 * @return size of the item. Points, which do not fit horizontally, are not drawn. Points, which do not fit
+		 * vertically, are drawn as wide markers at the edge.
+		 */
+		const QVector2D & area() const;
+
+		void setArea(const QVector2D & area);
+
+	private:
+		QColor m_color;
+		qreal m_pointSize;
+		QVector4D m_transform;
+		QVector2D m_area;
+};
+
+}
+}
+
+#endif
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
@@ -20,14 +20,16 @@ HEADERS += \
     src/cutehmi/modbus/qml/HoldingRegisterController.hpp \
     src/cutehmi/modbus/qml/CoilController.hpp \
     src/cutehmi/modbus/qml/DiscreteInputController.hpp \
-    src/cutehmi/modbus/qml/InputRegisterController.hpp
+    src/cutehmi/modbus/qml/InputRegisterController.hpp \
+    src/cutehmi/modbus/qml/RegisterTableModel.hpp
 
 SOURCES += \
     src/CuteHMIModbusQMLPlugin.cpp \
     src/cutehmi/modbus/qml/HoldingRegisterController.cpp \
     src/cutehmi/modbus/qml/CoilController.cpp \
     src/cutehmi/modbus/qml/DiscreteInputController.cpp \
-    src/cutehmi/modbus/qml/InputRegisterController.cpp
+    src/cutehmi/modbus/qml/InputRegisterController.cpp \
+    src/cutehmi/modbus/qml/RegisterTableModel.cpp
 
 DISTFILES += \ 
     qmldir \
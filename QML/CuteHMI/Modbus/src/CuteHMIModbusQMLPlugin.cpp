@@ -3,6 +3,7 @@
 #include "cutehmi/modbus/qml/DiscreteInputController.hpp"
 #include "cutehmi/modbus/qml/HoldingRegisterController.hpp"
 #include "cutehmi/modbus/qml/InputRegisterController.hpp"
+#include "cutehmi/modbus/qml/RegisterTableModel.hpp"
 
 #include <modbus/HoldingRegister.hpp>
 #include <modbus/InputRegister.hpp>
@@ -27,6 +28,7 @@ void CuteHMIModbusQMLPlugin::registerTypes(const char * uri)
 	qmlRegisterType<cutehmi::modbus::qml::InputRegisterController>(uri, 1, 0, "InputRegisterController");
 	qmlRegisterType<cutehmi::modbus::qml::DiscreteInputController>(uri, 1, 0, "DiscreteInputController");
 	qmlRegisterType<cutehmi::modbus::qml::CoilController>(uri, 1, 0, "CoilController");
+	qmlRegisterType<cutehmi::modbus::qml::RegisterTableModel>(uri, 1, 0, "RegisterTableModel");
 }
 
 //(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
@@ -10,6 +10,7 @@ CoilController::CoilController(QObject * parent):
 	m_address(0),
 	m_value(false),
 	m_busy(true),
+	m_quality(Coil::STALE),
 	m_coil(nullptr)
 {
 }
@@ -32,6 +33,7 @@ void CoilController::setDevice(AbstractDevice * device)
 			setupCoil(m_device->bAt(m_address));
 		emit deviceChanged();
 		updateValue();
+		updateQuality();
 	}
 }
 
@@ -48,6 +50,7 @@ void CoilController::setAddress(int address)
 			setupCoil(m_device->bAt(m_address));
 		emit addressChanged();
 		updateValue();
+		updateQuality();
 	}
 }
 
@@ -67,6 +70,16 @@ bool CoilController::busy() const
 	return m_busy;
 }
 
+Coil::quality_t CoilController::quality() const
+{
+	return m_quality;
+}
+
+QDateTime CoilController::timestamp() const
+{
+	return m_timestamp;
+}
+
 void CoilController::onValueRequested()
 {
 	setBusy(true);
@@ -82,6 +95,11 @@ void CoilController::onValueUpdated()
 	setBusy(false);
 }
 
+void CoilController::onQualityChanged()
+{
+	updateQuality();
+}
+
 void CoilController::setBusy(bool busy)
 {
 	if (m_busy != busy) {
@@ -99,18 +117,38 @@ void CoilController::updateValue()
 		m_value = m_coil->value();
 		emit valueChanged();
 	}
+
+	QDateTime newTimestamp = m_coil->timestamp();
+	if (m_timestamp != newTimestamp) {
+		m_timestamp = newTimestamp;
+		emit timestampChanged();
+	}
+}
+
+void CoilController::updateQuality()
+{
+	if (m_coil == nullptr)
+		return;
+
+	Coil::quality_t newQuality = m_coil->quality();
+	if (m_quality != newQuality) {
+		m_quality = newQuality;
+		emit qualityChanged();
+	}
 }
 
 void CoilController::setupCoil(Coil * reg)
 {
 	if (m_coil != nullptr) {
 		disconnect(m_coil, & Coil::valueUpdated, this, & CoilController::onValueUpdated);
+		disconnect(m_coil, & Coil::qualityChanged, this, & CoilController::onQualityChanged);
 		disconnect(m_coil, & Coil::valueRequested, this, & CoilController::onValueRequested);
 		m_coil->rest();
 	}
 	m_coil = reg;
 	if (m_coil != nullptr) {
 		connect(m_coil, & Coil::valueUpdated, this, & CoilController::onValueUpdated);
+		connect(m_coil, & Coil::qualityChanged, this, & CoilController::onQualityChanged);
 		connect(m_coil, & Coil::valueRequested, this, & CoilController::onValueRequested);
 		m_coil->awake();
 	}
@@ -4,6 +4,7 @@
 #include <modbus/AbstractDevice.hpp>
 
 #include <QObject>
+#include <QDateTime>
 
 namespace cutehmi {
 namespace modbus {
@@ -19,6 +20,8 @@ class CoilController:
 		Q_PROPERTY(int address READ address WRITE setAddress NOTIFY addressChanged)
 		Q_PROPERTY(bool value READ value WRITE setValue NOTIFY valueChanged)
 		Q_PROPERTY(bool busy READ busy NOTIFY busyChanged)
+		Q_PROPERTY(Coil::quality_t quality READ quality NOTIFY qualityChanged)
+		Q_PROPERTY(QDateTime timestamp READ timestamp NOTIFY timestampChanged)
 
 		CoilController(QObject * parent = 0);
 
@@ -39,6 +42,10 @@ class CoilController:
 
 		bool busy() const;
 
+		Coil::quality_t quality() const;
+
+		QDateTime timestamp() const;
+
 	signals:
 		void deviceChanged();
 
@@ -50,16 +57,24 @@ class CoilController:
 
 		void busyChanged();
 
+		void qualityChanged();
+
+		void timestampChanged();
+
 	protected slots:
 		void onValueRequested();
 
 		void onValueUpdated();
 
+		void onQualityChanged();
+
 	protected:
 		void setBusy(bool busy);
 
 		void updateValue();
 
+		void updateQuality();
+
 	private:
 		void setupCoil(Coil * reg);
 
@@ -68,6 +83,8 @@ class CoilController:
 		int m_address;
 		qreal m_value;
 		bool m_busy;
+		Coil::quality_t m_quality;
+		QDateTime m_timestamp;
 		Coil * m_coil;
 };
 
@@ -10,6 +10,7 @@ DiscreteInputController::DiscreteInputController(QObject * parent):
 	m_address(0),
 	m_value(false),
 	m_busy(true),
+	m_quality(DiscreteInput::STALE),
 	m_input(nullptr)
 {
 }
@@ -32,6 +33,7 @@ void DiscreteInputController::setDevice(AbstractDevice * device)
 			setupInput(m_device->ibAt(m_address));
 		emit deviceChanged();
 		updateValue();
+		updateQuality();
 	}
 }
 
@@ -48,6 +50,7 @@ void DiscreteInputController::setAddress(int address)
 			setupInput(m_device->ibAt(m_address));
 		emit addressChanged();
 		updateValue();
+		updateQuality();
 	}
 }
 
@@ -61,6 +64,16 @@ bool DiscreteInputController::busy() const
 	return m_busy;
 }
 
+DiscreteInput::quality_t DiscreteInputController::quality() const
+{
+	return m_quality;
+}
+
+QDateTime DiscreteInputController::timestamp() const
+{
+	return m_timestamp;
+}
+
 void DiscreteInputController::onValueUpdated()
 {
 	updateValue();
@@ -68,6 +81,11 @@ void DiscreteInputController::onValueUpdated()
 	setBusy(false);
 }
 
+void DiscreteInputController::onQualityChanged()
+{
+	updateQuality();
+}
+
 void DiscreteInputController::setBusy(bool busy)
 {
 	if (m_busy != busy) {
@@ -85,17 +103,37 @@ void DiscreteInputController::updateValue()
 		m_value = m_input->value();
 		emit valueChanged();
 	}
+
+	QDateTime newTimestamp = m_input->timestamp();
+	if (m_timestamp != newTimestamp) {
+		m_timestamp = newTimestamp;
+		emit timestampChanged();
+	}
+}
+
+void DiscreteInputController::updateQuality()
+{
+	if (m_input == nullptr)
+		return;
+
+	DiscreteInput::quality_t newQuality = m_input->quality();
+	if (m_quality != newQuality) {
+		m_quality = newQuality;
+		emit qualityChanged();
+	}
 }
 
 void DiscreteInputController::setupInput(DiscreteInput * input)
 {
 	if (m_input != nullptr) {
 		disconnect(m_input, & DiscreteInput::valueUpdated, this, & DiscreteInputController::onValueUpdated);
+		disconnect(m_input, & DiscreteInput::qualityChanged, this, & DiscreteInputController::onQualityChanged);
 		m_input->rest();
 	}
 	m_input = input;
 	if (m_input != nullptr) {
 		connect(m_input, & DiscreteInput::valueUpdated, this, & DiscreteInputController::onValueUpdated);
+		connect(m_input, & DiscreteInput::qualityChanged, this, & DiscreteInputController::onQualityChanged);
 		m_input->awake();
 	}
 }
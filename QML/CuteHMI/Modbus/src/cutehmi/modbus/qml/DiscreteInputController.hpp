@@ -4,6 +4,7 @@
 #include <modbus/AbstractDevice.hpp>
 
 #include <QObject>
+#include <QDateTime>
 
 namespace cutehmi {
 namespace modbus {
@@ -19,6 +20,8 @@ class DiscreteInputController:
 		Q_PROPERTY(int address READ address WRITE setAddress NOTIFY addressChanged)
 		Q_PROPERTY(bool value READ value NOTIFY valueChanged)
 		Q_PROPERTY(bool busy READ busy NOTIFY busyChanged)
+		Q_PROPERTY(DiscreteInput::quality_t quality READ quality NOTIFY qualityChanged)
+		Q_PROPERTY(QDateTime timestamp READ timestamp NOTIFY timestampChanged)
 
 		DiscreteInputController(QObject * parent = 0);
 
@@ -37,6 +40,10 @@ class DiscreteInputController:
 
 		bool busy() const;
 
+		DiscreteInput::quality_t quality() const;
+
+		QDateTime timestamp() const;
+
 	signals:
 		void deviceChanged();
 
@@ -48,14 +55,22 @@ class DiscreteInputController:
 
 		void busyChanged();
 
+		void qualityChanged();
+
+		void timestampChanged();
+
 	protected slots:
 		void onValueUpdated();
 
+		void onQualityChanged();
+
 	protected:
 		void setBusy(bool busy);
 
 		void updateValue();
 
+		void updateQuality();
+
 	private:
 		void setupInput(DiscreteInput * input);
 
@@ -64,6 +79,8 @@ class DiscreteInputController:
 		int m_address;
 		bool m_value;
 		bool m_busy;
+		DiscreteInput::quality_t m_quality;
+		QDateTime m_timestamp;
 		DiscreteInput * m_input;
 };
 
@@ -12,6 +12,7 @@ HoldingRegisterController::HoldingRegisterController(QObject * parent):
 	m_valueScale(1.0),
 	m_encoding(HoldingRegister::INT16),
 	m_busy(true),
+	m_quality(HoldingRegister::STALE),
 	m_register(nullptr)
 {
 }
@@ -34,6 +35,7 @@ void HoldingRegisterController::setDevice(AbstractDevice * device)
 			setupRegister(m_device->rAt(m_address));
 		emit deviceChanged();
 		updateValue();
+		updateQuality();
 	}
 }
 
@@ -50,6 +52,7 @@ void HoldingRegisterController::setAddress(int address)
 			setupRegister(m_device->rAt(m_address));
 		emit addressChanged();
 		updateValue();
+		updateQuality();
 	}
 }
 
@@ -95,6 +98,16 @@ bool HoldingRegisterController::busy() const
 	return m_busy;
 }
 
+HoldingRegister::quality_t HoldingRegisterController::quality() const
+{
+	return m_quality;
+}
+
+QDateTime HoldingRegisterController::timestamp() const
+{
+	return m_timestamp;
+}
+
 void HoldingRegisterController::onValueRequested()
 {
 	setBusy(true);
@@ -110,6 +123,11 @@ void HoldingRegisterController::onValueUpdated()
 	setBusy(false);
 }
 
+void HoldingRegisterController::onQualityChanged()
+{
+	updateQuality();
+}
+
 void HoldingRegisterController::setBusy(bool busy)
 {
 	if (m_busy != busy) {
@@ -128,18 +146,38 @@ void HoldingRegisterController::updateValue()
 		m_value = newValue;
 		emit valueChanged();
 	}
+
+	QDateTime newTimestamp = m_register->timestamp();
+	if (m_timestamp != newTimestamp) {
+		m_timestamp = newTimestamp;
+		emit timestampChanged();
+	}
+}
+
+void HoldingRegisterController::updateQuality()
+{
+	if (m_register == nullptr)
+		return;
+
+	HoldingRegister::quality_t newQuality = m_register->quality();
+	if (m_quality != newQuality) {
+		m_quality = newQuality;
+		emit qualityChanged();
+	}
 }
 
 void HoldingRegisterController::setupRegister(HoldingRegister * reg)
 {
 	if (m_register != nullptr) {
 		disconnect(m_register, & HoldingRegister::valueUpdated, this, & HoldingRegisterController::onValueUpdated);
+		disconnect(m_register, & HoldingRegister::qualityChanged, this, & HoldingRegisterController::onQualityChanged);
 		disconnect(m_register, & HoldingRegister::valueRequested, this, & HoldingRegisterController::onValueRequested);
 		m_register->rest();
 	}
 	m_register = reg;
 	if (m_register != nullptr) {
 		connect(m_register, & HoldingRegister::valueUpdated, this, & HoldingRegisterController::onValueUpdated);
+		connect(m_register, & HoldingRegister::qualityChanged, this, & HoldingRegisterController::onQualityChanged);
 		connect(m_register, & HoldingRegister::valueRequested, this, & HoldingRegisterController::onValueRequested);
 		m_register->awake();
 	}
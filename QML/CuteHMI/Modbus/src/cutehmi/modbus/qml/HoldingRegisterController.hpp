@@ -4,6 +4,7 @@
 #include <modbus/AbstractDevice.hpp>
 
 #include <QObject>
+#include <QDateTime>
 
 namespace cutehmi {
 namespace modbus {
@@ -21,6 +22,8 @@ class HoldingRegisterController:
 		Q_PROPERTY(qreal valueScale READ valueScale WRITE setValueScale NOTIFY valueScaleChanged)
 		Q_PROPERTY(HoldingRegister::encoding_t encoding READ encoding WRITE setEncoding NOTIFY encodingChanged)
 		Q_PROPERTY(bool busy READ busy NOTIFY busyChanged)
+		Q_PROPERTY(HoldingRegister::quality_t quality READ quality NOTIFY qualityChanged)
+		Q_PROPERTY(QDateTime timestamp READ timestamp NOTIFY timestampChanged)
 
 		HoldingRegisterController(QObject * parent = 0);
 
@@ -49,6 +52,10 @@ class HoldingRegisterController:
 
 		bool busy() const;
 
+		HoldingRegister::quality_t quality() const;
+
+		QDateTime timestamp() const;
+
 	signals:
 		void deviceChanged();
 
@@ -64,16 +71,24 @@ class HoldingRegisterController:
 
 		void busyChanged();
 
+		void qualityChanged();
+
+		void timestampChanged();
+
 	protected slots:
 		void onValueRequested();
 
 		void onValueUpdated();
 
+		void onQualityChanged();
+
 	protected:
 		void setBusy(bool busy);
 
 		void updateValue();
 
+		void updateQuality();
+
 	private:
 		void setupRegister(HoldingRegister * reg);
 
@@ -84,6 +99,8 @@ class HoldingRegisterController:
 		qreal m_valueScale;
 		HoldingRegister::encoding_t m_encoding;
 		bool m_busy;
+		HoldingRegister::quality_t m_quality;
+		QDateTime m_timestamp;
 		HoldingRegister * m_register;
 };
 
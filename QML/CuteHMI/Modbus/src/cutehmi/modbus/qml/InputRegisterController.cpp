@@ -12,6 +12,7 @@ InputRegisterController::InputRegisterController(QObject * parent):
 	m_valueScale(1.0),
 	m_encoding(InputRegister::INT16),
 	m_busy(true),
+	m_quality(InputRegister::STALE),
 	m_register(nullptr)
 {
 }
@@ -34,6 +35,7 @@ void InputRegisterController::setDevice(cutehmi::modbus::AbstractDevice * device
 			setupRegister(m_device->irAt(m_address));
 		emit deviceChanged();
 		updateValue();
+		updateQuality();
 	}
 }
 
@@ -50,6 +52,7 @@ void InputRegisterController::setAddress(int address)
 			setupRegister(m_device->irAt(m_address));
 		emit addressChanged();
 		updateValue();
+		updateQuality();
 	}
 }
 
@@ -89,6 +92,16 @@ bool InputRegisterController::busy() const
 	return m_busy;
 }
 
+InputRegister::quality_t InputRegisterController::quality() const
+{
+	return m_quality;
+}
+
+QDateTime InputRegisterController::timestamp() const
+{
+	return m_timestamp;
+}
+
 void InputRegisterController::onValueUpdated()
 {
 	updateValue();
@@ -96,6 +109,11 @@ void InputRegisterController::onValueUpdated()
 	setBusy(false);
 }
 
+void InputRegisterController::onQualityChanged()
+{
+	updateQuality();
+}
+
 void InputRegisterController::setBusy(bool busy)
 {
 	if (m_busy != busy) {
@@ -114,17 +132,37 @@ void InputRegisterController::updateValue()
 		m_value = newValue;
 		emit valueChanged();
 	}
+
+	QDateTime newTimestamp = m_register->timestamp();
+	if (m_timestamp != newTimestamp) {
+		m_timestamp = newTimestamp;
+		emit timestampChanged();
+	}
+}
+
+void InputRegisterController::updateQuality()
+{
+	if (m_register == nullptr)
+		return;
+
+	InputRegister::quality_t newQuality = m_register->quality();
+	if (m_quality != newQuality) {
+		m_quality = newQuality;
+		emit qualityChanged();
+	}
 }
 
 void InputRegisterController::setupRegister(cutehmi::modbus::InputRegister * reg)
 {
 	if (m_register != nullptr) {
 		disconnect(m_register, & InputRegister::valueUpdated, this, & InputRegisterController::onValueUpdated);
+		disconnect(m_register, & InputRegister::qualityChanged, this, & InputRegisterController::onQualityChanged);
 		m_register->rest();
 	}
 	m_register = reg;
 	if (m_register != nullptr) {
 		connect(m_register, & InputRegister::valueUpdated, this, & InputRegisterController::onValueUpdated);
+		connect(m_register, & InputRegister::qualityChanged, this, & InputRegisterController::onQualityChanged);
 		m_register->awake();
 	}
 }
@@ -4,6 +4,7 @@
 #include <modbus/AbstractDevice.hpp>
 
 #include <QObject>
+#include <QDateTime>
 
 namespace cutehmi {
 namespace modbus {
@@ -21,6 +22,8 @@ class InputRegisterController:
 		Q_PROPERTY(qreal valueScale READ valueScale WRITE setValueScale NOTIFY valueScaleChanged)
 		Q_PROPERTY(InputRegister::encoding_t encoding READ encoding WRITE setEncoding NOTIFY encodingChanged)
 		Q_PROPERTY(bool busy READ busy NOTIFY busyChanged)
+		Q_PROPERTY(InputRegister::quality_t quality READ quality NOTIFY qualityChanged)
+		Q_PROPERTY(QDateTime timestamp READ timestamp NOTIFY timestampChanged)
 
 		InputRegisterController(QObject * parent = 0);
 
@@ -47,6 +50,10 @@ class InputRegisterController:
 
 		bool busy() const;
 
+		InputRegister::quality_t quality() const;
+
+		QDateTime timestamp() const;
+
 	signals:
 		void valueChanged();
 
@@ -62,14 +69,22 @@ class InputRegisterController:
 
 		void busyChanged();
 
+		void qualityChanged();
+
+		void timestampChanged();
+
 	protected slots:
 		void onValueUpdated();
 
+		void onQualityChanged();
+
 	protected:
 		void setBusy(bool busy);
 
 		void updateValue();
 
+		void updateQuality();
+
 	private:
 		void setupRegister(InputRegister * reg);
 
@@ -80,6 +95,8 @@ class InputRegisterController:
 		qreal m_valueScale;
 		InputRegister::encoding_t m_encoding;
 		bool m_busy;
+		InputRegister::quality_t m_quality;
+		QDateTime m_timestamp;
 		InputRegister * m_register;
 };
 
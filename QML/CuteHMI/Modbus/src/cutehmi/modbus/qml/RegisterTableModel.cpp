@@ -0,0 +1,343 @@
+#include "RegisterTableModel.hpp"
+
+namespace cutehmi {
+namespace modbus {
+namespace qml {
+
+RegisterTableModel::RegisterTableModel(QObject * parent):
+	QAbstractListModel(parent),
+	m_device(nullptr),
+	m_type(HOLDING_REGISTER),
+	m_rowsType(HOLDING_REGISTER),
+	m_address(0),
+	m_count(0),
+	m_encoding(INT16),
+	m_valueScale(1.0)
+{
+}
+
+RegisterTableModel::~RegisterTableModel()
+{
+	releaseRows();
+}
+
+AbstractDevice * RegisterTableModel::device() const
+{
+	return m_device;
+}
+
+void RegisterTableModel::setDevice(AbstractDevice * device)
+{
+	if (m_device != device) {
+		if (m_device != nullptr)
+			disconnect(m_device, & AbstractDevice::scanned, this, & RegisterTableModel::onScanned);
+		m_device = device;
+		if (m_device != nullptr)
+			connect(m_device, & AbstractDevice::scanned, this, & RegisterTableModel::onScanned);
+		setupRows();
+		emit deviceChanged();
+	}
+}
+
+RegisterTableModel::type_t RegisterTableModel::type() const
+{
+	return m_type;
+}
+
+void RegisterTableModel::setType(type_t type)
+{
+	if (m_type != type) {
+		m_type = type;
+		setupRows();
+		emit typeChanged();
+	}
+}
+
+int RegisterTableModel::address() const
+{
+	return m_address;
+}
+
+void RegisterTableModel::setAddress(int address)
+{
+	if (m_address != address) {
+		m_address = address;
+		setupRows();
+		emit addressChanged();
+	}
+}
+
+int RegisterTableModel::count() const
+{
+	return m_count;
+}
+
+void RegisterTableModel::setCount(int count)
+{
+	if (m_count != count) {
+		m_count = count;
+		setupRows();
+		emit countChanged();
+	}
+}
+
+RegisterTableModel::encoding_t RegisterTableModel::encoding() const
+{
+	return m_encoding;
+}
+
+void RegisterTableModel::setEncoding(encoding_t encoding)
+{
+	if (m_encoding != encoding) {
+		m_encoding = encoding;
+		refreshAll();
+		emit encodingChanged();
+	}
+}
+
+qreal RegisterTableModel::valueScale() const
+{
+	return m_valueScale;
+}
+
+void RegisterTableModel::setValueScale(qreal valueScale)
+{
+	if (m_valueScale != valueScale) {
+		m_valueScale = valueScale;
+		refreshAll();
+		emit valueScaleChanged();
+	}
+}
+
+int RegisterTableModel::rowCount(const QModelIndex & parent) const
+{
+	if (parent.isValid())
+		return 0;
+	return m_rows.count();
+}
+
+QVariant RegisterTableModel::data(const QModelIndex & index, int role) const
+{
+	if (!index.isValid() || (index.row() >= m_rows.count()))
+		return QVariant();
+
+	const Row & row = m_rows.at(index.row());
+	switch (role) {
+		case Qt::DisplayRole:
+		case VALUE_ROLE:
+			return row.value;
+		case ADDRESS_ROLE:
+			return m_address + index.row();
+		case QUALITY_ROLE:
+			return row.quality;
+		case TIMESTAMP_ROLE:
+			return row.timestamp;
+		default:
+			return QVariant();
+	}
+}
+
+bool RegisterTableModel::setData(const QModelIndex & index, const QVariant & value, int role)
+{
+	if (!index.isValid() || (index.row() >= m_rows.count()))
+		return false;
+	if ((role != VALUE_ROLE) && (role != Qt::EditRole))
+		return false;
+
+	// Facade is needed to issue write request, so it is created on demand.
+	int addr = m_address + index.row();
+	switch (m_rowsType) {
+		case HOLDING_REGISTER:
+			m_device->rAt(addr)->requestValue(value.toReal() / m_valueScale, static_cast<HoldingRegister::encoding_t>(m_encoding));
+			return true;
+		case COIL:
+			m_device->bAt(addr)->requestValue(value.toBool());
+			return true;
+		default:
+			return false;
+	}
+}
+
+Qt::ItemFlags RegisterTableModel::flags(const QModelIndex & index) const
+{
+	Qt::ItemFlags result = QAbstractListModel::flags(index);
+	if ((m_rowsType == HOLDING_REGISTER) || (m_rowsType == COIL))
+		result |= Qt::ItemIsEditable;
+	return result;
+}
+
+QHash<int, QByteArray> RegisterTableModel::roleNames() const
+{
+	QHash<int, QByteArray> result;
+	result.insert(ADDRESS_ROLE, "address");
+	result.insert(VALUE_ROLE, "value");
+	result.insert(QUALITY_ROLE, "quality");
+	result.insert(TIMESTAMP_ROLE, "timestamp");
+	return result;
+}
+
+QObject * RegisterTableModel::element(int row) const
+{
+	if ((row < 0) || (row >= m_rows.count()))
+		return nullptr;
+
+	int addr = m_address + row;
+	switch (m_rowsType) {
+		case INPUT_REGISTER:
+			return m_device->irAt(addr);
+		case HOLDING_REGISTER:
+			return m_device->rAt(addr);
+		case DISCRETE_INPUT:
+			return m_device->ibAt(addr);
+		case COIL:
+			return m_device->bAt(addr);
+		default:
+			return nullptr;
+	}
+}
+
+void RegisterTableModel::onScanned()
+{
+	// Emit one signal per contiguous range of modified rows instead of one signal per row.
+	static const QVector<int> ROLES = {Qt::DisplayRole, VALUE_ROLE, QUALITY_ROLE, TIMESTAMP_ROLE};
+
+	int first = -1;
+	for (int i = 0; i < m_rows.count(); i++) {
+		if (refreshRow(m_rows[i])) {
+			if (first == -1)
+				first = i;
+		} else if (first != -1) {
+			emit dataChanged(index(first), index(i - 1), ROLES);
+			first = -1;
+		}
+	}
+	if (first != -1)
+		emit dataChanged(index(first), index(m_rows.count() - 1), ROLES);
+}
+
+void RegisterTableModel::setupRows()
+{
+	beginResetModel();
+	releaseRows();
+	m_rowsType = m_type;
+	if (m_device != nullptr) {
+		int count = (m_address < 0) ? 0 : qBound(0, m_count, ADDR_SPACE_SIZE - qMin(m_address, ADDR_SPACE_SIZE));
+		m_rows.reserve(count);
+		for (int i = 0; i < count; i++) {
+			Row row {acquireData(m_address + i), QVariant(), -1, QDateTime()};
+			refreshRow(row);
+			m_rows.append(row);
+		}
+	}
+	endResetModel();
+}
+
+void RegisterTableModel::releaseRows()
+{
+	for (const Row & row : m_rows)
+		restData(row.data);
+	m_rows.clear();
+}
+
+bool RegisterTableModel::refreshRow(Row & row) const
+{
+	switch (m_rowsType) {
+		case INPUT_REGISTER: {
+				const InputRegister::Data * data = static_cast<const InputRegister::Data *>(row.data);
+				return RefreshRow(row, m_valueScale * InputRegister::Decode(data->loadValue(), static_cast<InputRegister::encoding_t>(m_encoding)).toReal(), *data);
+			}
+		case HOLDING_REGISTER: {
+				const HoldingRegister::Data * data = static_cast<const HoldingRegister::Data *>(row.data);
+				return RefreshRow(row, m_valueScale * HoldingRegister::Decode(data->loadValue(), static_cast<HoldingRegister::encoding_t>(m_encoding)).toReal(), *data);
+			}
+		case DISCRETE_INPUT: {
+				const DiscreteInput::Data * data = static_cast<const DiscreteInput::Data *>(row.data);
+				return RefreshRow(row, data->loadValue(), *data);
+			}
+		case COIL: {
+				const Coil::Data * data = static_cast<const Coil::Data *>(row.data);
+				return RefreshRow(row, data->loadValue(), *data);
+			}
+		default:
+			return false;
+	}
+}
+
+void RegisterTableModel::refreshAll()
+{
+	for (Row & row : m_rows)
+		refreshRow(row);
+	if (!m_rows.isEmpty())
+		emit dataChanged(index(0), index(m_rows.count() - 1));
+}
+
+void * RegisterTableModel::acquireData(int addr) const
+{
+	switch (m_rowsType) {
+		case INPUT_REGISTER: {
+				InputRegister::Data * data = m_device->irDataAt(addr);
+				data->awake();
+				return data;
+			}
+		case HOLDING_REGISTER: {
+				HoldingRegister::Data * data = m_device->rDataAt(addr);
+				data->awake();
+				return data;
+			}
+		case DISCRETE_INPUT: {
+				DiscreteInput::Data * data = m_device->ibDataAt(addr);
+				data->awake();
+				return data;
+			}
+		case COIL: {
+				Coil::Data * data = m_device->bDataAt(addr);
+				data->awake();
+				return data;
+			}
+		default:
+			return nullptr;
+	}
+}
+
+void RegisterTableModel::restData(void * data) const
+{
+	switch (m_rowsType) {
+		case INPUT_REGISTER:
+			static_cast<InputRegister::Data *>(data)->rest();
+			break;
+		case HOLDING_REGISTER:
+			static_cast<HoldingRegister::Data *>(data)->rest();
+			break;
+		case DISCRETE_INPUT:
+			static_cast<DiscreteInput::Data *>(data)->rest();
+			break;
+		case COIL:
+			static_cast<Coil::Data *>(data)->rest();
+			break;
+	}
+}
+
+template <typename DATA>
+bool RegisterTableModel::RefreshRow(Row & row, const QVariant & value, const DATA & data)
+{
+	int quality = data.loadQuality();
+	qint64 msecs = data.loadTimestamp();
+	QDateTime timestamp = msecs == 0 ? QDateTime() : QDateTime::fromMSecsSinceEpoch(msecs);
+
+	if ((row.value == value) && (row.quality == quality) && (row.timestamp == timestamp))
+		return false;
+
+	row.value = value;
+	row.quality = quality;
+	row.timestamp = timestamp;
+	return true;
+}
+
+constexpr int RegisterTableModel::ADDR_SPACE_SIZE;
+
+}
+}
+}
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
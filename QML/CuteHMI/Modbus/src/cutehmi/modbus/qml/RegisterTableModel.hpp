@@ -0,0 +1,185 @@
+#ifndef CUTEHMI_QML_CUTEHMI_MODBUS_SRC_CUTEHMI_MODBUS_QML_REGISTERTABLEMODEL_HPP
+#define CUTEHMI_QML_CUTEHMI_MODBUS_SRC_CUTEHMI_MODBUS_QML_REGISTERTABLEMODEL_HPP
+
+#include <modbus/AbstractDevice.hpp>
+
+#include <QAbstractListModel>
+#include <QDateTime>
+#include <QVector>
+
+namespace cutehmi {
+namespace modbus {
+namespace qml {
+
+/**
+ * Register table model. List model, which exposes a range of registers (or coils) of a device. Model does not create
+ * facades of individual registers. Instead it awakes register data directly, compares its rows against process image each
+ * time device completes a scan and emits coalesced dataChanged() signals for contiguous ranges of modified rows. This
+ * allows views to display thousands of live values, while instantiating delegates only for visible rows. Facades are
+ * created only, when delegate requests them with element() or when value is being written with setData().
+ */
+class RegisterTableModel:
+	public QAbstractListModel
+{
+	Q_OBJECT
+
+	public:
+		enum type_t {
+			INPUT_REGISTER,
+			HOLDING_REGISTER,
+			DISCRETE_INPUT,
+			COIL
+		};
+		Q_ENUM(type_t)
+
+		enum encoding_t {
+			INT16
+		};
+		Q_ENUM(encoding_t)
+
+		enum role_t {
+			ADDRESS_ROLE = Qt::UserRole + 1,
+			VALUE_ROLE,
+			QUALITY_ROLE,
+			TIMESTAMP_ROLE
+		};
+		Q_ENUM(role_t)
+
+		Q_PROPERTY(AbstractDevice * device READ device WRITE setDevice NOTIFY deviceChanged)
+		Q_PROPERTY(type_t type READ type WRITE setType NOTIFY typeChanged)
+		Q_PROPERTY(int address READ address WRITE setAddress NOTIFY addressChanged)
+		Q_PROPERTY(int count READ count WRITE setCount NOTIFY countChanged)
+		Q_PROPERTY(encoding_t encoding READ encoding WRITE setEncoding NOTIFY encodingChanged)
+		Q_PROPERTY(qreal valueScale READ valueScale WRITE setValueScale NOTIFY valueScaleChanged)
+
+		RegisterTableModel(QObject * parent = 0);
+
+		~RegisterTableModel() override;
+
+	public:
+		AbstractDevice * device() const;
+
+		void setDevice(AbstractDevice * device);
+
+		type_t type() const;
+
+		void setType(type_t type);
+
+		int address() const;
+
+		void setAddress(int address);
+
+		int count() const;
+
+		void setCount(int count);
+
+		encoding_t encoding() const;
+
+		void setEncoding(encoding_t encoding);
+
+		qreal valueScale() const;
+
+		void setValueScale(qreal valueScale);
+
+		int rowCount(const QModelIndex & parent = QModelIndex()) const override;
+
+		QVariant data(const QModelIndex & index, int role = Qt::DisplayRole) const override;
+
+		bool setData(const QModelIndex & index, const QVariant & value, int role = Qt::EditRole) override;
+
+		Qt::ItemFlags flags(const QModelIndex & index) const override;
+
+		QHash<int, QByteArray> roleNames() const override;
+
+		/**
+		 * Get element of a row. Element is a facade of register data (InputRegister, HoldingRegister, DiscreteInput or
+		 * Coil), which is created on demand. It is owned by the device and it remains valid only as long as the row exists,
+		 * because model rests register data, when rows are rebuilt, and facade is deleted, once its last user rests it. Caller,
+		 * which keeps the element beyond lifetime of the row, must awake() it before storing the pointer and rest() it once
+		 * it is no longer needed. QML engine tracks destruction of the element, so references held by QML become @p null.
+		 * @param row row index.
+		 * @return element of the row or @p nullptr if row does not exist.
+		 */
+		Q_INVOKABLE QObject * element(int row) const;
+
+	signals:
+		void deviceChanged();
+
+		void typeChanged();
+
+		void addressChanged();
+
+		void countChanged();
+
+		void encodingChanged();
+
+		void valueScaleChanged();
+
+	protected slots:
+		void onScanned();
+
+	private:
+		static constexpr int ADDR_SPACE_SIZE = 65536;
+
+		struct Row
+		{
+			void * data;	// Register data of type matching m_rowsType.
+			QVariant value;
+			int quality;
+			QDateTime timestamp;
+		};
+
+		/**
+		 * Release elements of the rows and build rows for current device, type, address and count.
+		 */
+		void setupRows();
+
+		/**
+		 * Rest and forget data of the rows.
+		 */
+		void releaseRows();
+
+		/**
+		 * Refresh cached data of a row from the process image.
+		 * @param row row to refresh.
+		 * @return @p true if cached data has changed, @p false otherwise.
+		 */
+		bool refreshRow(Row & row) const;
+
+		/**
+		 * Refresh all rows and emit dataChanged() for the whole model.
+		 */
+		void refreshAll();
+
+		/**
+		 * Refresh cached data of a row from register data.
+		 * @param row row to refresh.
+		 * @param value value decoded from register data.
+		 * @param data register data.
+		 * @return @p true if cached data has changed, @p false otherwise.
+		 */
+		template <typename DATA>
+		static bool RefreshRow(Row & row, const QVariant & value, const DATA & data);
+
+		void * acquireData(int addr) const;
+
+		void restData(void * data) const;
+
+		AbstractDevice * m_device;
+		type_t m_type;
+		type_t m_rowsType;	// Type of elements referenced by m_rows.
+		int m_address;
+		int m_count;
+		encoding_t m_encoding;
+		qreal m_valueScale;
+		QVector<Row> m_rows;
+};
+
+}
+}
+}
+
+#endif
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
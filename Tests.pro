@@ -0,0 +1,6 @@
+TEMPLATE = subdirs
+CONFIG += ordered
+
+SUBDIRS += \
+    cutehmi_modbus_1_lib/tests \
+    cutehmi_stupid_1_lib/tests
@@ -26,6 +26,21 @@ class CUTEHMI_CHARTS_API PointSeries:
 
 		void append(const QPointF & point);
 
+		/**
+		 * Append points. Unlike setData(), only appended points are passed to the series, so that data can be loaded
+		 * progressively in chunks.
+		 * @param points points to be appended.
+		 */
+		void append(const DataContainer & points);
+
+		/**
+		 * Insert points.
+		 * @param index index at which points are inserted. If @a index is equal to count(), points are appended and
+		 * dataAppended() signal is emitted. Otherwise dataInserted() signal is emitted.
+		 * @param points points to be inserted.
+		 */
+		void insert(int index, const DataContainer & points);
+
 		const DataContainer & data() const;
 
 		void setData(const DataContainer & data);
@@ -39,6 +54,21 @@ class CUTEHMI_CHARTS_API PointSeries:
 	signals:
 		void dataChanged();
 
+		/**
+		 * Data appended.
+		 * @param index index of first appended point.
+		 * @param count number of appended points.
+		 */
+		void dataAppended(int index, int count);
+
+		/**
+		 * Data inserted. Signal is emitted, when points are inserted before the end of the series. Points, which follow
+		 * inserted points, are shifted, but they are not modified.
+		 * @param index index of first inserted point.
+		 * @param count number of inserted points.
+		 */
+		void dataInserted(int index, int count);
+
 	private:
 		struct Members
 		{
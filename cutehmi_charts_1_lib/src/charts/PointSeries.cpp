@@ -1,5 +1,7 @@
 #include "../../include/charts/PointSeries.hpp"
 
+#include <algorithm>
+
 namespace cutehmi {
 namespace charts {
 
@@ -23,6 +25,30 @@ void PointSeries::append(const QPointF & point)
 	m->data.push_back(point);
 }
 
+void PointSeries::append(const DataContainer & points)
+{
+	if (points.isEmpty())
+		return;
+
+	int index = m->data.count();
+	m->data += points;
+	emit dataAppended(index, points.count());
+}
+
+void PointSeries::insert(int index, const DataContainer & points)
+{
+	if (index == m->data.count()) {
+		append(points);
+		return;
+	}
+	if (points.isEmpty())
+		return;
+
+	m->data.insert(index, points.count(), QPointF());
+	std::copy(points.begin(), points.end(), m->data.begin() + index);
+	emit dataInserted(index, points.count());
+}
+
 const PointSeries::DataContainer & PointSeries::data() const
 {
 	return m->data;
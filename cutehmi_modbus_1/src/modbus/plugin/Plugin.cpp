@@ -4,8 +4,11 @@
 #include "ModbusNodeData.hpp"
 
 #include <modbus/internal/TCPConnection.hpp>
+#include <modbus/internal/ConnectionPool.hpp>
+#include <modbus/internal/UDPConnection.hpp>
 #include <modbus/internal/RTUConnection.hpp>
 #include <modbus/internal/DummyConnection.hpp>
+#include <modbus/internal/ServiceWorkerPool.hpp>
 
 #include <services/ServiceRegistry.hpp>
 
@@ -38,10 +41,19 @@ void Plugin::readXML(QXmlStreamReader & xmlReader, base::ProjectNode & node)
 	while (helper.readNextRecognizedElement()) {
 		if (xmlReader.name() == "cutehmi_modbus_1") {
 			base::xml::ParseHelper nodeHelper(& helper);
-			nodeHelper << base::xml::ParseElement("modbus", {base::xml::ParseAttribute("id"),
+			nodeHelper << base::xml::ParseElement("service_workers", 0, 1)
+					   << base::xml::ParseElement("modbus", {base::xml::ParseAttribute("id"),
 															 base::xml::ParseAttribute("name")}, 0);
 			while (nodeHelper.readNextRecognizedElement()) {
-				if (xmlReader.name() == "modbus")
+				if (xmlReader.name() == "service_workers") {
+					// Worker pool is shared by all pooled services, so its size is a project-level setting.
+					bool ok;
+					int workers = xmlReader.readElementText().toInt(& ok);
+					if (!ok || (workers < 1))
+						xmlReader.raiseError(QObject::tr("Contents of 'service_workers' element must be a positive integer."));
+					else
+						internal::ServiceWorkerPool::Instance().setSize(workers);
+				} else if (xmlReader.name() == "modbus")
 					parseModbus(nodeHelper, node, xmlReader.attributes().value("id").toString(), xmlReader.attributes().value("name").toString());
 			}
 		}
@@ -65,26 +77,44 @@ void Plugin::parseModbus(const base::xml::ParseHelper & parentHelper, base::Proj
 	std::unique_ptr<Service> service;
 	std::unique_ptr<internal::AbstractConnection> connection;
 	unsigned long serviceSleep = 0;
+	Service::execution_t serviceExecution = Service::THREAD;
+	int clientMaxAge = 0;
+	QHash<QString, Client::AddressSet> clientScreens;
+	QList<internal::ReadPlan::Entry> clientRegisters;
 
 	QXmlStreamReader & xmlReader = *helper.xmlReader();
 	while (helper.readNextRecognizedElement()) {
 		if (xmlReader.name() == "client") {
 			base::xml::ParseHelper clientHelper(& helper);
-			clientHelper << base::xml::ParseElement("connection", {base::xml::ParseAttribute("type", "TCP|RTU|dummy")}, 1, 1);
+			clientHelper << base::xml::ParseElement("connection", {base::xml::ParseAttribute("type", "TCP|UDP|RTU|dummy")}, 1, 1)
+						 << base::xml::ParseElement("max_age", 0, 1)
+						 << base::xml::ParseElement("screens", 0, 1)
+						 << base::xml::ParseElement("registers", 0, 1);
 
 			while (clientHelper.readNextRecognizedElement()) {
 				if (xmlReader.name() == "connection") {
 					if (xmlReader.attributes().value("type") == "TCP")
 						parseTCP(clientHelper, connection);
+					else if (xmlReader.attributes().value("type") == "UDP")
+						parseUDP(clientHelper, connection);
 					else if (xmlReader.attributes().value("type") == "RTU")
 						parseRTU(clientHelper, connection);
 					else if (xmlReader.attributes().value("type") == "dummy")
 						parseDummy(clientHelper, connection);
-				}
+				} else if (xmlReader.name() == "max_age") {
+					bool ok;
+					clientMaxAge = xmlReader.readElementText().toInt(& ok);
+					if (!ok)
+						xmlReader.raiseError(QObject::tr("Could not convert 'max_age' element contents to integer."));
+				} else if (xmlReader.name() == "screens")
+					parseScreens(clientHelper, clientScreens);
+				else if (xmlReader.name() == "registers")
+					parseRegisters(clientHelper, clientRegisters);
 			}
 		} else if (xmlReader.name() == "service") {
 			base::xml::ParseHelper serviceHelper(& helper);
-			serviceHelper << base::xml::ParseElement("sleep", 1, 1);
+			serviceHelper << base::xml::ParseElement("sleep", 1, 1)
+						  << base::xml::ParseElement("execution", 0, 1);
 
 			while (serviceHelper.readNextRecognizedElement()) {
 				if (xmlReader.name() == "sleep") {
@@ -92,13 +122,24 @@ void Plugin::parseModbus(const base::xml::ParseHelper & parentHelper, base::Proj
 					serviceSleep = xmlReader.readElementText().toULong(& ok);
 					if (!ok)
 						xmlReader.raiseError(QObject::tr("Could not convert 'sleep' element contents to long integer."));
+				} else if (xmlReader.name() == "execution") {
+					QString execution = xmlReader.readElementText();
+					if (execution == "pool")
+						serviceExecution = Service::POOL;
+					else if (execution != "thread")
+						xmlReader.raiseError(QObject::tr("Unrecognized 'execution' element contents ('%1').").arg(execution));
 				}
 			}
 		}
 	}
 
 	client.reset(new Client(std::move(connection)));
-	service.reset(new Service(name, client.get()));
+	client->setMaxAge(clientMaxAge);
+	for (QHash<QString, Client::AddressSet>::const_iterator it = clientScreens.begin(); it != clientScreens.end(); ++it)
+		client->setScreenAddresses(it.key(), it.value());
+	if (!clientRegisters.isEmpty())
+		client->setReadPlan(std::make_shared<const internal::ReadPlan>(clientRegisters));
+	service.reset(new Service(name, client.get(), serviceExecution));
 	service->setSleep(serviceSleep);
 	base::ProjectNode * modbusNode = node.addChild(id, base::ProjectNodeData(name));
 	modbusNode->addExtension(client.get());
@@ -114,6 +155,85 @@ void Plugin::parseModbus(const base::xml::ParseHelper & parentHelper, base::Proj
 	modbusNode->data().append(std::unique_ptr<ModbusNodeData>(new ModbusNodeData(std::move(client), std::move(service))));
 }
 
+void Plugin::parseScreens(const base::xml::ParseHelper & parentHelper, QHash<QString, Client::AddressSet> & screens)
+{
+	base::xml::ParseHelper helper(& parentHelper);
+	helper << base::xml::ParseElement("screen", {base::xml::ParseAttribute("name")}, 0);
+
+	QXmlStreamReader & xmlReader = *helper.xmlReader();
+	while (helper.readNextRecognizedElement()) {
+		if (xmlReader.name() == "screen") {
+			Client::AddressSet & addresses = screens[xmlReader.attributes().value("name").toString()];
+
+			base::xml::ParseHelper screenHelper(& helper);
+			screenHelper << base::xml::ParseElement("ir", {base::xml::ParseAttribute("address", "[0-9]+"), base::xml::ParseAttribute("count", "[0-9]+")}, 0)
+						 << base::xml::ParseElement("r", {base::xml::ParseAttribute("address", "[0-9]+"), base::xml::ParseAttribute("count", "[0-9]+")}, 0)
+						 << base::xml::ParseElement("ib", {base::xml::ParseAttribute("address", "[0-9]+"), base::xml::ParseAttribute("count", "[0-9]+")}, 0)
+						 << base::xml::ParseElement("b", {base::xml::ParseAttribute("address", "[0-9]+"), base::xml::ParseAttribute("count", "[0-9]+")}, 0);
+
+			while (screenHelper.readNextRecognizedElement()) {
+				int address = xmlReader.attributes().value("address").toInt();
+				int count = xmlReader.attributes().value("count").toInt();
+				if (address + count > 65536) {
+					xmlReader.raiseError(QObject::tr("Address range of '<%1>' element exceeds Modbus address space.").arg(xmlReader.name().toString()));
+					break;
+				}
+				QList<int> * list = nullptr;
+				if (xmlReader.name() == "ir")
+					list = & addresses.ir;
+				else if (xmlReader.name() == "r")
+					list = & addresses.r;
+				else if (xmlReader.name() == "ib")
+					list = & addresses.ib;
+				else if (xmlReader.name() == "b")
+					list = & addresses.b;
+				for (int addr = address; addr < address + count; addr++)
+					list->append(addr);
+			}
+		}
+	}
+}
+
+void Plugin::parseRegisters(const base::xml::ParseHelper & parentHelper, QList<internal::ReadPlan::Entry> & entries)
+{
+	base::xml::ParseHelper helper(& parentHelper);
+	helper << base::xml::ParseElement("ir", {base::xml::ParseAttribute("address", "[0-9]+"),
+											 base::xml::ParseAttribute("count", "[0-9]+"),
+											 base::xml::ParseAttribute("poll", "[1-9][0-9]*", false),
+											 base::xml::ParseAttribute("encoding", "INT16", false)}, 0)
+		   << base::xml::ParseElement("r", {base::xml::ParseAttribute("address", "[0-9]+"),
+											base::xml::ParseAttribute("count", "[0-9]+"),
+											base::xml::ParseAttribute("poll", "[1-9][0-9]*", false),
+											base::xml::ParseAttribute("encoding", "INT16", false)}, 0)
+		   << base::xml::ParseElement("ib", {base::xml::ParseAttribute("address", "[0-9]+"),
+											 base::xml::ParseAttribute("count", "[0-9]+"),
+											 base::xml::ParseAttribute("poll", "[1-9][0-9]*", false)}, 0)
+		   << base::xml::ParseElement("b", {base::xml::ParseAttribute("address", "[0-9]+"),
+											base::xml::ParseAttribute("count", "[0-9]+"),
+											base::xml::ParseAttribute("poll", "[1-9][0-9]*", false)}, 0);
+
+	QXmlStreamReader & xmlReader = *helper.xmlReader();
+	while (helper.readNextRecognizedElement()) {
+		internal::ReadPlan::Entry entry;
+		entry.address = xmlReader.attributes().value("address").toInt();
+		entry.count = xmlReader.attributes().value("count").toInt();
+		entry.poll = xmlReader.attributes().hasAttribute("poll") ? xmlReader.attributes().value("poll").toInt() : 1;
+		if (entry.address + entry.count > internal::ReadPlan::ADDR_SPACE_SIZE) {
+			xmlReader.raiseError(QObject::tr("Address range of '<%1>' element exceeds Modbus address space.").arg(xmlReader.name().toString()));
+			break;
+		}
+		if (xmlReader.name() == "ir")
+			entry.table = internal::ReadPlan::INPUT_REGISTERS;
+		else if (xmlReader.name() == "r")
+			entry.table = internal::ReadPlan::HOLDING_REGISTERS;
+		else if (xmlReader.name() == "ib")
+			entry.table = internal::ReadPlan::DISCRETE_INPUTS;
+		else
+			entry.table = internal::ReadPlan::COILS;
+		entries.append(entry);
+	}
+}
+
 void Plugin::parseTCP(const base::xml::ParseHelper & parentHelper, std::unique_ptr<internal::AbstractConnection> & connection)
 {
 	QString name;
@@ -122,13 +242,17 @@ void Plugin::parseTCP(const base::xml::ParseHelper & parentHelper, std::unique_p
 	internal::LibmodbusConnection::Timeout responseTimeout;
 	std::unique_ptr<internal::TCPConnection> tcpConnection;
 	int unitId = MODBUS_TCP_SLAVE;
+	int connectionsCount = 1;
+	int maxConcurrent = 0;
 
 	base::xml::ParseHelper helper(& parentHelper);
 	helper << base::xml::ParseElement("node", 1, 1)
 		   << base::xml::ParseElement("service", 1, 1)
 		   << base::xml::ParseElement("byte_timeout", 1, 1)
 		   << base::xml::ParseElement("response_timeout", 1, 1)
-		   << base::xml::ParseElement("unit_id", 1, 1);
+		   << base::xml::ParseElement("unit_id", 1, 1)
+		   << base::xml::ParseElement("connections", {base::xml::ParseAttribute("count", "[1-9][0-9]*"),
+													  base::xml::ParseAttribute("max_concurrent", "[1-9][0-9]*", false)}, 0, 1);
 
 	QXmlStreamReader & xmlReader = *helper.xmlReader();
 	while (helper.readNextRecognizedElement()) {
@@ -147,12 +271,66 @@ void Plugin::parseTCP(const base::xml::ParseHelper & parentHelper, std::unique_p
 			unitId = xmlReader.readElementText().toInt(& ok);
 			if (!ok)
 				xmlReader.raiseError(QObject::tr("Could not convert 'unit_id' element contents to integer."));
+		} else if (xmlReader.name() == "connections") {
+			connectionsCount = xmlReader.attributes().value("count").toInt();
+			if (xmlReader.attributes().hasAttribute("max_concurrent"))
+				maxConcurrent = xmlReader.attributes().value("max_concurrent").toInt();
+		}
+	}
+	std::vector<std::unique_ptr<internal::AbstractConnection>> tcpConnections;
+	for (int i = 0; i < connectionsCount; i++) {
+		tcpConnection.reset(new internal::TCPConnection(name, service, unitId));
+		tcpConnection->setByteTimeout(byteTimeout);
+		tcpConnection->setResponseTimeout(responseTimeout);
+		tcpConnections.push_back(std::move(tcpConnection));
+	}
+	if (tcpConnections.size() == 1)
+		connection = std::move(tcpConnections.front());
+	else
+		connection.reset(new internal::ConnectionPool(std::move(tcpConnections), maxConcurrent));
+}
+
+void Plugin::parseUDP(const base::xml::ParseHelper & parentHelper, std::unique_ptr<internal::AbstractConnection> & connection)
+{
+	QString name;
+	quint16 port = 502;
+	internal::LibmodbusConnection::Timeout responseTimeout;
+	int retries = 3;
+	int unitId = MODBUS_TCP_SLAVE;
+
+	base::xml::ParseHelper helper(& parentHelper);
+	helper << base::xml::ParseElement("node", 1, 1)
+		   << base::xml::ParseElement("service", 1, 1)
+		   << base::xml::ParseElement("response_timeout", 1, 1)
+		   << base::xml::ParseElement("retries", 0, 1)
+		   << base::xml::ParseElement("unit_id", 1, 1);
+
+	QXmlStreamReader & xmlReader = *helper.xmlReader();
+	while (helper.readNextRecognizedElement()) {
+		if (xmlReader.name() == "node")
+			name = xmlReader.readElementText();
+		else if (xmlReader.name() == "service") {
+			bool ok;
+			port = xmlReader.readElementText().toUShort(& ok);
+			if (!ok)
+				xmlReader.raiseError(QObject::tr("Could not convert 'service' element contents to port number."));
+		} else if (xmlReader.name() == "response_timeout") {
+			if (!timeoutFromString(xmlReader.readElementText(), responseTimeout))
+				xmlReader.raiseError(QObject::tr("Could not parse 'response_timeout' element."));
+		} else if (xmlReader.name() == "retries") {
+			bool ok;
+			retries = xmlReader.readElementText().toInt(& ok);
+			if (!ok)
+				xmlReader.raiseError(QObject::tr("Could not convert 'retries' element contents to integer."));
+		} else if (xmlReader.name() == "unit_id") {
+			bool ok;
+			unitId = xmlReader.readElementText().toInt(& ok);
+			if (!ok)
+				xmlReader.raiseError(QObject::tr("Could not convert 'unit_id' element contents to integer."));
 		}
 	}
-	tcpConnection.reset(new internal::TCPConnection(name, service, unitId));
-	tcpConnection->setByteTimeout(byteTimeout);
-	tcpConnection->setResponseTimeout(responseTimeout);
-	connection.reset(tcpConnection.release());
+	int responseTimeoutMs = static_cast<int>(responseTimeout.sec * 1000 + responseTimeout.usec / 1000);
+	connection.reset(new internal::UDPConnection(name, port, unitId, responseTimeoutMs, retries));
 }
 
 void Plugin::parseRTU(const base::xml::ParseHelper & parentHelper, std::unique_ptr<internal::AbstractConnection> & connection)
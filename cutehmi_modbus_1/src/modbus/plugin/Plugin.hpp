@@ -6,8 +6,11 @@
 #include <base/xml/ParseHelper.hpp>
 
 #include <modbus/internal/LibmodbusConnection.hpp>
+#include <modbus/Client.hpp>
 
 #include <QObject>
+#include <QHash>
+#include <QList>
 
 #include <memory>
 
@@ -39,8 +42,14 @@ class Plugin:
 	private:
 		void parseModbus(const base::xml::ParseHelper & parentHelper, base::ProjectNode & node, const QString & id, const QString & name);
 
+		void parseScreens(const base::xml::ParseHelper & parentHelper, QHash<QString, Client::AddressSet> & screens);
+
+		void parseRegisters(const base::xml::ParseHelper & parentHelper, QList<internal::ReadPlan::Entry> & entries);
+
 		void parseTCP(const base::xml::ParseHelper & parentHelper, std::unique_ptr<internal::AbstractConnection> & connection);
 
+		void parseUDP(const base::xml::ParseHelper & parentHelper, std::unique_ptr<internal::AbstractConnection> & connection);
+
 		void parseRTU(const base::xml::ParseHelper & parentHelper, std::unique_ptr<internal::AbstractConnection> & connection);
 
 		void parseDummy(const base::xml::ParseHelper & parentHelper, std::unique_ptr<internal::AbstractConnection> & connection);
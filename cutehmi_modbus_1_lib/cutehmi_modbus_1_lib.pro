@@ -22,6 +22,8 @@ include(../cutehmi_base_1_lib/import.pri)
 include(../cutehmi_services_1_lib/import.pri)
 include(../libmodbus.pri)
 
+win32:LIBS += -lws2_32 # Used by UDP connection.
+
 unix {
     target.path = /usr/lib
     INSTALLS += target
@@ -40,9 +42,16 @@ SOURCES += \
     src/modbus/internal/LibmodbusConnection.cpp \
     src/modbus/internal/RTUConnection.cpp \
     src/modbus/internal/TCPConnection.cpp \
+    src/modbus/internal/UDPConnection.cpp \
+    src/modbus/internal/ConnectionPool.cpp \
+    src/modbus/internal/DiscoveryScanner.cpp \
+    src/modbus/internal/ReadPlan.cpp \
     src/modbus/internal/functions.cpp \
+    src/modbus/internal/RegisterData.cpp \
     src/modbus/AbstractDevice.cpp \
-    src/modbus/internal/ServiceThread.cpp
+    src/modbus/internal/ServiceThread.cpp \
+    src/modbus/internal/ServiceTask.cpp \
+    src/modbus/internal/ServiceWorkerPool.cpp
 
 HEADERS += \
     include/modbus/Client.hpp \
@@ -58,13 +67,20 @@ HEADERS += \
     include/modbus/internal/AbstractConnection.hpp \
     include/modbus/internal/DataContainer.hpp \
     include/modbus/internal/RegisterTraits.hpp \
+    include/modbus/internal/RegisterData.hpp \
     include/modbus/internal/DummyConnection.hpp \
     include/modbus/internal/LibmodbusConnection.hpp \
     include/modbus/internal/RTUConnection.hpp \
     include/modbus/internal/TCPConnection.hpp \
+    include/modbus/internal/UDPConnection.hpp \
+    include/modbus/internal/ConnectionPool.hpp \
+    include/modbus/internal/DiscoveryScanner.hpp \
+    include/modbus/internal/ReadPlan.hpp \
     include/modbus/internal/functions.hpp \
     include/modbus/AbstractDevice.hpp \
-    include/modbus/internal/ServiceThread.hpp
+    include/modbus/internal/ServiceThread.hpp \
+    include/modbus/internal/ServiceTask.hpp \
+    include/modbus/internal/ServiceWorkerPool.hpp
 
 DISTFILES += \
     import.pri \
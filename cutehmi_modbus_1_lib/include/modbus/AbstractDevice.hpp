@@ -39,14 +39,86 @@ class CUTEHMI_MODBUS_API AbstractDevice:
 
 		virtual const QQmlListProperty<Coil> & b() = 0;
 
+		/**
+		 * Get input register. Register is a facade of register data, which is created on demand. Facade is owned by the
+		 * device, but it is not kept alive by this function. Facade gets deleted (with QObject::deleteLater()), as soon as
+		 * the last user, who has awaken the register or its data, rests it. Caller, which keeps the pointer, must therefore
+		 * call InputRegister::awake() before storing it and InputRegister::rest() once it is no longer needed. Alternatively
+		 * pointer can be tracked with QPointer.
+		 * @param index register address.
+		 * @return input register.
+		 */
 		virtual InputRegister * irAt(int index) = 0;
 
+		/**
+		 * Get holding register.
+		 * @param index register address.
+		 * @return holding register.
+		 *
+		 * @see irAt().
+		 */
 		virtual HoldingRegister * rAt(int index) = 0;
 
+		/**
+		 * Get discrete input.
+		 * @param index discrete input address.
+		 * @return discrete input.
+		 *
+		 * @see irAt().
+		 */
 		virtual DiscreteInput * ibAt(int index) = 0;
 
+		/**
+		 * Get coil.
+		 * @param index coil address.
+		 * @return coil.
+		 *
+		 * @see irAt().
+		 */
 		virtual Coil * bAt(int index) = 0;
 
+		/**
+		 * Get data of input register. Data gives access to process image without creating a facade. Register is read by
+		 * the device as long as its data is awaken.
+		 * @param index register address.
+		 * @return data of input register. Data remains valid as long as device exists.
+		 */
+		virtual InputRegister::Data * irDataAt(int index) = 0;
+
+		/**
+		 * Get data of holding register.
+		 * @param index register address.
+		 * @return data of holding register. Data remains valid as long as device exists.
+		 *
+		 * @see irDataAt().
+		 */
+		virtual HoldingRegister::Data * rDataAt(int index) = 0;
+
+		/**
+		 * Get data of discrete input.
+		 * @param index discrete input address.
+		 * @return data of discrete input. Data remains valid as long as device exists.
+		 *
+		 * @see irDataAt().
+		 */
+		virtual DiscreteInput::Data * ibDataAt(int index) = 0;
+
+		/**
+		 * Get data of coil.
+		 * @param index coil address.
+		 * @return data of coil. Data remains valid as long as device exists.
+		 *
+		 * @see irDataAt().
+		 */
+		virtual Coil::Data * bDataAt(int index) = 0;
+
+	signals:
+		/**
+		 * Scanned. This signal is emitted each time device has completed reading values of wakeful registers and coils.
+		 * Signal may be emitted from a thread other than the one that device lives in.
+		 */
+		void scanned();
+
 	protected:
 		AbstractDevice(QObject * parent = 0);
 
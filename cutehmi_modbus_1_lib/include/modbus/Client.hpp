@@ -4,6 +4,7 @@
 #include "internal/common.hpp"
 #include "internal/AbstractConnection.hpp"
 #include "internal/RegisterTraits.hpp"
+#include "internal/ReadPlan.hpp"
 #include "AbstractDevice.hpp"
 
 #include <base/ErrorInfo.hpp>
@@ -11,10 +12,19 @@
 #include <QObject>
 #include <QQmlListProperty>
 #include <QHash>
-#include <QSignalMapper>
+#include <QQueue>
 #include <QMutex>
+#include <QMutexLocker>
+#include <QReadWriteLock>
+#include <QReadLocker>
+#include <QList>
+#include <QVector>
+#include <QSet>
+#include <QVarLengthArray>
 
 #include <memory>
+#include <algorithm>
+#include <type_traits>
 
 namespace cutehmi {
 namespace modbus {
@@ -46,6 +56,25 @@ class CUTEHMI_MODBUS_API Client:
 			QString str() const;
 		};
 
+		/**
+		 * Address set. Addresses of input registers, holding registers, discrete inputs and coils.
+		 */
+		struct CUTEHMI_MODBUS_API AddressSet
+		{
+			QList<int> ir;
+			QList<int> r;
+			QList<int> ib;
+			QList<int> b;
+
+			bool isEmpty() const;
+
+			/**
+			 * Merge other set into this one. Duplicated addresses are not added.
+			 * @param other other set.
+			 */
+			void unite(const AddressSet & other);
+		};
+
 		explicit Client(std::unique_ptr<internal::AbstractConnection> connection, QObject * parent = 0);
 
 		~Client() override;
@@ -66,58 +95,189 @@ class CUTEHMI_MODBUS_API Client:
 
 		Coil * bAt(int index) override;
 
+		InputRegister::Data * irDataAt(int index) override;
+
+		HoldingRegister::Data * rDataAt(int index) override;
+
+		DiscreteInput::Data * ibDataAt(int index) override;
+
+		Coil::Data * bDataAt(int index) override;
+
 		bool isConnected() const;
 
+		/**
+		 * Set maximal age of values. Reads are satisfied from previously read values as long as they are of good quality and
+		 * they are not older than @a maxAge. This allows to avoid redundant transactions, when same registers are requested
+		 * many times within short period of time. Additionally, in this mode successfully written values are stored directly
+		 * without reading them back from the device.
+		 * @param maxAge maximal age of values [ms]. Value of @p 0 disables max-age mode, so that each read performs a transaction.
+		 *
+		 * @note this function is thread-safe.
+		 */
+		void setMaxAge(int maxAge);
+
+		/**
+		 * Get maximal age of values.
+		 * @return maximal age of values [ms].
+		 *
+		 * @note this function is thread-safe.
+		 */
+		int maxAge() const;
+
+		/**
+		 * Set addresses of a screen. Declared addresses are used by prefetch() in addition to the ones learned with learnScreen().
+		 * @param screen screen identifier.
+		 * @param addresses addresses of registers and coils used by the screen.
+		 */
+		void setScreenAddresses(const QString & screen, const AddressSet & addresses);
+
+		/**
+		 * Get addresses of a screen.
+		 * @param screen screen identifier.
+		 * @return union of declared and learned addresses of the screen.
+		 */
+		AddressSet screenAddresses(const QString & screen) const;
+
+		/**
+		 * Learn addresses of a screen. Addresses of registers and coils, which have been awaken since prefetch() has been
+		 * called for the screen and which are still wakeful, are remembered as the ones used by the screen. Screen loader
+		 * should call this function once screen has been loaded and its controllers are bound.
+		 * @param screen screen identifier.
+		 *
+		 * @note prefetch() must be called for the screen before it gets loaded, otherwise addresses are not learned.
+		 */
+		Q_INVOKABLE void learnScreen(const QString & screen);
+
+		/**
+		 * Prefetch values of a screen. Screen loader should call this function before incoming screen becomes visible (e.g.
+		 * when transition animation starts), so that values are ready when controllers bind to the registers. Function also
+		 * marks the point, after which awaken registers and coils are attributed to the screen by learnScreen().
+		 * @param screen screen identifier.
+		 *
+		 * @see setScreenAddresses(), learnScreen().
+		 */
+		Q_INVOKABLE void prefetch(const QString & screen);
+
+		/**
+		 * Prefetch values. Requested registers and coils are read before any other reads performed by readAll().
+		 * @param addresses addresses of registers and coils to prefetch.
+		 */
+		void prefetch(const AddressSet & addresses);
+
+		/**
+		 * Set read plan. Spans of the plan are read by readAll() regardless of whether registers have been awaken or not.
+		 * Registers, which are not covered by the plan, are read only if they are wakeful. They are merged into spans of
+		 * contiguous addresses as they become referenced at runtime.
+		 * @param plan read plan compiled from declarative register map.
+		 *
+		 * @warning this function is not thread-safe. It should be called before service starts.
+		 */
+		void setReadPlan(std::shared_ptr<const internal::ReadPlan> plan);
+
+		/**
+		 * Get read plan.
+		 * @return read plan or @p nullptr if plan has not been set.
+		 */
+		std::shared_ptr<const internal::ReadPlan> readPlan() const;
+
 //		void setConnection(std::unique_ptr<internal::AbstractConnection> connection);
 
 		/**
-		 * Read input register value and update associated InputRegister object.
+		 * Read input register value and update associated register data.
 		 * @param addr register address.
 		 *
-		 * @note appropriate InputRegister object must be referenced using @a ir list before using this function.
+		 * @note register must be referenced using @a ir list or prefetch() before using this function.
+		 * @note in max-age mode read is skipped if the value is fresh enough.
 		 */
 		void readIr(int addr);
 
 		/**
-		 * Read holding register value and update associated HoldingRegister object.
+		 * Read holding register value and update associated register data.
 		 * @param addr register address.
 		 *
-		 * @note appropriate HoldingRegister object must be referenced using @a r list before using this function.
+		 * @note register must be referenced using @a r list or prefetch() before using this function.
+		 * @note in max-age mode read is skipped if the value is fresh enough.
 		 */
 		void readR(int addr);
 
 		/**
-		 * Write value requested by HoldingRegister object.
+		 * Write value requested by HoldingRegister object. Pending requests counter is decreased before valueWritten() or valueRejected() signal is emitted.
 		 * @param addr register address.
 		 *
-		 * @note appropriate HoldingRegister object must be referenced using @a r list before using this function.
+		 * @note register must be referenced using @a r list or prefetch() before using this function.
 		 */
 		void writeR(int addr);
 
 		/**
-		 * Read discrete input value and update associated DiscreteInput object.
+		 * Read discrete input value and update associated input data.
 		 * @param addr discrete input address.
 		 *
-		 * @note appropriate DiscreteInput object must be referenced using @a ib list before using this function.
+		 * @note element must be referenced using @a ib list or prefetch() before using this function.
+		 * @note in max-age mode read is skipped if the value is fresh enough.
 		 */
 		void readIb(int addr);
 
 		/**
-		 * Read coil value and update associated Coil object.
+		 * Read coil value and update associated coil data.
 		 * @param addr register address.
 		 *
-		 * @note appropriate Coil object must be referenced using @a b list before using this function.
+		 * @note element must be referenced using @a b list or prefetch() before using this function.
+		 * @note in max-age mode read is skipped if the value is fresh enough.
 		 */
 		void readB(int addr);
 
 		/**
-		 * Write value requested by Coil object.
+		 * Write value requested by Coil object. Pending requests counter is decreased before valueWritten() or valueRejected() signal is emitted.
 		 * @param addr register address.
 		 *
-		 * @note appropriate Coil object must be referenced using @a b list before using this function.
+		 * @note element must be referenced using @a b list or prefetch() before using this function.
 		 */
 		void writeB(int addr);
 
+		/**
+		 * Read a span of input registers in a single transaction and update associated register data.
+		 * @param addr address of the first register.
+		 * @param num number of registers. Must not exceed internal::ReadPlan::MAX_REGISTERS_SPAN.
+		 *
+		 * @note all registers of the span must be referenced before using this function.
+		 * @note in max-age mode read is skipped if all the values are fresh enough.
+		 * @note if device rejects the span with an exception, span is bisected until rejected addresses are isolated.
+		 */
+		void readIrSpan(int addr, int num);
+
+		/**
+		 * Read a span of holding registers in a single transaction and update associated register data.
+		 * @param addr address of the first register.
+		 * @param num number of registers. Must not exceed internal::ReadPlan::MAX_REGISTERS_SPAN.
+		 *
+		 * @note all registers of the span must be referenced before using this function.
+		 * @note in max-age mode read is skipped if all the values are fresh enough.
+		 * @note if device rejects the span with an exception, span is bisected until rejected addresses are isolated.
+		 */
+		void readRSpan(int addr, int num);
+
+		/**
+		 * Read a span of discrete inputs in a single transaction and update associated input data.
+		 * @param addr address of the first discrete input.
+		 * @param num number of discrete inputs. Must not exceed internal::ReadPlan::MAX_BITS_SPAN.
+		 *
+		 * @note all elements of the span must be referenced before using this function.
+		 * @note in max-age mode read is skipped if all the values are fresh enough.
+		 * @note if device rejects the span with an exception, span is bisected until rejected addresses are isolated.
+		 */
+		void readIbSpan(int addr, int num);
+
+		/**
+		 * Read a span of coils in a single transaction and update associated coil data.
+		 * @param addr address of the first coil.
+		 * @param num number of coils. Must not exceed internal::ReadPlan::MAX_BITS_SPAN.
+		 *
+		 * @note all elements of the span must be referenced before using this function.
+		 * @note in max-age mode read is skipped if all the values are fresh enough.
+		 * @note if device rejects the span with an exception, span is bisected until rejected addresses are isolated.
+		 */
+		void readBSpan(int addr, int num);
+
 	public slots:
 		/**
 		 * Connect client to the Modbus device.
@@ -134,7 +294,8 @@ class CUTEHMI_MODBUS_API Client:
 		void disconnect();
 
 		/**
-		 * Read all values of awaken registers and coils.
+		 * Read all values of awaken registers and coils. Spans of read plan are read first, according to their poll classes.
+		 * If connection allows for simultaneous transactions, tables are read in parallel.
 		 *
 		 * @param run indicates whether to interrupt read. Function interrupts reading and returns, if value of @p 0 is being set by another thread.
 		 * If @p 1 is set, then function will return only after reading all values of coils and registers.
@@ -149,6 +310,13 @@ class CUTEHMI_MODBUS_API Client:
 		 */
 		void readAll(const QAtomicInt & run = 1);
 
+		/**
+		 * Read values requested by prefetch().
+		 *
+		 * @param run indicates whether to interrupt read. Function interrupts reading and returns, if value of @p 0 is being set by another thread.
+		 */
+		void readPrefetched(const QAtomicInt & run = 1);
+
 	signals:
 		void error(cutehmi::base::ErrorInfo errInfo);
 
@@ -156,19 +324,48 @@ class CUTEHMI_MODBUS_API Client:
 
 		void disconnected();
 
-	protected slots:
-		void rValueRequest(int index);
+		/**
+		 * Prefetch requested. This signal is emitted when prefetch() has been called. Signal may be emitted from any thread.
+		 */
+		void prefetchRequested();
+
+	protected:
+		/**
+		 * Request write of holding register value. Request is pushed to the write queue.
+		 * @param addr register address.
+		 */
+		void rValueRequest(int addr);
 
-		void bValueRequest(int index);
+		/**
+		 * Request write of coil value. Request is pushed to the write queue.
+		 * @param addr coil address.
+		 */
+		void bValueRequest(int addr);
 
 	private:
 		typedef typename internal::RegisterTraits<InputRegister>::Container IrDataContainer;
 		typedef typename internal::RegisterTraits<HoldingRegister>::Container RDataContainer;
 		typedef typename internal::RegisterTraits<DiscreteInput>::Container IbDataContainer;
 		typedef typename internal::RegisterTraits<Coil>::Container BDataContainer;
+		typedef QHash<QString, int> ScreenStampsContainer;
+
+		/**
+		 * Write request.
+		 */
+		struct WriteRequest
+		{
+			enum target_t {
+				HOLDING_REGISTER,
+				COIL
+			};
+
+			target_t target;
+			int addr;
+		};
 
 		/**
-		 * Get element at specified index of property list. If element does not exist function creates it.
+		 * Get element at specified index of property list. If element does not exist function creates it. Elements are
+		 * facades of register data and they are children of the client.
 		 * Generic helper for QQmlListProperty.
 		 * @param property property list.
 		 * @param index element index.
@@ -180,12 +377,22 @@ class CUTEHMI_MODBUS_API Client:
 		static T * At(QQmlListProperty<T> * property, int index, void (*onCreate)(QQmlListProperty<T> *, int, T *) = nullptr);
 
 		/**
-		 * Return number of property list elements. Callback function for QQmlListProperty.
+		 * Return number of property list elements. Callback function for QQmlListProperty. List spans whole address space,
+		 * regardless of how many elements have been referenced.
 		 * @return number of property list elements.
 		 */
 		template <typename T>
 		static int Count(QQmlListProperty<T> * property);
 
+		/**
+		 * Get data at specified index of the container. If data does not exist function creates it. No facade is created.
+		 * @param container data container.
+		 * @param index data index.
+		 * @return data at index.
+		 */
+		template <typename CONTAINER>
+		static typename CONTAINER::value_type DataAt(CONTAINER & container, int index);
+
 		/**
 		 * Get HoldingRegister element at specified index of property list. Callback function for QQmlListProperty.
 		 * @return element at index.
@@ -211,15 +418,119 @@ class CUTEHMI_MODBUS_API Client:
 		static DiscreteInput * IbAt(QQmlListProperty<DiscreteInput> * property, int index);
 
 		/**
-		 * Read all values for the given container.
+		 * Span read request.
+		 */
+		struct SpanRequest
+		{
+			internal::ReadPlan::table_t table;
+			int addr;
+			int num;
+		};
+
+		typedef QVector<SpanRequest> SpanRequestsContainer;
+
+		/**
+		 * Collect spans of wakeful elements of the given container, which are not covered by read plan. Wakeful elements of
+		 * contiguous addresses are grouped in spans. Addresses rejected by the device are skipped.
 		 * @param container container to process.
-		 * @param readFn. Function to be used to read the value. Function accepts address as a parameter.
+		 * @param sortedKeys sorted keys of the container. Keys of newly referenced elements are merged into the list.
+		 * @param table table corresponding to the container.
+		 * @param requests container to which span requests are appended.
+		 */
+		template <typename CONTAINER>
+		void collectWakefulSpans(const CONTAINER & container, QVector<int> & sortedKeys, internal::ReadPlan::table_t table, SpanRequestsContainer & requests);
+
+		/**
+		 * Collect spans of read plan, which are due in current scan, followed by spans of wakeful elements, which are not
+		 * covered by the plan.
+		 * @param table table to read.
+		 * @param scan scan number.
+		 * @param requests container to which span requests are appended.
+		 */
+		void collectSpans(internal::ReadPlan::table_t table, quint64 scan, SpanRequestsContainer & requests);
+
+		/**
+		 * Read requested spans. Function may be called simultaneously from multiple threads, in which case each request is
+		 * taken by one of the threads.
+		 * @param requests span requests.
+		 * @param next index of the next request to take.
 		 * @param run allows to interrupt the read if set to @p 0. Normally @p 1.
-		 *
-		 * @todo optimize reads.
+		 */
+		void readSpans(const SpanRequestsContainer & requests, QAtomicInt & next, const QAtomicInt & run);
+
+		/**
+		 * Read a span of elements in a single transaction. Generic implementation of readIrSpan(), readRSpan(), readIbSpan()
+		 * and readBSpan(). If device rejects the span with an exception, span is bisected until rejected addresses are
+		 * isolated. Rejected addresses are remembered, so that subsequent spans do not cross them.
+		 * @param container data container.
+		 * @param lock lock guarding the container. Spans are read under read lock, so that spans of the same table can be
+		 * read simultaneously over pooled connections, while single element reads and writes take write lock.
+		 * @param table table corresponding to the container.
+		 * @param readFn connection function used to read the values.
+		 * @param addr address of the first element.
+		 * @param num number of elements.
+		 * @param errorCode error code emitted in case of communication failure.
+		 */
+		template <typename CONTAINER, typename VALUE>
+		void readSpan(CONTAINER & container, QReadWriteLock & lock, internal::ReadPlan::table_t table, int (internal::AbstractConnection:: * readFn)(int, int, VALUE *), int addr, int num, int errorCode);
+
+		/**
+		 * Remember address, which has been rejected by the device with an exception. Rejected addresses are no longer read
+		 * until client connects again.
+		 * @param table table of the address.
+		 * @param addr address.
+		 */
+		void rejectAddress(internal::ReadPlan::table_t table, int addr);
+
+		/**
+		 * Check whether address has been rejected by the device.
+		 * @param table table of the address.
+		 * @param addr address.
+		 * @return @p true if address has been rejected since client has connected, @p false otherwise.
+		 */
+		bool rejected(internal::ReadPlan::table_t table, int addr) const;
+
+		/**
+		 * Get addresses, which have been rejected by the device.
+		 * @param table table.
+		 * @return set of addresses, which have been rejected since client has connected.
+		 */
+		QSet<int> rejectedAddresses(internal::ReadPlan::table_t table) const;
+
+		/**
+		 * Mark values of good quality as stale.
+		 * @param container container to process.
+		 */
+		template <typename CONTAINER>
+		void markStale(const CONTAINER & container);
+
+		/**
+		 * Collect addresses of elements awaken since given stamp.
+		 * @param container container to process.
+		 * @param stamp awake stamp.
+		 * @return sorted list of addresses of elements, which have been awaken since @a stamp and which are still wakeful.
 		 */
 		template <typename CONTAINER>
-		void readRegisters(const CONTAINER & container, void (Client:: * readFn)(int), const QAtomicInt & run);
+		static QList<int> AwakenAddresses(const CONTAINER & container, int stamp);
+
+		/**
+		 * Read queued addresses. Addresses are removed from the queue as they are being read.
+		 * @param queue queue of addresses.
+		 * @param readFn read function.
+		 * @param run indicates whether to interrupt read.
+		 */
+		void readQueued(QList<int> & queue, void (Client:: * readFn)(int), const QAtomicInt & run);
+
+		/**
+		 * Push write request to the write queue. Starts processing the queue if it is not being processed already.
+		 * @param request write request.
+		 */
+		void pushWriteRequest(const WriteRequest & request);
+
+		/**
+		 * Process write queue. Requests are processed in order until queue becomes empty.
+		 */
+		void processWriteQueue();
 
 		struct Members
 		{
@@ -232,13 +543,26 @@ class CUTEHMI_MODBUS_API Client:
 			BDataContainer bData;
 			QQmlListProperty<Coil> b;
 			std::unique_ptr<internal::AbstractConnection> connection;
-			QSignalMapper * rValueRequestMapper;
-			QSignalMapper * bValueRequestMapper;
-			QMutex rMutex;
-			QMutex irMutex;
-			QMutex bMutex;
-			QMutex ibMutex;
+			QReadWriteLock rLock;
+			QReadWriteLock irLock;
+			QReadWriteLock bLock;
+			QReadWriteLock ibLock;
 			QMutex connectionMutex;
+			QAtomicInt maxAge;
+			QHash<QString, AddressSet> declaredScreens;
+			QHash<QString, AddressSet> learnedScreens;
+			ScreenStampsContainer screenStamps;
+			mutable QMutex screensMutex;
+			AddressSet prefetchQueue;
+			QMutex prefetchMutex;
+			QQueue<WriteRequest> writeQueue;
+			bool writeQueueProcessing;
+			QMutex writeQueueMutex;
+			std::shared_ptr<const internal::ReadPlan> readPlan;
+			QVector<int> sortedKeys[internal::ReadPlan::TABLES_COUNT];
+			QSet<int> rejectedAddresses[internal::ReadPlan::TABLES_COUNT];
+			mutable QMutex rejectedAddressesMutex;
+			quint64 scanCounter;
 
 			Members(Client * p_client, std::unique_ptr<internal::AbstractConnection> p_connection):
 				ir(p_client, & irData, Client::Count<InputRegister>, Client::IrAt),
@@ -246,8 +570,9 @@ class CUTEHMI_MODBUS_API Client:
 				ib(p_client, & ibData, Client::Count<DiscreteInput>, Client::IbAt),
 				b(p_client, & bData, Client::Count<Coil>, Client::BAt),
 				connection(std::move(p_connection)),
-				rValueRequestMapper(new QSignalMapper(p_client)),
-				bValueRequestMapper(new QSignalMapper(p_client))
+				maxAge(0),
+				writeQueueProcessing(false),
+				scanCounter(0)
 			{
 			}
 		};
@@ -259,34 +584,158 @@ template <typename T>
 T * Client::At(QQmlListProperty<T> * property, int index, void (*onCreate)(QQmlListProperty<T> *, int, T *))
 {
 	typedef typename internal::RegisterTraits<T>::Container Container;
-	Container * propertyData = static_cast<Container *>(property->data);
-	typename Container::iterator it = propertyData->find(index);
-	if (it == propertyData->end()) {
-		it = propertyData->insert(index, new T);
-		if (onCreate != nullptr)
-			onCreate(property, index, *it);
+	typename T::Data * data = DataAt<Container>(*static_cast<Container *>(property->data), index);
+
+	// Facade is created on demand. It is detached from the data and deleted, once its last user rests it.
+	data->lock.lockForWrite();
+	T * facade = data->facade;
+	bool created = facade == nullptr;
+	if (created) {
+		facade = new T(*data, property->object);
+		data->facade = facade;
 	}
+	data->lock.unlock();
+
+	if (created && (onCreate != nullptr))
+		onCreate(property, index, facade);
+	return facade;
+}
+
+template <typename CONTAINER>
+typename CONTAINER::value_type Client::DataAt(CONTAINER & container, int index)
+{
+	typedef typename std::remove_pointer<typename CONTAINER::value_type>::type Data;
+
+	typename CONTAINER::iterator it = container.find(index);
+	if (it == container.end())
+		it = container.insert(index, new Data);
 	return *it;
 }
 
 template <typename T>
 int Client::Count(QQmlListProperty<T> * property)
 {
-	Q_UNUSED(property);
+	typedef typename internal::RegisterTraits<T>::Container Container;
 
-	return std::numeric_limits<int>::max();
+	return static_cast<int>(static_cast<const Container *>(property->data)->size());
 }
 
 template <typename CONTAINER>
-void Client::readRegisters(const CONTAINER & container, void (Client:: * readFn)(int), const QAtomicInt & run)
+void Client::collectWakefulSpans(const CONTAINER & container, QVector<int> & sortedKeys, internal::ReadPlan::table_t table, SpanRequestsContainer & requests)
 {
+	// Keys are only appended to the container, so it is enough to merge the ones, which have not been seen yet.
 	typename CONTAINER::KeysIterator keysIt(container);
+	for (int skip = sortedKeys.count(); skip > 0 && keysIt.hasNext(); skip--)
+		keysIt.next();
 	while (keysIt.hasNext()) {
-		if (!run.load())
+		int addr = static_cast<int>(keysIt.next());
+		sortedKeys.insert(std::lower_bound(sortedKeys.begin(), sortedKeys.end(), addr), addr);
+	}
+
+	const internal::ReadPlan * plan = m->readPlan.get();
+	QSet<int> rejectedAddrs = rejectedAddresses(table);
+	int maxSpan = internal::ReadPlan::MaxSpan(table);
+	int spanAddr = 0;
+	int spanCount = 0;
+	for (int addr : sortedKeys) {
+		// Skipping rejected address breaks the span, so that spans do not cross rejected addresses.
+		if (!container.at(addr)->wakeful() || ((plan != nullptr) && plan->covers(table, addr)) || rejectedAddrs.contains(addr))
+			continue;
+		if ((spanCount > 0) && (spanAddr + spanCount == addr) && (spanCount < maxSpan)) {
+			spanCount++;
+			continue;
+		}
+		if (spanCount > 0)
+			requests.append(SpanRequest{table, spanAddr, spanCount});
+		spanAddr = addr;
+		spanCount = 1;
+	}
+	if (spanCount > 0)
+		requests.append(SpanRequest{table, spanAddr, spanCount});
+}
+
+template <typename CONTAINER, typename VALUE>
+void Client::readSpan(CONTAINER & container, QReadWriteLock & lock, internal::ReadPlan::table_t table, int (internal::AbstractConnection:: * readFn)(int, int, VALUE *), int addr, int num, int errorCode)
+{
+	typedef typename std::remove_pointer<typename CONTAINER::value_type>::type Data;
+
+	struct Part
+	{
+		int addr;
+		int num;
+	};
+
+	Q_ASSERT(num <= internal::ReadPlan::MAX_BITS_SPAN);
+	for (int i = 0; i < num; i++)
+		Q_ASSERT_X(container.at(addr + i) != nullptr, __func__, "element has not been referenced yet");
+
+	QReadLocker locker(& lock);
+	int maxAge = m->maxAge.loadAcquire();
+	if (maxAge > 0) {
+		bool fresh = true;
+		for (int i = 0; fresh && (i < num); i++)
+			fresh = container.at(addr + i)->fresh(maxAge);
+		if (fresh)
 			return;
+	}
+
+	// Parts are processed from the top of the stack, so the lower half is pushed last to read addresses in order.
+	QVarLengthArray<Part, 16> parts;
+	parts.append(Part{addr, num});
+	VALUE vals[internal::ReadPlan::MAX_BITS_SPAN];
+	while (!parts.isEmpty()) {
+		Part part = parts.last();
+		parts.removeLast();
+		CUTEHMI_MODBUS_QDEBUG("Reading span of '" << part.num << "' values starting at address '" << part.addr << "'.");
+		int result = (m->connection.get()->*readFn)(part.addr, part.num, vals);
+		if (result == part.num)
+			for (int i = 0; i < part.num; i++)
+				container.at(part.addr + i)->updateValue(vals[i]);
+		else if (result == internal::AbstractConnection::ERROR_OUT_OF_RANGE) {
+			if (part.num == 1) {
+				container.at(part.addr)->updateQuality(Data::Facade::OUT_OF_RANGE);
+				rejectAddress(table, part.addr);
+			} else {
+				int half = part.num / 2;
+				parts.append(Part{part.addr + half, part.num - half});
+				parts.append(Part{part.addr, half});
+			}
+		} else {
+			// Communication failure affects remaining parts as well.
+			parts.append(part);
+			for (const Part & failed : parts)
+				for (int i = 0; i < failed.num; i++)
+					container.at(failed.addr + i)->updateQuality(Data::Facade::COMM_FAILURE);
+			emit error(base::errorInfo(Error(errorCode)));
+			return;
+		}
+	}
+}
+
+template <typename CONTAINER>
+QList<int> Client::AwakenAddresses(const CONTAINER & container, int stamp)
+{
+	QList<int> result;
+	typename CONTAINER::KeysIterator keysIt(container);
+	while (keysIt.hasNext()) {
 		typename CONTAINER::KeysContainer::value_type addr = keysIt.next();
-		if (container.at(addr)->wakeful())
-			(this->*readFn)(addr);
+		if (container.at(addr)->awakenSince(stamp))
+			result.append(static_cast<int>(addr));
+	}
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+template <typename CONTAINER>
+void Client::markStale(const CONTAINER & container)
+{
+	typedef typename std::remove_pointer<typename CONTAINER::value_type>::type Data;
+
+	typename CONTAINER::KeysIterator keysIt(container);
+	while (keysIt.hasNext()) {
+		Data * data = container.at(keysIt.next());
+		if (data->loadQuality() == Data::Facade::GOOD)
+			data->updateQuality(Data::Facade::STALE);
 	}
 }
 
@@ -2,11 +2,12 @@
 #define CUTEHMI_CUTEHMI__MODBUS__1__LIB_INCLUDE_MODBUS_COIL_HPP
 
 #include "internal/common.hpp"
+#include "internal/RegisterData.hpp"
 
 #include <QObject>
-#include <QMutex>
-#include <QReadWriteLock>
-#include <QAtomicInt>
+#include <QDateTime>
+
+#include <memory>
 
 namespace cutehmi {
 namespace modbus {
@@ -17,6 +18,16 @@ class CUTEHMI_MODBUS_API Coil:
 	Q_OBJECT
 
 	public:
+		typedef internal::RegisterData<Coil, bool> Data;
+
+		enum quality_t {
+			GOOD,			///< Value has been successfully read from the device.
+			STALE,			///< Value has not been refreshed since it was last read (or it has never been read).
+			COMM_FAILURE,	///< Last attempt to read the value has failed due to communication error.
+			OUT_OF_RANGE	///< Device has rejected last read request with an exception (e.g. illegal data address).
+		};
+		Q_ENUM(quality_t)
+
 		/**
 		 * Constructor.
 		 * @param value initial value.
@@ -24,16 +35,48 @@ class CUTEHMI_MODBUS_API Coil:
 		 */
 		explicit Coil(bool value = false, QObject * parent = 0);
 
+		/**
+		 * Facade constructor.
+		 * @param data coil data. Data must outlive the object.
+		 * @param parent parent object.
+		 */
+		explicit Coil(Data & data, QObject * parent = 0);
+
 		Q_INVOKABLE bool value() const;
 
 		Q_INVOKABLE bool requestedValue() const;
 
+		/**
+		 * Rest. If object is a facade of client data and this was its last user, object gets detached from the data and it
+		 * is scheduled for deletion. Pointer to the object should not be used after calling this function.
+		 */
 		Q_INVOKABLE void rest();
 
 		Q_INVOKABLE void awake();
 
 		Q_INVOKABLE bool wakeful() const;
 
+		/**
+		 * Get timestamp of the value.
+		 * @return time at which value has been read from the device or invalid date time if value has not been read yet.
+		 */
+		Q_INVOKABLE QDateTime timestamp() const;
+
+		/**
+		 * Get quality of the value.
+		 * @return quality of the value.
+		 */
+		Q_INVOKABLE quality_t quality() const;
+
+		/**
+		 * Check whether value is fresh.
+		 * @param maxAge maximal age of the value [ms].
+		 * @return @p true if value is of good quality and it has been read within last @a maxAge milliseconds, @p false otherwise.
+		 *
+		 * @note this function is thread-safe.
+		 */
+		bool fresh(int maxAge) const;
+
 		Q_INVOKABLE int pendingRequests() const;
 
 	public slots:
@@ -47,11 +90,21 @@ class CUTEHMI_MODBUS_API Coil:
 		 */
 		void updateValue(bool value);
 
+		/**
+		 * Update quality. Value remains untouched.
+		 * @param quality new quality.
+		 *
+		 * @note this function is thread-safe.
+		 */
+		void updateQuality(quality_t quality);
+
 	signals:
 		void valueRequested();
 
 		void valueUpdated();
 
+		void qualityChanged();
+
 		/**
 		 * Value written. This signal is emitted when requested value has been written to the client device.
 		 */
@@ -62,27 +115,20 @@ class CUTEHMI_MODBUS_API Coil:
 		 */
 		void valueRejected();
 
-	private slots:
-		void onValueWritten();
-
-		void onValueRejected();
-
 	private:
 		struct Members
 		{
-			bool value;
-			mutable QReadWriteLock valueLock;
-			bool reqValue;
-			mutable QMutex reqValueMutex;
-			QAtomicInt awaken;
-			int writeCtr;
-			mutable QReadWriteLock writeCtrLock;
-
-			Members(bool p_value):
-				value(p_value),
-				reqValue(p_value),
-				awaken(0),
-				writeCtr(0)
+			std::unique_ptr<Data> ownedData;
+			Data * data;
+
+			Members(std::unique_ptr<Data> p_ownedData):
+				ownedData(std::move(p_ownedData)),
+				data(ownedData.get())
+			{
+			}
+
+			Members(Data * p_data):
+				data(p_data)
 			{
 			}
 		};
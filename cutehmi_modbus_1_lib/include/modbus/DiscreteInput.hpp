@@ -2,10 +2,12 @@
 #define CUTEHMI_CUTEHMI__MODBUS__1__LIB_INCLUDE_MODBUS_DISCRETEINPUT_HPP
 
 #include "internal/common.hpp"
+#include "internal/RegisterData.hpp"
 
 #include <QObject>
-#include <QReadWriteLock>
-#include <QAtomicInt>
+#include <QDateTime>
+
+#include <memory>
 
 namespace cutehmi {
 namespace modbus {
@@ -16,6 +18,16 @@ class CUTEHMI_MODBUS_API DiscreteInput:
 	Q_OBJECT
 
 	public:
+		typedef internal::RegisterData<DiscreteInput, bool> Data;
+
+		enum quality_t {
+			GOOD,			///< Value has been successfully read from the device.
+			STALE,			///< Value has not been refreshed since it was last read (or it has never been read).
+			COMM_FAILURE,	///< Last attempt to read the value has failed due to communication error.
+			OUT_OF_RANGE	///< Device has rejected last read request with an exception (e.g. illegal data address).
+		};
+		Q_ENUM(quality_t)
+
 		/**
 		 * Constructor.
 		 * @param value initial value.
@@ -23,14 +35,46 @@ class CUTEHMI_MODBUS_API DiscreteInput:
 		 */
 		explicit DiscreteInput(bool value = false, QObject * parent = 0);
 
+		/**
+		 * Facade constructor.
+		 * @param data input data. Data must outlive the object.
+		 * @param parent parent object.
+		 */
+		explicit DiscreteInput(Data & data, QObject * parent = 0);
+
 		Q_INVOKABLE bool value() const;
 
+		/**
+		 * Rest. If object is a facade of client data and this was its last user, object gets detached from the data and it
+		 * is scheduled for deletion. Pointer to the object should not be used after calling this function.
+		 */
 		Q_INVOKABLE void rest();
 
 		Q_INVOKABLE void awake();
 
 		Q_INVOKABLE bool wakeful() const;
 
+		/**
+		 * Get timestamp of the value.
+		 * @return time at which value has been read from the device or invalid date time if value has not been read yet.
+		 */
+		Q_INVOKABLE QDateTime timestamp() const;
+
+		/**
+		 * Get quality of the value.
+		 * @return quality of the value.
+		 */
+		Q_INVOKABLE quality_t quality() const;
+
+		/**
+		 * Check whether value is fresh.
+		 * @param maxAge maximal age of the value [ms].
+		 * @return @p true if value is of good quality and it has been read within last @a maxAge milliseconds, @p false otherwise.
+		 *
+		 * @note this function is thread-safe.
+		 */
+		bool fresh(int maxAge) const;
+
 	public slots:
 		/**
 		 * Update value.
@@ -40,19 +84,33 @@ class CUTEHMI_MODBUS_API DiscreteInput:
 		 */
 		void updateValue(bool value);
 
+		/**
+		 * Update quality. Value remains untouched.
+		 * @param quality new quality.
+		 *
+		 * @note this function is thread-safe.
+		 */
+		void updateQuality(quality_t quality);
+
 	signals:
 		void valueUpdated();
 
+		void qualityChanged();
+
 	private:
 		struct Members
 		{
-			bool value;
-			mutable QReadWriteLock valueLock;
-			QAtomicInt awaken;
+			std::unique_ptr<Data> ownedData;
+			Data * data;
+
+			Members(std::unique_ptr<Data> p_ownedData):
+				ownedData(std::move(p_ownedData)),
+				data(ownedData.get())
+			{
+			}
 
-			Members(bool p_value):
-				value(p_value),
-				awaken(0)
+			Members(Data * p_data):
+				data(p_data)
 			{
 			}
 		};
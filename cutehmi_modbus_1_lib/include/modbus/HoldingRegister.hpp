@@ -2,12 +2,13 @@
 #define CUTEHMI_CUTEHMI__MODBUS__1__LIB_INCLUDE_MODBUS_HOLDINGREGISTER_HPP
 
 #include "internal/common.hpp"
+#include "internal/RegisterData.hpp"
 
 #include <QObject>
-#include <QMutex>
-#include <QReadWriteLock>
 #include <QVariant>
-#include <QAtomicInt>
+#include <QDateTime>
+
+#include <memory>
 
 namespace cutehmi {
 namespace modbus {
@@ -16,7 +17,8 @@ namespace modbus {
  * Modbus holding register. This class represents Modbus holding registers.
  * According to Modbus specification each holding register holds 16 bit data.
  * Objects of this class act as a convenient proxy between instances of QML HoldingRegisterItem and Client.
- * Methods of this class are thread-safe.
+ * Client keeps its process image in lightweight internal::RegisterData descriptors and creates objects of
+ * this class only as facades for addresses, which are actually referenced. Methods of this class are thread-safe.
  *
  * @note to make this class accessible from QML it must inherit after QObject,
  * thus keep in mind that this class is relatively heavy.
@@ -27,11 +29,21 @@ class CUTEHMI_MODBUS_API HoldingRegister:
 	Q_OBJECT
 
 	public:
+		typedef internal::RegisterData<HoldingRegister, uint16_t> Data;
+
 		enum encoding_t {
 			INT16
 		};
 		Q_ENUM(encoding_t)
 
+		enum quality_t {
+			GOOD,			///< Value has been successfully read from the device.
+			STALE,			///< Value has not been refreshed since it was last read (or it has never been read).
+			COMM_FAILURE,	///< Last attempt to read the value has failed due to communication error.
+			OUT_OF_RANGE	///< Device has rejected last read request with an exception (e.g. illegal data address).
+		};
+		Q_ENUM(quality_t)
+
 		/**
 		 * Constructor.
 		 * @param value initial value.
@@ -39,16 +51,56 @@ class CUTEHMI_MODBUS_API HoldingRegister:
 		 */
 		explicit HoldingRegister(uint16_t value = 0, QObject * parent = 0);
 
+		/**
+		 * Facade constructor.
+		 * @param data register data. Data must outlive the object.
+		 * @param parent parent object.
+		 */
+		explicit HoldingRegister(Data & data, QObject * parent = 0);
+
+		/**
+		 * Decode raw register value.
+		 * @param value raw register value.
+		 * @param encoding encoding.
+		 * @return decoded value.
+		 */
+		static QVariant Decode(uint16_t value, encoding_t encoding = INT16);
+
 		Q_INVOKABLE QVariant value(encoding_t encoding = INT16) const;
 
 		Q_INVOKABLE uint16_t requestedValue() const;
 
+		/**
+		 * Rest. If object is a facade of client data and this was its last user, object gets detached from the data and it
+		 * is scheduled for deletion. Pointer to the object should not be used after calling this function.
+		 */
 		Q_INVOKABLE void rest();
 
 		Q_INVOKABLE void awake();
 
 		Q_INVOKABLE bool wakeful() const;
 
+		/**
+		 * Get timestamp of the value.
+		 * @return time at which value has been read from the device or invalid date time if value has not been read yet.
+		 */
+		Q_INVOKABLE QDateTime timestamp() const;
+
+		/**
+		 * Get quality of the value.
+		 * @return quality of the value.
+		 */
+		Q_INVOKABLE quality_t quality() const;
+
+		/**
+		 * Check whether value is fresh.
+		 * @param maxAge maximal age of the value [ms].
+		 * @return @p true if value is of good quality and it has been read within last @a maxAge milliseconds, @p false otherwise.
+		 *
+		 * @note this function is thread-safe.
+		 */
+		bool fresh(int maxAge) const;
+
 		Q_INVOKABLE int pendingRequests() const;
 
 	public slots:
@@ -62,11 +114,21 @@ class CUTEHMI_MODBUS_API HoldingRegister:
 		 */
 		void updateValue(uint16_t value);
 
+		/**
+		 * Update quality. Value remains untouched.
+		 * @param quality new quality.
+		 *
+		 * @note this function is thread-safe.
+		 */
+		void updateQuality(quality_t quality);
+
 	signals:
 		void valueRequested();
 
 		void valueUpdated();
 
+		void qualityChanged();
+
 		/**
 		 * Value written. This signal is emitted when requested value has been written to the client device.
 		 */
@@ -77,27 +139,20 @@ class CUTEHMI_MODBUS_API HoldingRegister:
 		 */
 		void valueRejected();
 
-	private slots:
-		void onValueWritten();
-
-		void onValueRejected();
-
 	private:
 		struct Members
 		{
-			uint16_t value;
-			mutable QReadWriteLock valueLock;
-			uint16_t reqValue;
-			mutable QMutex reqValueMutex;
-			QAtomicInt awaken;
-			int writeCtr;
-			mutable QReadWriteLock writeCtrLock;
-
-			Members(uint16_t p_value):
-				value(p_value),
-				reqValue(p_value),
-				awaken(0),
-				writeCtr(0)
+			std::unique_ptr<Data> ownedData;
+			Data * data;
+
+			Members(std::unique_ptr<Data> p_ownedData):
+				ownedData(std::move(p_ownedData)),
+				data(ownedData.get())
+			{
+			}
+
+			Members(Data * p_data):
+				data(p_data)
 			{
 			}
 		};
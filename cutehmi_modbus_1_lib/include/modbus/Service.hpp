@@ -3,6 +3,7 @@
 
 #include "internal/common.hpp"
 #include "internal/ServiceThread.hpp"
+#include "internal/ServiceTask.hpp"
 
 #include <base/ErrorInfo.hpp>
 #include <services/Service.hpp>
@@ -22,10 +23,25 @@ class CUTEHMI_MODBUS_API Service:
 	Q_OBJECT
 
 	public:
-		Service(const QString & name, Client * client, QObject * parent = 0);
+		enum execution_t {
+			THREAD,	///< Service runs in its own thread.
+			POOL	///< Service is scheduled on a worker shared with other pooled services (see internal::ServiceWorkerPool).
+		};
+
+		/**
+		 * Constructor.
+		 * @param name service name.
+		 * @param client Modbus client.
+		 * @param execution execution mode. Pooled execution is recommended, when there are many devices, because it does
+		 * not require one thread per device.
+		 * @param parent parent object.
+		 */
+		Service(const QString & name, Client * client, execution_t execution = THREAD, QObject * parent = 0);
 
 		~Service() override;
 
+		execution_t execution() const;
+
 		unsigned long sleep() const;
 
 		void setSleep(unsigned long sleep);
@@ -60,18 +76,26 @@ class CUTEHMI_MODBUS_API Service:
 		void handleError(cutehmi::base::ErrorInfo errorInfo);
 
 	private:
+		/**
+		 * Get object, which performs the service (ServiceThread or ServiceTask).
+		 * @return runner object.
+		 */
+		QObject * runner() const;
+
 		static constexpr long MAX_BROKEN_SERVICE_WAIT = 600000; // [ms] = 10 minutes.
 		static constexpr int INITIAL_BROKEN_SERVICE_WAIT = 5000; // [ms] = 5 seconds.
 
 		struct Members
 		{
 			std::unique_ptr<internal::ServiceThread> thread;
+			std::unique_ptr<internal::ServiceTask> task;
 			Client * client;
 			QStateMachine sm;
 			int brokenServiceWait;
 
-			Members(Client * p_client):
-				thread(new internal::ServiceThread(p_client)),
+			Members(Client * p_client, execution_t execution):
+				thread(execution == THREAD ? new internal::ServiceThread(p_client) : nullptr),
+				task(execution == POOL ? new internal::ServiceTask(p_client) : nullptr),
 				client(p_client),
 				brokenServiceWait(INITIAL_BROKEN_SERVICE_WAIT)
 			{
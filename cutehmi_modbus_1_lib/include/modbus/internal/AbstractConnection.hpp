@@ -12,6 +12,14 @@ namespace internal {
 class CUTEHMI_MODBUS_API AbstractConnection
 {
 	public:
+		/**
+		 * Error codes. Negative values returned by read and write functions.
+		 */
+		enum Error : int {
+			ERROR_COMMUNICATION = -1,	///< Communication failure (broken connection, timeout, corrupted frame etc.).
+			ERROR_OUT_OF_RANGE = -2		///< Device has responded with an exception (illegal data address or illegal data value).
+		};
+
 		virtual ~AbstractConnection() = default;
 
 		virtual bool connect() = 0;
@@ -20,6 +28,14 @@ class CUTEHMI_MODBUS_API AbstractConnection
 
 		virtual bool connected() const = 0;
 
+		/**
+		 * Get number of transactions, which can be carried out simultaneously.
+		 * @return maximal number of simultaneous transactions. Default implementation returns @p 1.
+		 *
+		 * @note connection must be thread-safe, if it returns value greater than @p 1.
+		 */
+		virtual int concurrency() const;
+
 		virtual int readIr(int addr, int num, uint16_t * dest) = 0;
 
 		virtual int readR(int addr, int num, uint16_t * dest) = 0;
@@ -31,7 +47,7 @@ class CUTEHMI_MODBUS_API AbstractConnection
 		 * @param addr address of first discrete input to read.
 		 * @param num number of inputs to read.
 		 * @param dest destination pointer. Array must have sufficient space allocated to store @num elements.
-		 * @return number of inputs read or -1 in case of error.
+		 * @return number of inputs read or one of Error codes in case of error.
 		 *
 		 * @internal One could use std::vector<bool> or other space-efficient type for @a dest array, but
 		 * bool pointer is more flexible (as it can interoperate with many data types).
@@ -46,6 +62,11 @@ class CUTEHMI_MODBUS_API AbstractConnection
 		AbstractConnection() = default;
 };
 
+inline int AbstractConnection::concurrency() const
+{
+	return 1;
+}
+
 }
 }
 }
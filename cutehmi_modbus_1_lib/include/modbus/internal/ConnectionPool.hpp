@@ -0,0 +1,134 @@
+#ifndef CUTEHMI_CUTEHMI__MODBUS__1__LIB_INCLUDE_MODBUS_INTERNAL_CONNECTIONPOOL_HPP
+#define CUTEHMI_CUTEHMI__MODBUS__1__LIB_INCLUDE_MODBUS_INTERNAL_CONNECTIONPOOL_HPP
+
+#include "common.hpp"
+#include "AbstractConnection.hpp"
+
+#include <utils/NonCopyable.hpp>
+#include <utils/NonMovable.hpp>
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QList>
+
+#include <vector>
+#include <memory>
+
+namespace cutehmi {
+namespace modbus {
+namespace internal {
+
+/**
+ * Connection pool. Set of connections to the same device. Each transaction is performed by one of the idle connections,
+ * so that up to concurrency() transactions may be carried out simultaneously. Connections are established in parallel.
+ * If some of the connections can not be established (device may limit number of sessions), remaining ones are used. A
+ * connection, which fails with communication error, is evicted from the pool and it is reconnected in the background,
+ * while transactions continue over remaining connections.
+ */
+class CUTEHMI_MODBUS_API ConnectionPool:
+	public AbstractConnection,
+	public utils::NonCopyable,
+	public utils::NonMovable
+{
+	public:
+		/**
+		 * Constructor.
+		 * @param connections connections to the same device. Must not be empty.
+		 * @param maxConcurrent maximal number of simultaneous transactions. Value is clipped to number of connections.
+		 * Value of @p 0 means that number of connections is used.
+		 */
+		explicit ConnectionPool(std::vector<std::unique_ptr<AbstractConnection>> connections, int maxConcurrent = 0);
+
+		~ConnectionPool() override;
+
+		/**
+		 * Get number of connections in the pool.
+		 * @return number of connections.
+		 */
+		int count() const;
+
+		int concurrency() const override;
+
+		bool connect() override;
+
+		void disconnect() override;
+
+		bool connected() const override;
+
+		int readIr(int addr, int num, uint16_t * dest) override;
+
+		int readR(int addr, int num, uint16_t * dest) override;
+
+		int writeR(int addr, uint16_t value) override;
+
+		int readIb(int addr, int num, bool * dest) override;
+
+		int readB(int addr, int num, bool * dest) override;
+
+		int writeB(int addr, bool value) override;
+
+	private:
+		/**
+		 * Acquire idle connection. Function blocks until connection becomes available or concurrency limit allows to use it.
+		 * @return acquired connection or @p nullptr if none of the connections is connected.
+		 */
+		AbstractConnection * acquire();
+
+		/**
+		 * Release connection acquired with acquire().
+		 * @param connection connection to release.
+		 * @param failed indicates that transaction has failed with communication error. Failed connection is evicted and
+		 * reconnected in the background.
+		 */
+		void release(AbstractConnection * connection, bool failed);
+
+		/**
+		 * Reconnect evicted connection. Connection is put back to the pool if it has been reconnected successfully.
+		 * @param connection evicted connection.
+		 */
+		void reconnect(AbstractConnection * connection);
+
+		/**
+		 * Perform transaction using idle connection.
+		 * @param fn function performing transaction on a connection.
+		 * @return value returned by @a fn or ERROR_COMMUNICATION if none of the connections is connected.
+		 */
+		template <typename FN>
+		int transaction(FN fn);
+
+		struct Members
+		{
+			std::vector<std::unique_ptr<AbstractConnection>> connections;
+			int maxConcurrent;
+			QList<AbstractConnection *> idle;
+			QList<AbstractConnection *> down;
+			int busy;
+			int connected;
+			int connecting;
+			mutable QMutex mutex;
+			QWaitCondition idleCondition;
+			QMutex connectMutex;
+
+			Members(std::vector<std::unique_ptr<AbstractConnection>> p_connections, int p_maxConcurrent):
+				connections(std::move(p_connections)),
+				maxConcurrent(p_maxConcurrent),
+				busy(0),
+				connected(0),
+				connecting(0)
+			{
+				for (std::unique_ptr<AbstractConnection> & connection : connections)
+					down.append(connection.get());
+			}
+		};
+
+		utils::MPtr<Members> m;
+};
+
+}
+}
+}
+
+#endif
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
@@ -0,0 +1,258 @@
+#ifndef CUTEHMI_CUTEHMI__MODBUS__1__LIB_INCLUDE_MODBUS_INTERNAL_DISCOVERYSCANNER_HPP
+#define CUTEHMI_CUTEHMI__MODBUS__1__LIB_INCLUDE_MODBUS_INTERNAL_DISCOVERYSCANNER_HPP
+
+#include "common.hpp"
+#include "AbstractConnection.hpp"
+
+#include <QList>
+#include <QString>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+
+#include <functional>
+#include <memory>
+
+namespace cutehmi {
+namespace modbus {
+namespace internal {
+
+/**
+ * Discovery scanner. Probes unit identifiers and address spaces of Modbus devices to find out, which units respond and
+ * which registers and coils they expose. Address space is read in blocks. Units and blocks are probed concurrently over
+ * a cache of connections, which is bounded by the limit of simultaneous connections. If device rejects a block with an
+ * exception, boundaries of readable prefix and suffix of the block are located by binary search and the part in between
+ * is bisected, until it gets shorter than minimal gap size. Requests issued by all the connections are throttled by a
+ * common request-rate ceiling.
+ *
+ * Results can be converted to a register map XML fragment, which can be pasted into @p client section of
+ * @p cutehmi_modbus_1 project file.
+ */
+class CUTEHMI_MODBUS_API DiscoveryScanner
+{
+	public:
+		/**
+		 * Connection factory. Function should return connection, which addresses unit of given identifier.
+		 */
+		typedef std::function<std::unique_ptr<AbstractConnection>(int unitId)> ConnectionFactory;
+
+		/**
+		 * Address range.
+		 */
+		struct Range
+		{
+			int address;
+			int count;
+		};
+
+		/**
+		 * Unit map. Readable address ranges of a single unit.
+		 */
+		struct UnitMap
+		{
+			int unitId;
+			QList<Range> ir;
+			QList<Range> r;
+			QList<Range> ib;
+			QList<Range> b;
+		};
+
+		static constexpr int ADDR_SPACE_SIZE = 65536;
+
+		explicit DiscoveryScanner(ConnectionFactory connectionFactory);
+
+		QList<int> unitIds() const;
+
+		/**
+		 * Set unit identifiers to probe.
+		 * @param unitIds list of unit identifiers. By default all valid unit identifiers (1-247) are probed.
+		 */
+		void setUnitIds(const QList<int> & unitIds);
+
+		int firstAddress() const;
+
+		int addressCount() const;
+
+		/**
+		 * Set address range to scan.
+		 * @param first first address.
+		 * @param count number of addresses. Range is clipped to Modbus address space.
+		 */
+		void setAddressRange(int first, int count);
+
+		int blockSize() const;
+
+		/**
+		 * Set block size. Address space is read in blocks of this size.
+		 * @param blockSize block size. Value is clipped to 1-125 range, so that blocks can be read in single transaction.
+		 */
+		void setBlockSize(int blockSize);
+
+		int minGapSize() const;
+
+		/**
+		 * Set minimal gap size. Parts of address space, which are rejected by the device and are shorter than this size,
+		 * are not searched for readable addresses. Ranges of readable addresses, which are not shorter than this size, are
+		 * always found. Lower values find smaller ranges at the cost of more requests.
+		 * @param minGapSize minimal gap size. Value of @p 1 searches address space exhaustively.
+		 */
+		void setMinGapSize(int minGapSize);
+
+		int maxConnections() const;
+
+		/**
+		 * Set maximal number of simultaneously open connections.
+		 * @param maxConnections maximal number of connections.
+		 */
+		void setMaxConnections(int maxConnections);
+
+		double maxRate() const;
+
+		/**
+		 * Set request-rate ceiling.
+		 * @param maxRate maximal number of requests per second issued by all connections together. Value of @p 0 disables
+		 * the limit.
+		 */
+		void setMaxRate(double maxRate);
+
+		/**
+		 * Scan units. Function blocks until scan completes.
+		 * @param run allows to interrupt the scan if set to @p 0 by other thread. Normally @p 1.
+		 * @return maps of units, which have responded.
+		 */
+		QList<UnitMap> scan(const QAtomicInt & run = 1);
+
+		/**
+		 * Convert unit maps to register map XML fragment.
+		 * @param maps unit maps.
+		 * @return XML fragment with one @p registers element per unit.
+		 */
+		static QString ToXML(const QList<UnitMap> & maps);
+
+	private:
+		enum table_t {
+			INPUT_REGISTERS,
+			HOLDING_REGISTERS,
+			DISCRETE_INPUTS,
+			COILS
+		};
+
+		class ConnectionCache;
+
+		/**
+		 * Check whether unit responds.
+		 * @param cache connection cache.
+		 * @param unitId unit identifier.
+		 * @param run interrupt flag.
+		 * @return @p true if unit has responded, @p false otherwise.
+		 */
+		bool probeUnit(ConnectionCache & cache, int unitId, const QAtomicInt & run);
+
+		/**
+		 * Probe single block of a unit over any connection from the cache.
+		 * @param cache connection cache.
+		 * @param unitId unit identifier.
+		 * @param table table to read.
+		 * @param address first address of the block.
+		 * @param count number of addresses.
+		 * @param ranges list to which readable ranges are appended.
+		 * @param run interrupt flag.
+		 */
+		void probeBlock(ConnectionCache & cache, int unitId, table_t table, int address, int count, QList<Range> & ranges, const QAtomicInt & run);
+
+		/**
+		 * Probe address range. If range is rejected, boundaries of its readable prefix and suffix are searched for and the
+		 * remaining part is bisected, unless it is shorter than minimal gap size.
+		 * @param connection connection.
+		 * @param table table to read.
+		 * @param address first address of the range.
+		 * @param count number of addresses.
+		 * @param ranges list to which readable ranges are appended.
+		 * @param run interrupt flag.
+		 * @return @p false if communication has failed, @p true otherwise.
+		 */
+		bool probe(AbstractConnection & connection, table_t table, int address, int count, QList<Range> & ranges, const QAtomicInt & run);
+
+		/**
+		 * Find readable prefix of a range, which is known to be not readable as a whole.
+		 * @param connection connection.
+		 * @param table table to read.
+		 * @param address first address of the range.
+		 * @param count number of addresses.
+		 * @param length length of the prefix.
+		 * @return @p false if communication has failed, @p true otherwise.
+		 */
+		bool findPrefix(AbstractConnection & connection, table_t table, int address, int count, int & length);
+
+		/**
+		 * Find readable suffix of a range, which is preceded by an illegal address.
+		 * @param connection connection.
+		 * @param table table to read.
+		 * @param address first address of the range.
+		 * @param end address past the last address of the range.
+		 * @param first first address of the suffix. If suffix is empty, it is set to @a end.
+		 * @return @p false if communication has failed, @p true otherwise.
+		 */
+		bool findSuffix(AbstractConnection & connection, table_t table, int address, int end, int & first);
+
+		/**
+		 * Read address range, retrying on communication failure.
+		 * @param connection connection.
+		 * @param table table to read.
+		 * @param address first address.
+		 * @param count number of addresses.
+		 * @return number of addresses read or one of AbstractConnection::Error codes.
+		 */
+		int request(AbstractConnection & connection, table_t table, int address, int count);
+
+		int read(AbstractConnection & connection, table_t table, int address, int count);
+
+		/**
+		 * Wait until request can be issued without exceeding request-rate ceiling.
+		 */
+		void throttle();
+
+		static QList<Range> & TableRanges(UnitMap & map, table_t table);
+
+		static void AppendRange(QList<Range> & ranges, int address, int count);
+
+		struct Members
+		{
+			ConnectionFactory connectionFactory;
+			QList<int> unitIds;
+			int firstAddress;
+			int addressCount;
+			int blockSize;
+			int minGapSize;
+			int maxConnections;
+			double maxRate;
+			QMutex rateMutex;
+			QElapsedTimer rateTimer;
+			qint64 nextRequestTime;	// [ns] relative to rateTimer.
+
+			Members(ConnectionFactory p_connectionFactory):
+				connectionFactory(p_connectionFactory),
+				firstAddress(0),
+				addressCount(ADDR_SPACE_SIZE),
+				blockSize(100),
+				minGapSize(8),
+				maxConnections(4),
+				maxRate(0.0),
+				nextRequestTime(0)
+			{
+				for (int unitId = 1; unitId <= 247; unitId++)
+					unitIds.append(unitId);
+			}
+		};
+
+		utils::MPtr<Members> m;
+};
+
+}
+}
+}
+
+#endif
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
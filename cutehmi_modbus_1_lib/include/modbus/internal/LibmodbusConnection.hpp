@@ -84,13 +84,19 @@ class CUTEHMI_MODBUS_API LibmodbusConnection:
 		void setContext(modbus_t * context);
 
 	private:
-		static QMutex & Mutex(); // libmodbus functions are neither thread-safe nor re-entrant. A shared mutex is required to protect the data from corruption.
+		/**
+		 * Translate libmodbus error number to error code.
+		 * @param errnum error number.
+		 * @return error code.
+		 */
+		static int ErrorFromErrno(int errnum);
 
 		struct Members
 		{
 			modbus_t * context;
 			bool connected;
 			std::vector<uint8_t> bIbBuffer;
+			QMutex mutex;	// libmodbus functions are neither thread-safe nor re-entrant for a given context. Separate contexts can be used concurrently.
 
 			Members(modbus_t * p_context):
 				context(p_context),
@@ -0,0 +1,102 @@
+#ifndef CUTEHMI_CUTEHMI__MODBUS__1__LIB_INCLUDE_MODBUS_INTERNAL_READPLAN_HPP
+#define CUTEHMI_CUTEHMI__MODBUS__1__LIB_INCLUDE_MODBUS_INTERNAL_READPLAN_HPP
+
+#include "common.hpp"
+
+#include <QList>
+#include <QVector>
+#include <QBitArray>
+
+namespace cutehmi {
+namespace modbus {
+namespace internal {
+
+/**
+ * Read plan. Immutable list of spans, which are read by the client in single transactions. Plan is compiled from
+ * declarative register map. Contiguous and overlapping ranges of the same poll class are merged into spans, which are
+ * as long as Modbus protocol allows. If address is declared in multiple poll classes, the most frequent one is used.
+ */
+class CUTEHMI_MODBUS_API ReadPlan
+{
+	public:
+		enum table_t {
+			INPUT_REGISTERS,
+			HOLDING_REGISTERS,
+			DISCRETE_INPUTS,
+			COILS,
+			TABLES_COUNT
+		};
+
+		/**
+		 * Register map entry.
+		 */
+		struct Entry
+		{
+			table_t table;
+			int address;
+			int count;
+			int poll;	///< Poll class. Range is read every @a poll scans.
+		};
+
+		/**
+		 * Span of addresses read in a single transaction.
+		 */
+		struct Span
+		{
+			int address;
+			int count;
+			int poll;
+		};
+
+		static constexpr int ADDR_SPACE_SIZE = 65536;
+		static constexpr int MAX_REGISTERS_SPAN = 125;	///< Maximal number of registers, which can be read in a single transaction.
+		static constexpr int MAX_BITS_SPAN = 2000;		///< Maximal number of coils or discrete inputs, which can be read in a single transaction.
+
+		/**
+		 * Get maximal span length.
+		 * @param table table.
+		 * @return maximal number of addresses of given table, which can be read in a single transaction.
+		 */
+		static int MaxSpan(table_t table);
+
+		/**
+		 * Constructor. Compiles register map into a read plan.
+		 * @param entries register map entries. Entries exceeding address space are clipped.
+		 */
+		explicit ReadPlan(const QList<Entry> & entries = QList<Entry>());
+
+		bool isEmpty() const;
+
+		/**
+		 * Get spans of a table.
+		 * @param table table.
+		 * @return spans ordered by address.
+		 */
+		const QVector<Span> & spans(table_t table) const;
+
+		/**
+		 * Check whether address is covered by the plan.
+		 * @param table table.
+		 * @param address address.
+		 * @return @p true if address is read according to the plan, @p false otherwise.
+		 */
+		bool covers(table_t table, int address) const;
+
+	private:
+		struct Members
+		{
+			QVector<Span> spans[TABLES_COUNT];
+			QBitArray coverage[TABLES_COUNT];
+		};
+
+		utils::MPtr<Members> m;
+};
+
+}
+}
+}
+
+#endif
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
@@ -0,0 +1,367 @@
+#ifndef CUTEHMI_CUTEHMI__MODBUS__1__LIB_INCLUDE_MODBUS_INTERNAL_REGISTERDATA_HPP
+#define CUTEHMI_CUTEHMI__MODBUS__1__LIB_INCLUDE_MODBUS_INTERNAL_REGISTERDATA_HPP
+
+#include "common.hpp"
+
+#include <QReadWriteLock>
+#include <QAtomicInt>
+#include <QDateTime>
+#include <QList>
+
+namespace cutehmi {
+namespace modbus {
+namespace internal {
+
+/**
+ * Awake stamps. Stamps are issued in increasing order each time a facade is being awaken. They are shared by all clients.
+ */
+struct CUTEHMI_MODBUS_API AwakeStamps
+{
+	/**
+	 * Issue next stamp.
+	 * @return awake stamp.
+	 *
+	 * @note this function is thread-safe.
+	 */
+	static int Next();
+
+	/**
+	 * Get most recently issued stamp.
+	 * @return awake stamp.
+	 *
+	 * @note this function is thread-safe.
+	 */
+	static int Last();
+};
+
+/**
+ * Register data. Plain-data descriptor of a register or a coil, which is stored in the client index. QObject facade
+ * (InputRegister, HoldingRegister, DiscreteInput or Coil) is created only if signals are needed for particular address.
+ * Facade is released as soon as the last one of its users rests it.
+ *
+ * @tparam FACADE facade class.
+ * @tparam VALUE value type.
+ */
+template <typename FACADE, typename VALUE>
+struct RegisterData
+{
+	typedef FACADE Facade;
+	typedef VALUE Value;
+
+	Value value;
+	Value reqValue;
+	qint64 timestamp;
+	int quality;
+	int writeCtr;
+	QAtomicInt awaken;
+	QAtomicInt awakeStamp;	///< Stamp issued by AwakeStamps::Next(), when facade has been awaken most recently.
+	Facade * facade;
+	mutable QAtomicInt facadeUsers;	///< Number of withFacade() calls, which are using the facade.
+	QList<Facade *> orphans;	///< Facades, which have been released while they were in use. Last user deletes them.
+	mutable QReadWriteLock lock;	///< Protects all members except @a awaken, @a awakeStamp and @a facadeUsers.
+
+	explicit RegisterData(Value p_value = Value());
+
+	bool wakeful() const;
+
+	/**
+	 * Awake data without creating a facade.
+	 */
+	void awake();
+
+	/**
+	 * Rest data. If this was the last user, facade (if any) is released.
+	 */
+	void rest();
+
+	/**
+	 * Record that facade has been awaken. Function should be called each time facade is being awaken, including the
+	 * cases, when it is already wakeful.
+	 */
+	void stampAwake();
+
+	/**
+	 * Check whether facade is wakeful and it has been awaken after given stamp has been issued.
+	 * @param stamp awake stamp obtained with AwakeStamps::Last().
+	 * @return @p true if facade has been awaken after @a stamp has been issued and it is still wakeful, @p false otherwise.
+	 */
+	bool awakenSince(int stamp) const;
+
+	/**
+	 * Check whether value is fresh.
+	 * @param maxAge maximal age of the value [ms].
+	 * @return @p true if value is of good quality and it has been read within last @a maxAge milliseconds, @p false otherwise.
+	 */
+	bool fresh(int maxAge) const;
+
+	Value loadValue() const;
+
+	int loadQuality() const;
+
+	qint64 loadTimestamp() const;
+
+	/**
+	 * Store value. Timestamp is set to current time and quality to good.
+	 * @param value value.
+	 * @return @p true if quality has changed, @p false otherwise.
+	 */
+	bool storeValue(Value value);
+
+	/**
+	 * Store quality.
+	 * @param quality quality.
+	 * @return @p true if quality has changed, @p false otherwise.
+	 */
+	bool storeQuality(int quality);
+
+	/**
+	 * Store requested value and increase pending requests counter.
+	 * @param value requested value.
+	 */
+	void storeRequest(Value value);
+
+	/**
+	 * Load requested value.
+	 * @return requested value.
+	 */
+	Value loadRequest() const;
+
+	/**
+	 * Decrease pending requests counter.
+	 */
+	void finishRequest();
+
+	int loadWriteCtr() const;
+
+	/**
+	 * Store value and notify the facade, if it exists.
+	 * @param value value.
+	 */
+	void updateValue(Value value);
+
+	/**
+	 * Store quality and notify the facade, if it exists.
+	 * @param quality quality.
+	 */
+	void updateQuality(int quality);
+
+	/**
+	 * Call a function on the facade, if it exists. Facade is guaranteed to stay alive during the call. Lock is not held
+	 * during the call, so function may emit signals connected to slots, which rest the facade.
+	 * @param fn function accepting facade pointer as a parameter.
+	 */
+	template <typename FN>
+	void withFacade(FN fn);
+
+	/**
+	 * Release facade. Facade is detached from data and scheduled for deletion, unless it is not attached or it has been
+	 * awaken again in the meantime. If facade is being used by withFacade(), deletion is left to its last user.
+	 * @param facade facade to release.
+	 */
+	void releaseFacade(Facade * facade);
+};
+
+template <typename FACADE, typename VALUE>
+RegisterData<FACADE, VALUE>::RegisterData(Value p_value):
+	value(p_value),
+	reqValue(p_value),
+	timestamp(0),
+	quality(Facade::STALE),
+	writeCtr(0),
+	awaken(0),
+	awakeStamp(0),
+	facade(nullptr),
+	facadeUsers(0)
+{
+}
+
+template <typename FACADE, typename VALUE>
+bool RegisterData<FACADE, VALUE>::wakeful() const
+{
+	return awaken.load();
+}
+
+template <typename FACADE, typename VALUE>
+void RegisterData<FACADE, VALUE>::awake()
+{
+	awaken.fetchAndAddOrdered(1);
+	stampAwake();
+}
+
+template <typename FACADE, typename VALUE>
+void RegisterData<FACADE, VALUE>::rest()
+{
+	if (awaken.fetchAndSubOrdered(1) == 1) {
+		lock.lockForRead();
+		Facade * currentFacade = facade;
+		lock.unlock();
+		if (currentFacade != nullptr)
+			releaseFacade(currentFacade);
+	}
+}
+
+template <typename FACADE, typename VALUE>
+void RegisterData<FACADE, VALUE>::stampAwake()
+{
+	awakeStamp.storeRelease(AwakeStamps::Next());
+}
+
+template <typename FACADE, typename VALUE>
+bool RegisterData<FACADE, VALUE>::awakenSince(int stamp) const
+{
+	// Difference is taken modulo 2^n to remain correct, when stamps wrap around.
+	return wakeful() && (static_cast<int>(static_cast<uint>(awakeStamp.loadAcquire()) - static_cast<uint>(stamp)) > 0);
+}
+
+template <typename FACADE, typename VALUE>
+bool RegisterData<FACADE, VALUE>::fresh(int maxAge) const
+{
+	QReadLocker locker(& lock);
+	return (quality == Facade::GOOD) && (QDateTime::currentMSecsSinceEpoch() - timestamp < maxAge);
+}
+
+template <typename FACADE, typename VALUE>
+typename RegisterData<FACADE, VALUE>::Value RegisterData<FACADE, VALUE>::loadValue() const
+{
+	QReadLocker locker(& lock);
+	return value;
+}
+
+template <typename FACADE, typename VALUE>
+int RegisterData<FACADE, VALUE>::loadQuality() const
+{
+	QReadLocker locker(& lock);
+	return quality;
+}
+
+template <typename FACADE, typename VALUE>
+qint64 RegisterData<FACADE, VALUE>::loadTimestamp() const
+{
+	QReadLocker locker(& lock);
+	return timestamp;
+}
+
+template <typename FACADE, typename VALUE>
+bool RegisterData<FACADE, VALUE>::storeValue(Value p_value)
+{
+	QWriteLocker locker(& lock);
+	value = p_value;
+	timestamp = QDateTime::currentMSecsSinceEpoch();
+	bool changed = quality != Facade::GOOD;
+	quality = Facade::GOOD;
+	return changed;
+}
+
+template <typename FACADE, typename VALUE>
+bool RegisterData<FACADE, VALUE>::storeQuality(int p_quality)
+{
+	QWriteLocker locker(& lock);
+	bool changed = quality != p_quality;
+	quality = p_quality;
+	return changed;
+}
+
+template <typename FACADE, typename VALUE>
+void RegisterData<FACADE, VALUE>::storeRequest(Value p_value)
+{
+	QWriteLocker locker(& lock);
+	writeCtr++;
+	reqValue = p_value;
+}
+
+template <typename FACADE, typename VALUE>
+typename RegisterData<FACADE, VALUE>::Value RegisterData<FACADE, VALUE>::loadRequest() const
+{
+	QReadLocker locker(& lock);
+	return reqValue;
+}
+
+template <typename FACADE, typename VALUE>
+void RegisterData<FACADE, VALUE>::finishRequest()
+{
+	QWriteLocker locker(& lock);
+	writeCtr--;
+}
+
+template <typename FACADE, typename VALUE>
+int RegisterData<FACADE, VALUE>::loadWriteCtr() const
+{
+	QReadLocker locker(& lock);
+	return writeCtr;
+}
+
+template <typename FACADE, typename VALUE>
+void RegisterData<FACADE, VALUE>::updateValue(Value p_value)
+{
+	bool qualityChanged = storeValue(p_value);
+	withFacade([qualityChanged](Facade * f) {
+		emit f->valueUpdated();
+		if (qualityChanged)
+			emit f->qualityChanged();
+	});
+}
+
+template <typename FACADE, typename VALUE>
+void RegisterData<FACADE, VALUE>::updateQuality(int p_quality)
+{
+	if (storeQuality(p_quality))
+		withFacade([](Facade * f) {
+			emit f->qualityChanged();
+		});
+}
+
+template <typename FACADE, typename VALUE>
+template <typename FN>
+void RegisterData<FACADE, VALUE>::withFacade(FN fn)
+{
+	// Facade is referenced under the lock, so that releaseFacade() can not delete it, but the lock itself is released
+	// before the call. Otherwise slots connected directly to facade signals would dead-lock on rest().
+	lock.lockForRead();
+	Facade * currentFacade = facade;
+	if (currentFacade != nullptr)
+		facadeUsers.ref();
+	lock.unlock();
+
+	if (currentFacade == nullptr)
+		return;
+
+	fn(currentFacade);
+
+	if (!facadeUsers.deref()) {
+		QList<Facade *> released;
+		lock.lockForWrite();
+		released.swap(orphans);
+		lock.unlock();
+
+		for (Facade * releasedFacade : released)
+			releasedFacade->deleteLater();
+	}
+}
+
+template <typename FACADE, typename VALUE>
+void RegisterData<FACADE, VALUE>::releaseFacade(Facade * p_facade)
+{
+	lock.lockForWrite();
+	bool release = (facade == p_facade) && !awaken.load();
+	bool deferred = false;
+	if (release) {
+		facade = nullptr;
+		// Users increase counter under the lock, so it can only decrease while the lock is being held.
+		deferred = facadeUsers.load() > 0;
+		if (deferred)
+			orphans.append(p_facade);
+	}
+	lock.unlock();
+
+	if (release && !deferred)
+		p_facade->deleteLater();
+}
+
+}
+}
+}
+
+#endif
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
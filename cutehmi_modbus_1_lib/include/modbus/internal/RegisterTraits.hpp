@@ -19,25 +19,29 @@ struct RegisterTraits
 template <>
 struct RegisterTraits<InputRegister>
 {
-	typedef DataContainer<InputRegister *> Container;
+	typedef InputRegister::Data Data;
+	typedef DataContainer<Data *> Container;
 };
 
 template <>
 struct RegisterTraits<HoldingRegister>
 {
-	typedef DataContainer<HoldingRegister *> Container;
+	typedef HoldingRegister::Data Data;
+	typedef DataContainer<Data *> Container;
 };
 
 template <>
 struct RegisterTraits<DiscreteInput>
 {
-	typedef DataContainer<DiscreteInput *> Container;
+	typedef DiscreteInput::Data Data;
+	typedef DataContainer<Data *> Container;
 };
 
 template <>
 struct RegisterTraits<Coil>
 {
-	typedef DataContainer<Coil *> Container;
+	typedef Coil::Data Data;
+	typedef DataContainer<Data *> Container;
 };
 
 }
@@ -0,0 +1,97 @@
+#ifndef CUTEHMI_CUTEHMI__MODBUS__1__LIB_INCLUDE_MODBUS_INTERNAL_SERVICETASK_HPP
+#define CUTEHMI_CUTEHMI__MODBUS__1__LIB_INCLUDE_MODBUS_INTERNAL_SERVICETASK_HPP
+
+#include "common.hpp"
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
+
+class QThread;
+class QTimer;
+
+namespace cutehmi {
+namespace modbus {
+
+class Client;
+
+namespace internal {
+
+/**
+ * Service task. Pooled counterpart of ServiceThread. Instead of occupying its own thread, task is scheduled on one of
+ * the ServiceWorkerPool workers. Each read cycle is a single event of the worker event loop, so that clients assigned to
+ * the same worker are served in turns, while sleep periods do not block the worker. Connection attempts are performed
+ * outside of the worker, so that device, which is being (re)connected, does not stall other devices. Task emits same
+ * signals as ServiceThread, thus it can drive the same Service state machine.
+ */
+class ServiceTask:
+	public QObject
+{
+	Q_OBJECT
+
+	public:
+		explicit ServiceTask(Client * client);
+
+		~ServiceTask() override;
+
+		unsigned long sleep() const;
+
+		void setSleep(unsigned long sleep);
+
+		/**
+		 * Wait for the task to finish. Worker thread is released afterwards.
+		 */
+		void wait();
+
+	signals:
+		void ran();
+
+		void finished();
+
+	public slots:
+		void start();
+
+		void stop();
+
+		/**
+		 * Wake up the task. Interrupts sleep between consecutive reads. This slot is thread-safe.
+		 */
+		void wake();
+
+	private slots:
+		/**
+		 * Perform read cycle. This slot is called from the worker thread.
+		 */
+		void cycle();
+
+	private:
+		/**
+		 * Connect client. This function is called from a thread of connector pool, so that worker is not blocked by
+		 * connection attempt. Once client is connected, read cycles are scheduled on the worker.
+		 */
+		void connectClient();
+
+		void finish();
+
+		void releaseThread();
+
+		QAtomicInt m_run;
+		QAtomicInt m_connected;
+		bool m_active;
+		QMutex m_mutex;
+		QWaitCondition m_finishedCondition;
+		unsigned long m_sleep;
+		QThread * m_thread;
+		QTimer * m_timer;
+		Client * m_client;
+};
+
+}
+}
+}
+
+#endif
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
@@ -5,6 +5,8 @@
 
 #include <QThread>
 #include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
 
 namespace cutehmi {
 namespace modbus {
@@ -37,8 +39,16 @@ class ServiceThread:
 
 		void stop();
 
+		/**
+		 * Wake up the thread. Interrupts sleep between consecutive reads. This slot is thread-safe.
+		 */
+		void wake();
+
 	private:
 		QAtomicInt m_run;
+		QAtomicInt m_wakeRequested;
+		QMutex m_sleepMutex;
+		QWaitCondition m_sleepCondition;
 		unsigned long m_sleep;
 		Client * m_client;
 };
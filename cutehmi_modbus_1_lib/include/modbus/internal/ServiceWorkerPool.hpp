@@ -0,0 +1,108 @@
+#ifndef CUTEHMI_CUTEHMI__MODBUS__1__LIB_INCLUDE_MODBUS_INTERNAL_SERVICEWORKERPOOL_HPP
+#define CUTEHMI_CUTEHMI__MODBUS__1__LIB_INCLUDE_MODBUS_INTERNAL_SERVICEWORKERPOOL_HPP
+
+#include "common.hpp"
+
+#include <utils/NonCopyable.hpp>
+#include <utils/NonMovable.hpp>
+
+#include <QThread>
+#include <QThreadPool>
+#include <QMutex>
+#include <QVector>
+
+#include <memory>
+
+namespace cutehmi {
+namespace modbus {
+namespace internal {
+
+/**
+ * Service worker pool. Small, fixed set of I/O threads shared by pooled services (see ServiceTask). Each worker runs an
+ * event loop, which schedules read cycles of all the clients assigned to it. Worker threads are started when first
+ * task gets assigned to them and they are stopped, when last task releases them.
+ */
+class CUTEHMI_MODBUS_API ServiceWorkerPool:
+	public utils::NonCopyable,
+	public utils::NonMovable
+{
+	public:
+		/**
+		 * Get instance.
+		 * @return a reference to the instance of the singleton class.
+		 *
+		 * @internal utils::Singleton is not being used to prevent inlining of template
+		 * function and incorporating static instance into other translation units.
+		 */
+		static ServiceWorkerPool & Instance();
+
+		/**
+		 * Get number of workers.
+		 * @return number of workers.
+		 */
+		int size() const;
+
+		/**
+		 * Set number of workers. Workers, which are running, are not affected.
+		 * @param size number of workers. Value must be greater than @p 0.
+		 *
+		 * @note this function is thread-safe.
+		 */
+		void setSize(int size);
+
+		/**
+		 * Acquire worker thread. Least loaded worker is chosen. Thread is started, if it is not running.
+		 * @return worker thread.
+		 *
+		 * @note this function is thread-safe.
+		 */
+		QThread * acquire();
+
+		/**
+		 * Release worker thread. Thread is stopped, if this was its last user.
+		 * @param thread worker thread previously obtained with acquire().
+		 *
+		 * @note this function is thread-safe.
+		 */
+		void release(QThread * thread);
+
+		/**
+		 * Get connector pool. Connection attempts block until device responds or timeout expires, thus they are performed
+		 * by threads of this pool rather than by workers. Connector threads expire, when they are not used.
+		 * @return connector thread pool.
+		 */
+		QThreadPool * connectorPool();
+
+	private:
+		static constexpr int MAX_CONNECTORS = 64;
+
+		ServiceWorkerPool();
+
+		~ServiceWorkerPool();
+
+		struct Worker
+		{
+			std::unique_ptr<QThread> thread;
+			int load;
+
+			Worker():
+				thread(new QThread),
+				load(0)
+			{
+			}
+		};
+
+		mutable QMutex m_mutex;
+		QVector<Worker *> m_workers;
+		int m_size;
+		QThreadPool m_connectorPool;
+};
+
+}
+}
+}
+
+#endif
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
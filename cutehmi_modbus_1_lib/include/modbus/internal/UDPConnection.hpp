@@ -0,0 +1,147 @@
+#ifndef CUTEHMI_CUTEHMI__MODBUS__1__LIB_INCLUDE_MODBUS_INTERNAL_UDPCONNECTION_HPP
+#define CUTEHMI_CUTEHMI__MODBUS__1__LIB_INCLUDE_MODBUS_INTERNAL_UDPCONNECTION_HPP
+
+#include "common.hpp"
+#include "AbstractConnection.hpp"
+
+#include <QString>
+#include <QByteArray>
+#include <QMutex>
+
+
+namespace cutehmi {
+namespace modbus {
+namespace internal {
+
+/**
+ * UDP connection. Modbus/UDP uses same framing as Modbus/TCP (MBAP header followed by PDU), but each frame is carried by
+ * a single datagram. Since datagrams may be lost, duplicated or reordered, each request is retransmitted if response
+ * does not arrive within response timeout. Responses are matched against transaction identifier of the request, so
+ * that late responses to previous retransmissions and duplicated datagrams are discarded.
+ *
+ * Connection uses plain datagram socket instead of QUdpSocket. Unlike QObject based sockets, plain socket has no thread
+ * affinity and it can be waited on with a timeout from any thread, thus transactions can be issued from service threads,
+ * pooled workers and write queue alike.
+ *
+ * @note transactions are serialized, so object can be used from multiple threads.
+ */
+class CUTEHMI_MODBUS_API UDPConnection:
+	public AbstractConnection
+{
+	public:
+		static constexpr int MAX_READ_REGISTERS = 125;	///< Maximal number of registers read in a single transaction.
+		static constexpr int MAX_READ_BITS = 2000;		///< Maximal number of coils or discrete inputs read in a single transaction.
+
+		/**
+		 * Constructor.
+		 * @param node network node address or host name (e.g. "127.0.0.1").
+		 * @param port UDP port.
+		 * @param unitId unit identifier. Value of "0xff" is recommended as non-significant value.
+		 * @param responseTimeout response timeout [ms]. Request is retransmitted if response does not arrive within this time.
+		 * @param retries number of retransmissions before transaction is considered failed.
+		 */
+		UDPConnection(const QString & node = "127.0.0.1", quint16 port = 502, int unitId = 0xff, int responseTimeout = 1000, int retries = 3);
+
+		~UDPConnection() override;
+
+		const QString & node() const;
+
+		quint16 port() const;
+
+		int unitId() const;
+
+		int responseTimeout() const;
+
+		void setResponseTimeout(int responseTimeout);
+
+		int retries() const;
+
+		void setRetries(int retries);
+
+		bool connect() override;
+
+		void disconnect() override;
+
+		bool connected() const override;
+
+		int readIr(int addr, int num, uint16_t * dest) override;
+
+		int readR(int addr, int num, uint16_t * dest) override;
+
+		int writeR(int addr, uint16_t value) override;
+
+		int readIb(int addr, int num, bool * dest) override;
+
+		int readB(int addr, int num, bool * dest) override;
+
+		int writeB(int addr, bool value) override;
+
+	private:
+		enum function_t : uint8_t {
+			READ_COILS = 0x01,
+			READ_DISCRETE_INPUTS = 0x02,
+			READ_HOLDING_REGISTERS = 0x03,
+			READ_INPUT_REGISTERS = 0x04,
+			WRITE_SINGLE_COIL = 0x05,
+			WRITE_SINGLE_REGISTER = 0x06
+		};
+
+		/**
+		 * Perform transaction.
+		 * @param request request PDU.
+		 * @param response response PDU.
+		 * @return @p 0 on success or one of Error codes in case of failure.
+		 */
+		int transaction(const QByteArray & request, QByteArray & response);
+
+		int readRegisters(function_t function, int addr, int num, uint16_t * dest);
+
+		int readBits(function_t function, int addr, int num, bool * dest);
+
+		int writeSingle(function_t function, int addr, uint16_t value);
+
+		static QByteArray RequestPdu(function_t function, int addr, uint16_t value);
+
+		/**
+		 * Close socket.
+		 *
+		 * @pre mutex must be locked.
+		 */
+		void closeSocket();
+
+		static constexpr qintptr INVALID_SOCKET_DESCRIPTOR = -1;
+
+		struct Members
+		{
+			QString node;
+			quint16 port;
+			int unitId;
+			int responseTimeout;
+			int retries;
+			uint16_t transactionId;
+			qintptr socket;	///< Socket descriptor.
+			mutable QMutex mutex;
+
+			Members(const QString & p_node, quint16 p_port, int p_unitId, int p_responseTimeout, int p_retries):
+				node(p_node),
+				port(p_port),
+				unitId(p_unitId),
+				responseTimeout(p_responseTimeout),
+				retries(p_retries),
+				transactionId(0),
+				socket(INVALID_SOCKET_DESCRIPTOR)
+			{
+			}
+		};
+
+		utils::MPtr<Members> m;
+};
+
+}
+}
+}
+
+#endif
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
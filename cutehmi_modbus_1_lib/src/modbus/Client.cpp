@@ -4,6 +4,8 @@
 
 #include <QtDebug>
 #include <QMutexLocker>
+#include <QWriteLocker>
+#include <QSet>
 #include <QtConcurrent>
 
 namespace cutehmi {
@@ -31,17 +33,41 @@ QString Client::Error::str() const
 	}
 }
 
+bool Client::AddressSet::isEmpty() const
+{
+	return ir.isEmpty() && r.isEmpty() && ib.isEmpty() && b.isEmpty();
+}
+
+void Client::AddressSet::unite(const AddressSet & other)
+{
+	// Set of present addresses is built once per list, so that merging takes linear time.
+	auto uniteList = [](QList<int> & list, const QList<int> & otherList) {
+		if (otherList.isEmpty())
+			return;
+		QSet<int> present = list.toSet();
+		for (int addr : otherList)
+			if (!present.contains(addr)) {
+				present.insert(addr);
+				list.append(addr);
+			}
+	};
+
+	uniteList(ir, other.ir);
+	uniteList(r, other.r);
+	uniteList(ib, other.ib);
+	uniteList(b, other.b);
+}
+
 Client::Client(std::unique_ptr<internal::AbstractConnection> connection, QObject * parent):
 	AbstractDevice(parent),
 	m(new Members(this, std::move(connection)))
 {
-	QObject::connect(m->rValueRequestMapper, SIGNAL(mapped(int)), this, SLOT(rValueRequest(int)));
-	QObject::connect(m->bValueRequestMapper, SIGNAL(mapped(int)), this, SLOT(bValueRequest(int)));
 }
 
 Client::~Client()
 {
 	QThreadPool::globalInstance()->waitForDone();
+	// Facades are children of the client and they do not access data upon destruction, so data can be deleted right away.
 	for (IrDataContainer::KeysContainer::const_iterator it = m->irData.keys().begin(); it != m->irData.keys().end(); ++it)
 		delete m->irData.at(*it);
 	m->irData.clear();
@@ -96,23 +122,157 @@ Coil * Client::bAt(int index)
 	return BAt(& m->b, index);
 }
 
+InputRegister::Data * Client::irDataAt(int index)
+{
+	return DataAt<IrDataContainer>(m->irData, index);
+}
+
+HoldingRegister::Data * Client::rDataAt(int index)
+{
+	return DataAt<RDataContainer>(m->rData, index);
+}
+
+DiscreteInput::Data * Client::ibDataAt(int index)
+{
+	return DataAt<IbDataContainer>(m->ibData, index);
+}
+
+Coil::Data * Client::bDataAt(int index)
+{
+	return DataAt<BDataContainer>(m->bData, index);
+}
+
 bool Client::isConnected() const
 {
 	return m->connection->connected();
 }
 
+void Client::setMaxAge(int maxAge)
+{
+	m->maxAge.storeRelease(maxAge);
+}
+
+int Client::maxAge() const
+{
+	return m->maxAge.loadAcquire();
+}
+
+void Client::setScreenAddresses(const QString & screen, const AddressSet & addresses)
+{
+	QMutexLocker locker(& m->screensMutex);
+	m->declaredScreens.insert(screen, addresses);
+}
+
+Client::AddressSet Client::screenAddresses(const QString & screen) const
+{
+	QMutexLocker locker(& m->screensMutex);
+	AddressSet result = m->declaredScreens.value(screen);
+	result.unite(m->learnedScreens.value(screen));
+	return result;
+}
+
+void Client::learnScreen(const QString & screen)
+{
+	QMutexLocker locker(& m->screensMutex);
+	ScreenStampsContainer::iterator it = m->screenStamps.find(screen);
+	if (it == m->screenStamps.end()) {
+		CUTEHMI_MODBUS_QWARNING("Can not learn addresses of screen '" << screen << "', because prefetch() has not been called for it.");
+		return;
+	}
+	int stamp = *it;
+	m->screenStamps.erase(it);
+
+	AddressSet addresses;
+	addresses.ir = AwakenAddresses<IrDataContainer>(m->irData, stamp);
+	addresses.r = AwakenAddresses<RDataContainer>(m->rData, stamp);
+	addresses.ib = AwakenAddresses<IbDataContainer>(m->ibData, stamp);
+	addresses.b = AwakenAddresses<BDataContainer>(m->bData, stamp);
+	m->learnedScreens.insert(screen, addresses);
+}
+
+void Client::prefetch(const QString & screen)
+{
+	// Facades awaken from now on are the ones bound by the incoming screen.
+	m->screensMutex.lock();
+	m->screenStamps.insert(screen, internal::AwakeStamps::Last());
+	m->screensMutex.unlock();
+
+	AddressSet addresses = screenAddresses(screen);
+	if (!addresses.isEmpty())
+		prefetch(addresses);
+}
+
+void Client::prefetch(const AddressSet & addresses)
+{
+	// Make sure that data exists before service thread attempts to read it. Facades are not needed for that.
+	for (int addr : addresses.ir)
+		DataAt<IrDataContainer>(m->irData, addr);
+	for (int addr : addresses.r)
+		DataAt<RDataContainer>(m->rData, addr);
+	for (int addr : addresses.ib)
+		DataAt<IbDataContainer>(m->ibData, addr);
+	for (int addr : addresses.b)
+		DataAt<BDataContainer>(m->bData, addr);
+
+	m->prefetchMutex.lock();
+	m->prefetchQueue.unite(addresses);
+	m->prefetchMutex.unlock();
+
+	emit prefetchRequested();
+}
+
+void Client::setReadPlan(std::shared_ptr<const internal::ReadPlan> plan)
+{
+	// Data of planned addresses must exist, since plan is read regardless of facades.
+	if (plan)
+		for (int table = 0; table < internal::ReadPlan::TABLES_COUNT; table++)
+			for (const internal::ReadPlan::Span & span : plan->spans(static_cast<internal::ReadPlan::table_t>(table)))
+				for (int addr = span.address; addr < span.address + span.count; addr++)
+					switch (table) {
+						case internal::ReadPlan::INPUT_REGISTERS:
+							DataAt<IrDataContainer>(m->irData, addr);
+							break;
+						case internal::ReadPlan::HOLDING_REGISTERS:
+							DataAt<RDataContainer>(m->rData, addr);
+							break;
+						case internal::ReadPlan::DISCRETE_INPUTS:
+							DataAt<IbDataContainer>(m->ibData, addr);
+							break;
+						case internal::ReadPlan::COILS:
+							DataAt<BDataContainer>(m->bData, addr);
+							break;
+					}
+	m->readPlan = std::move(plan);
+}
+
+std::shared_ptr<const internal::ReadPlan> Client::readPlan() const
+{
+	return m->readPlan;
+}
+
 void Client::readIr(int addr)
 {
 	static const int NUM_READ = 1;
 
-	QMutexLocker locker(& m->irMutex);
+	QWriteLocker locker(& m->irLock);
 	IrDataContainer::iterator it = m->irData.find(addr);
 	Q_ASSERT_X(it != m->irData.end(), __func__, "register has not been referenced yet");
+	int maxAge = m->maxAge.loadAcquire();
+	if ((maxAge > 0) && (*it)->fresh(maxAge))
+		return;
+	if (rejected(internal::ReadPlan::INPUT_REGISTERS, addr))
+		return;
+
 	uint16_t val;
 	CUTEHMI_MODBUS_QDEBUG("Reading value from input register '" << addr << "'.");
-	if (m->connection->readIr(addr, NUM_READ, & val) != NUM_READ)
+	int result = m->connection->readIr(addr, NUM_READ, & val);
+	if (result == internal::AbstractConnection::ERROR_OUT_OF_RANGE) {
+		(*it)->updateQuality(InputRegister::OUT_OF_RANGE);
+		rejectAddress(internal::ReadPlan::INPUT_REGISTERS, addr);
+	} else if (result != NUM_READ) {
+		(*it)->updateQuality(InputRegister::COMM_FAILURE);
 		emit error(base::errorInfo(Error(Error::FAILED_TO_READ_INPUT_REGISTER)));
-	else
+	} else
 		(*it)->updateValue(val);
 }
 
@@ -120,43 +280,75 @@ void Client::readR(int addr)
 {
 	static const int NUM_READ = 1;
 
-	QMutexLocker locker(& m->rMutex);
+	QWriteLocker locker(& m->rLock);
 	RDataContainer::iterator it = m->rData.find(addr);
 	Q_ASSERT_X(it != m->rData.end(), __func__, "register has not been referenced yet");
+	int maxAge = m->maxAge.loadAcquire();
+	if ((maxAge > 0) && (*it)->fresh(maxAge))
+		return;
+	if (rejected(internal::ReadPlan::HOLDING_REGISTERS, addr))
+		return;
+
 	uint16_t val;
 	CUTEHMI_MODBUS_QDEBUG("Reading value from holding register '" << addr << "'.");
-	if (m->connection->readR(addr, NUM_READ, & val) != NUM_READ)
+	int result = m->connection->readR(addr, NUM_READ, & val);
+	if (result == internal::AbstractConnection::ERROR_OUT_OF_RANGE) {
+		(*it)->updateQuality(HoldingRegister::OUT_OF_RANGE);
+		rejectAddress(internal::ReadPlan::HOLDING_REGISTERS, addr);
+	} else if (result != NUM_READ) {
+		(*it)->updateQuality(HoldingRegister::COMM_FAILURE);
 		emit error(base::errorInfo(Error(Error::FAILED_TO_READ_HOLDING_REGISTER)));
-	else
+	} else
 		(*it)->updateValue(val);
 }
 
 void Client::writeR(int addr)
 {
-	QMutexLocker locker(& m->rMutex);
+	QWriteLocker locker(& m->rLock);
 	RDataContainer::iterator it = m->rData.find(addr);
 	Q_ASSERT_X(it != m->rData.end(), __func__, "register has not been referenced yet");
-	uint16_t val = (*it)->requestedValue();
+	uint16_t val = (*it)->loadRequest();
 	CUTEHMI_MODBUS_QDEBUG("Writing requested value '" << val << "' to holding register '" << addr << "'.");
 	if (m->connection->writeR(addr, val) != 1) {
 		emit error(base::errorInfo(Error(Error::FAILED_TO_WRITE_HOLDING_REGISTER)));
-		emit (*it)->valueRejected();
-	} else
-		emit (*it)->valueWritten();
+		(*it)->finishRequest();
+		(*it)->withFacade([](HoldingRegister * reg) {
+			emit reg->valueRejected();
+		});
+	} else {
+		(*it)->finishRequest();
+		(*it)->withFacade([](HoldingRegister * reg) {
+			emit reg->valueWritten();
+		});
+		// In max-age mode store written value directly instead of reading it back from the device.
+		if (m->maxAge.loadAcquire() > 0)
+			(*it)->updateValue(val);
+	}
 }
 
 void Client::readIb(int addr)
 {
 	static const int NUM_READ = 1;
 
-	QMutexLocker locker(& m->ibMutex);
+	QWriteLocker locker(& m->ibLock);
 	IbDataContainer::iterator it = m->ibData.find(addr);
 	Q_ASSERT_X(it != m->ibData.end(), __func__, "discrete input has not been referenced yet");
+	int maxAge = m->maxAge.loadAcquire();
+	if ((maxAge > 0) && (*it)->fresh(maxAge))
+		return;
+	if (rejected(internal::ReadPlan::DISCRETE_INPUTS, addr))
+		return;
+
 	bool val = 0;
 	CUTEHMI_MODBUS_QDEBUG("Reading value from discrete input '" << addr << "'.");
-	if (m->connection->readIb(addr, NUM_READ, & val) != NUM_READ)
+	int result = m->connection->readIb(addr, NUM_READ, & val);
+	if (result == internal::AbstractConnection::ERROR_OUT_OF_RANGE) {
+		(*it)->updateQuality(DiscreteInput::OUT_OF_RANGE);
+		rejectAddress(internal::ReadPlan::DISCRETE_INPUTS, addr);
+	} else if (result != NUM_READ) {
+		(*it)->updateQuality(DiscreteInput::COMM_FAILURE);
 		emit error(base::errorInfo(Error(Error::FAILED_TO_READ_DISCRETE_INPUT)));
-	else
+	} else
 		(*it)->updateValue(val);
 }
 
@@ -164,29 +356,91 @@ void Client::readB(int addr)
 {
 	static const int NUM_READ = 1;
 
-	QMutexLocker locker(& m->bMutex);
+	QWriteLocker locker(& m->bLock);
 	BDataContainer::iterator it = m->bData.find(addr);
 	Q_ASSERT_X(it != m->bData.end(), __func__, "coil has not been referenced yet");
+	int maxAge = m->maxAge.loadAcquire();
+	if ((maxAge > 0) && (*it)->fresh(maxAge))
+		return;
+	if (rejected(internal::ReadPlan::COILS, addr))
+		return;
+
 	bool val = 0;
 	CUTEHMI_MODBUS_QDEBUG("Reading value from coil '" << addr << "'.");
-	if (m->connection->readB(addr, NUM_READ, & val) != NUM_READ)
+	int result = m->connection->readB(addr, NUM_READ, & val);
+	if (result == internal::AbstractConnection::ERROR_OUT_OF_RANGE) {
+		(*it)->updateQuality(Coil::OUT_OF_RANGE);
+		rejectAddress(internal::ReadPlan::COILS, addr);
+	} else if (result != NUM_READ) {
+		(*it)->updateQuality(Coil::COMM_FAILURE);
 		emit error(base::errorInfo(Error(Error::FAILED_TO_READ_COIL)));
-	else
+	} else
 		(*it)->updateValue(val);
 }
 
 void Client::writeB(int addr)
 {
-	QMutexLocker locker(& m->bMutex);
+	QWriteLocker locker(& m->bLock);
 	BDataContainer::iterator it = m->bData.find(addr);
 	Q_ASSERT_X(it != m->bData.end(), __func__, "coil has not been referenced yet");
-	bool val = (*it)->requestedValue();
+	bool val = (*it)->loadRequest();
 	CUTEHMI_MODBUS_QDEBUG("Writing requested value '" << val << "' to coil '" << addr << "'.");
 	if (m->connection->writeB(addr, val) != 1) {
 		emit error(base::errorInfo(Error(Error::FAILED_TO_WRITE_COIL)));
-		emit (*it)->valueRejected();
-	} else
-		emit (*it)->valueWritten();
+		(*it)->finishRequest();
+		(*it)->withFacade([](Coil * coil) {
+			emit coil->valueRejected();
+		});
+	} else {
+		(*it)->finishRequest();
+		(*it)->withFacade([](Coil * coil) {
+			emit coil->valueWritten();
+		});
+		// In max-age mode store written value directly instead of reading it back from the device.
+		if (m->maxAge.loadAcquire() > 0)
+			(*it)->updateValue(val);
+	}
+}
+
+void Client::readIrSpan(int addr, int num)
+{
+	readSpan<IrDataContainer, uint16_t>(m->irData, m->irLock, internal::ReadPlan::INPUT_REGISTERS, & internal::AbstractConnection::readIr, addr, num, Error::FAILED_TO_READ_INPUT_REGISTER);
+}
+
+void Client::readRSpan(int addr, int num)
+{
+	readSpan<RDataContainer, uint16_t>(m->rData, m->rLock, internal::ReadPlan::HOLDING_REGISTERS, & internal::AbstractConnection::readR, addr, num, Error::FAILED_TO_READ_HOLDING_REGISTER);
+}
+
+void Client::readIbSpan(int addr, int num)
+{
+	readSpan<IbDataContainer, bool>(m->ibData, m->ibLock, internal::ReadPlan::DISCRETE_INPUTS, & internal::AbstractConnection::readIb, addr, num, Error::FAILED_TO_READ_DISCRETE_INPUT);
+}
+
+void Client::readBSpan(int addr, int num)
+{
+	readSpan<BDataContainer, bool>(m->bData, m->bLock, internal::ReadPlan::COILS, & internal::AbstractConnection::readB, addr, num, Error::FAILED_TO_READ_COIL);
+}
+
+void Client::rejectAddress(internal::ReadPlan::table_t table, int addr)
+{
+	QMutexLocker locker(& m->rejectedAddressesMutex);
+	if (!m->rejectedAddresses[table].contains(addr)) {
+		CUTEHMI_MODBUS_QDEBUG("Address '" << addr << "' of table '" << table << "' has been rejected by the device.");
+		m->rejectedAddresses[table].insert(addr);
+	}
+}
+
+bool Client::rejected(internal::ReadPlan::table_t table, int addr) const
+{
+	QMutexLocker locker(& m->rejectedAddressesMutex);
+	return m->rejectedAddresses[table].contains(addr);
+}
+
+QSet<int> Client::rejectedAddresses(internal::ReadPlan::table_t table) const
+{
+	QMutexLocker locker(& m->rejectedAddressesMutex);
+	return m->rejectedAddresses[table];
 }
 
 void Client::connect()
@@ -199,6 +453,11 @@ void Client::connect()
 
 	if (status) {
 		CUTEHMI_MODBUS_QDEBUG("Modbus client connected.");
+		// Device may have been reconfigured in the meantime, so rejected addresses are tried again.
+		m->rejectedAddressesMutex.lock();
+		for (int table = 0; table < internal::ReadPlan::TABLES_COUNT; table++)
+			m->rejectedAddresses[table].clear();
+		m->rejectedAddressesMutex.unlock();
 		emit connected();
 	} else
 		emit error(base::errorInfo(Error(Error::UNABLE_TO_CONNECT)));
@@ -211,6 +470,12 @@ void Client::disconnect()
 	m->connection->disconnect();
 	m->connectionMutex.unlock();
 
+	// Values are no longer refreshed.
+	markStale<IrDataContainer>(m->irData);
+	markStale<RDataContainer>(m->rData);
+	markStale<IbDataContainer>(m->ibData);
+	markStale<BDataContainer>(m->bData);
+
 	CUTEHMI_MODBUS_QDEBUG("Modbus client disconnected.");
 
 	emit disconnected();
@@ -218,20 +483,156 @@ void Client::disconnect()
 
 void Client::readAll(const QAtomicInt & run)
 {
-	readRegisters<IrDataContainer>(m->irData, & Client::readIr, run);
-	readRegisters<RDataContainer>(m->rData, & Client::readR, run);
-	readRegisters<IbDataContainer>(m->ibData, & Client::readIb, run);
-	readRegisters<BDataContainer>(m->bData, & Client::readB, run);
+	readPrefetched(run);
+	quint64 scan = m->scanCounter++;
+	SpanRequestsContainer requests;
+	for (int table = 0; table < internal::ReadPlan::TABLES_COUNT; table++)
+		collectSpans(static_cast<internal::ReadPlan::table_t>(table), scan, requests);
+
+	// Spans of all tables are distributed among pooled connections, so that a single large table is read over all of them.
+	QAtomicInt next(0);
+	int workers = qMin(m->connection->concurrency(), requests.count());
+	QList<QFuture<void>> futures;
+	for (int worker = 1; worker < workers; worker++)
+		futures.append(QtConcurrent::run([this, & requests, & next, & run]() {
+			readSpans(requests, next, run);
+		}));
+	readSpans(requests, next, run);
+	for (QFuture<void> & future : futures)
+		future.waitForFinished();
+
+	if (run.load())
+		emit scanned();
 }
 
-void Client::rValueRequest(int index)
+void Client::readPrefetched(const QAtomicInt & run)
 {
-	QtConcurrent::run([](Client * me, int index) {me->writeR(index); me->readR(index);}, this, index);
+	// Whole queue is taken at once, so that mutex is not locked for each address.
+	AddressSet queue;
+	m->prefetchMutex.lock();
+	std::swap(queue, m->prefetchQueue);
+	m->prefetchMutex.unlock();
+
+	if (queue.isEmpty())
+		return;
+
+	readQueued(queue.ir, & Client::readIr, run);
+	readQueued(queue.r, & Client::readR, run);
+	readQueued(queue.ib, & Client::readIb, run);
+	readQueued(queue.b, & Client::readB, run);
+
+	// If reading has been interrupted, remaining addresses are put back in front of the ones queued in the meantime.
+	if (!queue.isEmpty()) {
+		QMutexLocker locker(& m->prefetchMutex);
+		queue.unite(m->prefetchQueue);
+		std::swap(queue, m->prefetchQueue);
+	}
 }
 
-void Client::bValueRequest(int index)
+void Client::collectSpans(internal::ReadPlan::table_t table, quint64 scan, SpanRequestsContainer & requests)
 {
-	QtConcurrent::run([](Client * me, int index) {me->writeB(index); me->readB(index);}, this, index);
+	if (m->readPlan) {
+		QSet<int> rejectedAddrs = rejectedAddresses(table);
+		for (const internal::ReadPlan::Span & span : m->readPlan->spans(table)) {
+			if (scan % static_cast<quint64>(span.poll) != 0)
+				continue;
+			// Span is split around addresses, which have been rejected by the device.
+			int end = span.address + span.count;
+			int first = span.address;
+			for (int addr = first; addr <= end; addr++) {
+				if ((addr < end) && !rejectedAddrs.contains(addr))
+					continue;
+				if (addr > first)
+					requests.append(SpanRequest{table, first, addr - first});
+				first = addr + 1;
+			}
+		}
+	}
+
+	switch (table) {
+		case internal::ReadPlan::INPUT_REGISTERS:
+			collectWakefulSpans<IrDataContainer>(m->irData, m->sortedKeys[table], table, requests);
+			break;
+		case internal::ReadPlan::HOLDING_REGISTERS:
+			collectWakefulSpans<RDataContainer>(m->rData, m->sortedKeys[table], table, requests);
+			break;
+		case internal::ReadPlan::DISCRETE_INPUTS:
+			collectWakefulSpans<IbDataContainer>(m->ibData, m->sortedKeys[table], table, requests);
+			break;
+		case internal::ReadPlan::COILS:
+			collectWakefulSpans<BDataContainer>(m->bData, m->sortedKeys[table], table, requests);
+			break;
+		default:
+			break;
+	}
+}
+
+void Client::readSpans(const SpanRequestsContainer & requests, QAtomicInt & next, const QAtomicInt & run)
+{
+	static void (Client:: * const READ_SPAN_FNS[internal::ReadPlan::TABLES_COUNT])(int, int) = {
+		& Client::readIrSpan,
+		& Client::readRSpan,
+		& Client::readIbSpan,
+		& Client::readBSpan
+	};
+
+	for (int index = next.fetchAndAddOrdered(1); (index < requests.count()) && run.load(); index = next.fetchAndAddOrdered(1)) {
+		const SpanRequest & request = requests.at(index);
+		// Prefetch requests take precedence over regular reads.
+		readPrefetched(run);
+		(this->*READ_SPAN_FNS[request.table])(request.addr, request.num);
+	}
+}
+
+void Client::rValueRequest(int addr)
+{
+	pushWriteRequest(WriteRequest{WriteRequest::HOLDING_REGISTER, addr});
+}
+
+void Client::bValueRequest(int addr)
+{
+	pushWriteRequest(WriteRequest{WriteRequest::COIL, addr});
+}
+
+void Client::readQueued(QList<int> & queue, void (Client:: * readFn)(int), const QAtomicInt & run)
+{
+	while (run.load() && !queue.isEmpty())
+		(this->*readFn)(queue.takeFirst());
+}
+
+void Client::pushWriteRequest(const WriteRequest & request)
+{
+	QMutexLocker locker(& m->writeQueueMutex);
+	m->writeQueue.enqueue(request);
+	if (!m->writeQueueProcessing) {
+		m->writeQueueProcessing = true;
+		QtConcurrent::run(this, & Client::processWriteQueue);
+	}
+}
+
+void Client::processWriteQueue()
+{
+	forever {
+		m->writeQueueMutex.lock();
+		if (m->writeQueue.isEmpty()) {
+			m->writeQueueProcessing = false;
+			m->writeQueueMutex.unlock();
+			return;
+		}
+		WriteRequest request = m->writeQueue.dequeue();
+		m->writeQueueMutex.unlock();
+
+		switch (request.target) {
+			case WriteRequest::HOLDING_REGISTER:
+				writeR(request.addr);
+				readR(request.addr);
+				break;
+			case WriteRequest::COIL:
+				writeB(request.addr);
+				readB(request.addr);
+				break;
+		}
+	}
 }
 
 HoldingRegister * Client::RAt(QQmlListProperty<HoldingRegister> * property, int index)
@@ -244,9 +645,9 @@ HoldingRegister * Client::RAt(QQmlListProperty<HoldingRegister> * property, int
 	//  closure type’s function call operator." -- draft C++11 standard section 5.1.2 [expr.prim.lambda]
 	auto onCreate = [](QQmlListProperty<HoldingRegister> * property, int index, HoldingRegister * reg) {
 		Client * client = static_cast<Client *>(property->object);
-		QSignalMapper * mapper = client->m->rValueRequestMapper;
-		mapper->setMapping(reg, index);
-		QObject::connect(reg, SIGNAL(valueRequested()), mapper, SLOT(map()));
+		QObject::connect(reg, & HoldingRegister::valueRequested, client, [client, index]() {
+			client->rValueRequest(index);
+		});
 	};
 	HoldingRegister * reg = At<HoldingRegister>(property, index, onCreate);
 
@@ -269,9 +670,9 @@ Coil * Client::BAt(QQmlListProperty<Coil> * property, int index)
 	//  closure type’s function call operator." -- draft C++11 standard section 5.1.2 [expr.prim.lambda]
 	auto onCreate = [](QQmlListProperty<Coil> * property, int index, Coil * reg) {
 		Client * client = static_cast<Client *>(property->object);
-		QSignalMapper * mapper = client->m->bValueRequestMapper;
-		mapper->setMapping(reg, index);
-		QObject::connect(reg, SIGNAL(valueRequested()), mapper, SLOT(map()));
+		QObject::connect(reg, & Coil::valueRequested, client, [client, index]() {
+			client->bValueRequest(index);
+		});
 	};
 	Coil * reg = At<Coil>(property, index, onCreate);
 
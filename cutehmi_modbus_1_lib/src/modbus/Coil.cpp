@@ -1,85 +1,90 @@
 #include "../../include/modbus/Coil.hpp"
 
 #include <QtDebug>
-#include <QMutexLocker>
-#include <QReadLocker>
 
 namespace cutehmi {
 namespace modbus {
 
 Coil::Coil(bool value, QObject * parent):
 	QObject(parent),
-	m(new Members(value))
+	m(new Members(std::unique_ptr<Data>(new Data(value))))
+{
+}
+
+Coil::Coil(Data & data, QObject * parent):
+	QObject(parent),
+	m(new Members(& data))
 {
-	connect(this, & Coil::valueWritten, this, & Coil::onValueWritten);
-	connect(this, & Coil::valueRejected, this, & Coil::onValueRejected);
 }
 
 bool Coil::value() const
 {
-	QReadLocker locker(& m->valueLock);
-	return m->value;
+	return m->data->loadValue();
 }
 
 bool Coil::requestedValue() const
 {
-	QMutexLocker locker(& m->reqValueMutex);
-	return m->reqValue;
+	return m->data->loadRequest();
 }
 
 void Coil::rest()
 {
-	m->awaken.fetchAndSubRelaxed(1);
+	if (m->data->awaken.fetchAndSubOrdered(1) == 1)
+		m->data->releaseFacade(this);
 }
 
 void Coil::awake()
 {
-	m->awaken.fetchAndAddRelaxed(1);
+	m->data->awaken.fetchAndAddOrdered(1);
+	m->data->stampAwake();
 }
 
 bool Coil::wakeful() const
 {
-	return m->awaken.load();
+	return m->data->wakeful();
+}
+
+QDateTime Coil::timestamp() const
+{
+	qint64 timestamp = m->data->loadTimestamp();
+	if (timestamp == 0)
+		return QDateTime();
+	return QDateTime::fromMSecsSinceEpoch(timestamp);
+}
+
+Coil::quality_t Coil::quality() const
+{
+	return static_cast<quality_t>(m->data->loadQuality());
+}
+
+bool Coil::fresh(int maxAge) const
+{
+	return m->data->fresh(maxAge);
 }
 
 int Coil::pendingRequests() const
 {
-	QReadLocker locker(& m->writeCtrLock);
-	return m->writeCtr;
+	return m->data->loadWriteCtr();
 }
 
 void Coil::requestValue(bool value)
 {
-	m->writeCtrLock.lockForWrite();
-	m->writeCtr++;
-	m->writeCtrLock.unlock();
-
-	m->reqValueMutex.lock();
-	m->reqValue = value;
-	m->reqValueMutex.unlock();
+	m->data->storeRequest(value);
 	emit valueRequested();
 }
 
 void Coil::updateValue(bool value)
 {
-	m->valueLock.lockForWrite();
-	m->value = value;
-	m->valueLock.unlock();
+	bool changed = m->data->storeValue(value);
 	emit valueUpdated();
+	if (changed)
+		emit qualityChanged();
 }
 
-void Coil::onValueWritten()
-{
-	m->writeCtrLock.lockForWrite();
-	m->writeCtr--;
-	m->writeCtrLock.unlock();
-}
-
-void Coil::onValueRejected()
+void Coil::updateQuality(quality_t quality)
 {
-	m->writeCtrLock.lockForWrite();
-	m->writeCtr--;
-	m->writeCtrLock.unlock();
+	if (m->data->storeQuality(quality))
+		emit qualityChanged();
 }
 
 }
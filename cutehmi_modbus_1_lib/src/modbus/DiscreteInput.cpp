@@ -1,44 +1,74 @@
 #include "../../include/modbus/DiscreteInput.hpp"
 
 #include <QtDebug>
-#include <QReadLocker>
 
 namespace cutehmi {
 namespace modbus {
 
 DiscreteInput::DiscreteInput(bool value, QObject * parent):
 	QObject(parent),
-	m(new Members(value))
+	m(new Members(std::unique_ptr<Data>(new Data(value))))
+{
+}
+
+DiscreteInput::DiscreteInput(Data & data, QObject * parent):
+	QObject(parent),
+	m(new Members(& data))
 {
 }
 
 bool DiscreteInput::value() const
 {
-	QReadLocker locker(& m->valueLock);
-	return m->value;
+	return m->data->loadValue();
 }
 
 void DiscreteInput::rest()
 {
-	m->awaken.fetchAndSubRelaxed(1);
+	if (m->data->awaken.fetchAndSubOrdered(1) == 1)
+		m->data->releaseFacade(this);
 }
 
 void DiscreteInput::awake()
 {
-	m->awaken.fetchAndAddRelaxed(1);
+	m->data->awaken.fetchAndAddOrdered(1);
+	m->data->stampAwake();
 }
 
 bool DiscreteInput::wakeful() const
 {
-	return m->awaken.load();
+	return m->data->wakeful();
+}
+
+QDateTime DiscreteInput::timestamp() const
+{
+	qint64 timestamp = m->data->loadTimestamp();
+	if (timestamp == 0)
+		return QDateTime();
+	return QDateTime::fromMSecsSinceEpoch(timestamp);
+}
+
+DiscreteInput::quality_t DiscreteInput::quality() const
+{
+	return static_cast<quality_t>(m->data->loadQuality());
+}
+
+bool DiscreteInput::fresh(int maxAge) const
+{
+	return m->data->fresh(maxAge);
 }
 
 void DiscreteInput::updateValue(bool value)
 {
-	m->valueLock.lockForWrite();
-	m->value = value;
-	m->valueLock.unlock();
+	bool changed = m->data->storeValue(value);
 	emit valueUpdated();
+	if (changed)
+		emit qualityChanged();
+}
+
+void DiscreteInput::updateQuality(quality_t quality)
+{
+	if (m->data->storeQuality(quality))
+		emit qualityChanged();
 }
 
 }
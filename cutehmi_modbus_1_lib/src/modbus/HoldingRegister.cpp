@@ -3,98 +3,106 @@
 #include "../../include/modbus/Exception.hpp"
 
 #include <QtDebug>
-#include <QMutexLocker>
-#include <QReadLocker>
 
 namespace cutehmi {
 namespace modbus {
 
 HoldingRegister::HoldingRegister(uint16_t value, QObject * parent):
 	QObject(parent),
-	m(new Members(value))
+	m(new Members(std::unique_ptr<Data>(new Data(value))))
 {
-	connect(this, & HoldingRegister::valueWritten, this, & HoldingRegister::onValueWritten);
-	connect(this, & HoldingRegister::valueRejected, this, & HoldingRegister::onValueRejected);
 }
 
-QVariant HoldingRegister::value(encoding_t encoding) const
+HoldingRegister::HoldingRegister(Data & data, QObject * parent):
+	QObject(parent),
+	m(new Members(& data))
+{
+}
+
+QVariant HoldingRegister::Decode(uint16_t value, encoding_t encoding)
 {
-	QReadLocker locker(& m->valueLock);
 	switch (encoding) {
 		case INT16:
-			return internal::intFromUint16(m->value);
+			return internal::intFromUint16(value);
 		default:
 			throw Exception(QObject::tr("Unrecognized encoding code ('%1').").arg(encoding));
 	}
 }
 
+QVariant HoldingRegister::value(encoding_t encoding) const
+{
+	return Decode(m->data->loadValue(), encoding);
+}
+
 uint16_t HoldingRegister::requestedValue() const
 {
-	QMutexLocker locker(& m->reqValueMutex);
-	return m->reqValue;
+	return m->data->loadRequest();
 }
 
 void HoldingRegister::rest()
 {
-	m->awaken.fetchAndSubRelaxed(1);
+	if (m->data->awaken.fetchAndSubOrdered(1) == 1)
+		m->data->releaseFacade(this);
 }
 
 void HoldingRegister::awake()
 {
-	m->awaken.fetchAndAddRelaxed(1);
+	m->data->awaken.fetchAndAddOrdered(1);
+	m->data->stampAwake();
 }
 
 bool HoldingRegister::wakeful() const
 {
-	return m->awaken.load();
+	return m->data->wakeful();
+}
+
+QDateTime HoldingRegister::timestamp() const
+{
+	qint64 timestamp = m->data->loadTimestamp();
+	if (timestamp == 0)
+		return QDateTime();
+	return QDateTime::fromMSecsSinceEpoch(timestamp);
+}
+
+HoldingRegister::quality_t HoldingRegister::quality() const
+{
+	return static_cast<quality_t>(m->data->loadQuality());
+}
+
+bool HoldingRegister::fresh(int maxAge) const
+{
+	return m->data->fresh(maxAge);
 }
 
 int HoldingRegister::pendingRequests() const
 {
-	QReadLocker locker(& m->writeCtrLock);
-	return m->writeCtr;
+	return m->data->loadWriteCtr();
 }
 
 void HoldingRegister::requestValue(QVariant value, encoding_t encoding)
 {
-	m->writeCtrLock.lockForWrite();
-	m->writeCtr++;
-	m->writeCtrLock.unlock();
 	switch (encoding) {
 		case INT16:
-			m->reqValueMutex.lock();
-			m->reqValue = internal::intToUint16(value.toInt());
-			m->reqValueMutex.unlock();
+			m->data->storeRequest(internal::intToUint16(value.toInt()));
 			emit valueRequested();
 			break;
 		default:
-			m->writeCtrLock.lockForWrite();
-			m->writeCtr--;
-			m->writeCtrLock.unlock();
 			throw Exception(QObject::tr("Unrecognized encoding code ('%1').").arg(encoding));
 	}
 }
 
 void HoldingRegister::updateValue(uint16_t value)
 {
-	m->valueLock.lockForWrite();
-	m->value = value;
-	m->valueLock.unlock();
+	bool changed = m->data->storeValue(value);
 	emit valueUpdated();
+	if (changed)
+		emit qualityChanged();
 }
 
-void HoldingRegister::onValueWritten()
-{
-	m->writeCtrLock.lockForWrite();
-	m->writeCtr--;
-	m->writeCtrLock.unlock();
-}
-
-void HoldingRegister::onValueRejected()
+void HoldingRegister::updateQuality(quality_t quality)
 {
-	m->writeCtrLock.lockForWrite();
-	m->writeCtr--;
-	m->writeCtrLock.unlock();
+	if (m->data->storeQuality(quality))
+		emit qualityChanged();
 }
 
 }
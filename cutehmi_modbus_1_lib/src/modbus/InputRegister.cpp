@@ -3,49 +3,84 @@
 #include "../../include/modbus/Exception.hpp"
 
 #include <QtDebug>
-#include <QReadLocker>
 
 namespace cutehmi {
 namespace modbus {
 
 InputRegister::InputRegister(uint16_t value, QObject * parent):
 	QObject(parent),
-	m(new Members(value))
+	m(new Members(std::unique_ptr<Data>(new Data(value))))
 {
 }
 
-QVariant InputRegister::value(encoding_t encoding) const
+InputRegister::InputRegister(Data & data, QObject * parent):
+	QObject(parent),
+	m(new Members(& data))
+{
+}
+
+QVariant InputRegister::Decode(uint16_t value, encoding_t encoding)
 {
-	QReadLocker locker(& m->valueLock);
 	switch (encoding) {
 		case INT16:
-			return internal::intFromUint16(m->value);
+			return internal::intFromUint16(value);
 		default:
 			throw Exception(QObject::tr("Unrecognized encoding code ('%1').").arg(encoding));
 	}
 }
 
+QVariant InputRegister::value(encoding_t encoding) const
+{
+	return Decode(m->data->loadValue(), encoding);
+}
+
 void InputRegister::rest()
 {
-	m->awaken.fetchAndSubRelaxed(1);
+	if (m->data->awaken.fetchAndSubOrdered(1) == 1)
+		m->data->releaseFacade(this);
 }
 
 void InputRegister::awake()
 {
-	m->awaken.fetchAndAddRelaxed(1);
+	m->data->awaken.fetchAndAddOrdered(1);
+	m->data->stampAwake();
 }
 
 bool InputRegister::wakeful() const
 {
-	return m->awaken.load();
+	return m->data->wakeful();
+}
+
+QDateTime InputRegister::timestamp() const
+{
+	qint64 timestamp = m->data->loadTimestamp();
+	if (timestamp == 0)
+		return QDateTime();
+	return QDateTime::fromMSecsSinceEpoch(timestamp);
+}
+
+InputRegister::quality_t InputRegister::quality() const
+{
+	return static_cast<quality_t>(m->data->loadQuality());
+}
+
+bool InputRegister::fresh(int maxAge) const
+{
+	return m->data->fresh(maxAge);
 }
 
 void InputRegister::updateValue(uint16_t value)
 {
-	m->valueLock.lockForWrite();
-	m->value = value;
-	m->valueLock.unlock();
+	bool changed = m->data->storeValue(value);
 	emit valueUpdated();
+	if (changed)
+		emit qualityChanged();
+}
+
+void InputRegister::updateQuality(quality_t quality)
+{
+	if (m->data->storeQuality(quality))
+		emit qualityChanged();
 }
 
 }
@@ -12,9 +12,9 @@
 namespace cutehmi {
 namespace modbus {
 
-Service::Service(const QString & name, Client * client, QObject * parent):
+Service::Service(const QString & name, Client * client, execution_t execution, QObject * parent):
 	services::Service(name, parent),
-	m(new Members(client))
+	m(new Members(client, execution))
 {
 	QObject::connect(m->client, & Client::error, this, & Service::handleError);
 
@@ -29,8 +29,8 @@ Service::Service(const QString & name, Client * client, QObject * parent):
 	QObject::connect(stoppedState, & QState::entered, this, & Service::onStoppedEntered);
 
 	startingState->addTransition(this, SIGNAL(customStopRequested()), stoppingState);
-	startingState->addTransition(m->thread.get(), SIGNAL(ran()), startedState);
-	startingState->addTransition(m->thread.get(), SIGNAL(finished()), brokenWaitState);
+	startingState->addTransition(runner(), SIGNAL(ran()), startedState);
+	startingState->addTransition(runner(), SIGNAL(finished()), brokenWaitState);
 	startingState->addTransition(m->client, SIGNAL(error(cutehmi::base::ErrorInfo)), brokenState);
 	startingState->addTransition(m->client, SIGNAL(disconnected()), brokenState);
 	QObject::connect(startingState, & QState::entered, this, & Service::startServiceThread);
@@ -38,13 +38,13 @@ Service::Service(const QString & name, Client * client, QObject * parent):
 	startedState->addTransition(this, SIGNAL(customStopRequested()), stoppingState);
 	startedState->addTransition(m->client, SIGNAL(error(cutehmi::base::ErrorInfo)), brokenState);
 	startedState->addTransition(m->client, SIGNAL(disconnected()), brokenState);
-	startedState->addTransition(m->thread.get(), SIGNAL(finished()), brokenWaitState);
+	startedState->addTransition(runner(), SIGNAL(finished()), brokenWaitState);
 	QObject::connect(startedState, & QState::entered, this, & Service::onStartedEntered);
 
-	stoppingState->addTransition(m->thread.get(), SIGNAL(finished()), stoppedState);
+	stoppingState->addTransition(runner(), SIGNAL(finished()), stoppedState);
 	QObject::connect(stoppingState, & QState::entered, this, & Service::stopServiceThread);
 
-	brokenState->addTransition(m->thread.get(), SIGNAL(finished()), brokenWaitState);
+	brokenState->addTransition(runner(), SIGNAL(finished()), brokenWaitState);
 	QObject::connect(brokenState, & QState::entered, this, & Service::onBrokenEntered);
 
 	brokenWaitState->addTransition(this, SIGNAL(customStopRequested()), stoppedState);
@@ -71,14 +71,24 @@ Service::~Service()
 	QCoreApplication::eventDispatcher()->processEvents(QEventLoop::AllEvents);
 }
 
+Service::execution_t Service::execution() const
+{
+	return m->task ? POOL : THREAD;
+}
+
 unsigned long Service::sleep() const
 {
+	if (m->task)
+		return m->task->sleep();
 	return m->thread->sleep();
 }
 
 void Service::setSleep(unsigned long sleep)
 {
-	m->thread->setSleep(sleep);
+	if (m->task)
+		m->task->setSleep(sleep);
+	else
+		m->thread->setSleep(sleep);
 }
 
 Service::state_t Service::customStart()
@@ -100,16 +110,27 @@ Service::state_t Service::customStop()
 
 void Service::startServiceThread()
 {
-	CUTEHMI_MODBUS_QDEBUG("Starting modbus service thread...");
-	m->thread->start();
+	if (m->task) {
+		CUTEHMI_MODBUS_QDEBUG("Starting pooled modbus service task...");
+		m->task->start();
+	} else {
+		CUTEHMI_MODBUS_QDEBUG("Starting modbus service thread...");
+		m->thread->start();
+	}
 }
 
 void Service::stopServiceThread()
 {
-	CUTEHMI_MODBUS_QDEBUG("Stopping modbus service thread...");
-	m->thread->stop();
-	m->thread->quit();
-	m->thread->wait();
+	if (m->task) {
+		CUTEHMI_MODBUS_QDEBUG("Stopping pooled modbus service task...");
+		m->task->stop();
+		m->task->wait();
+	} else {
+		CUTEHMI_MODBUS_QDEBUG("Stopping modbus service thread...");
+		m->thread->stop();
+		m->thread->quit();
+		m->thread->wait();
+	}
 }
 
 void Service::onStartedEntered()
@@ -147,6 +168,13 @@ void Service::onBrokenWaitExited()
 	setState(REPAIRING);
 }
 
+QObject * Service::runner() const
+{
+	if (m->task)
+		return m->task.get();
+	return m->thread.get();
+}
+
 void Service::handleError(cutehmi::base::ErrorInfo errorInfo)
 {
 	base::Notification::Critical(errorInfo);
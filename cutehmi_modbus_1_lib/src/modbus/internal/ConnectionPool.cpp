@@ -0,0 +1,200 @@
+#include "../../../include/modbus/internal/ConnectionPool.hpp"
+
+#include <QMutexLocker>
+#include <QtConcurrent>
+#include <QtDebug>
+
+namespace cutehmi {
+namespace modbus {
+namespace internal {
+
+ConnectionPool::ConnectionPool(std::vector<std::unique_ptr<AbstractConnection>> connections, int maxConcurrent):
+	m(new Members(std::move(connections), maxConcurrent))
+{
+	Q_ASSERT_X(!m->connections.empty(), __func__, "pool must contain at least one connection");
+	int count = static_cast<int>(m->connections.size());
+	if ((m->maxConcurrent <= 0) || (m->maxConcurrent > count))
+		m->maxConcurrent = count;
+}
+
+ConnectionPool::~ConnectionPool()
+{
+	disconnect();
+}
+
+int ConnectionPool::count() const
+{
+	return static_cast<int>(m->connections.size());
+}
+
+int ConnectionPool::concurrency() const
+{
+	QMutexLocker locker(& m->mutex);
+	return qMax(1, qMin(m->maxConcurrent, m->connected));
+}
+
+bool ConnectionPool::connect()
+{
+	// Concurrent calls are serialized, but transactions over connections, which are already established, may proceed.
+	QMutexLocker connectLocker(& m->connectMutex);
+
+	m->mutex.lock();
+	QList<AbstractConnection *> pending;
+	std::swap(pending, m->down);
+	m->connecting += pending.count();
+	m->mutex.unlock();
+
+	// Connections are established in parallel and outside of the lock, so that slow sessions do not hold each other.
+	std::vector<char> results(static_cast<std::size_t>(pending.count()), false);
+	QList<QFuture<void>> futures;
+	for (int i = 1; i < pending.count(); i++) {
+		AbstractConnection * connection = pending.at(i);
+		char * result = & results[static_cast<std::size_t>(i)];
+		futures.append(QtConcurrent::run([connection, result]() {
+			*result = connection->connect();
+		}));
+	}
+	if (!pending.isEmpty())
+		results[0] = pending.first()->connect();
+	for (QFuture<void> & future : futures)
+		future.waitForFinished();
+
+	QMutexLocker locker(& m->mutex);
+	for (int i = 0; i < pending.count(); i++)
+		if (results[static_cast<std::size_t>(i)]) {
+			m->idle.append(pending.at(i));
+			m->connected++;
+		} else
+			m->down.append(pending.at(i));
+	m->connecting -= pending.count();
+	if (m->connected < count())
+		CUTEHMI_MODBUS_QDEBUG("Established '" << m->connected << "' out of '" << count() << "' pooled connections.");
+	m->idleCondition.wakeAll();
+	return m->connected > 0;
+}
+
+void ConnectionPool::disconnect()
+{
+	QMutexLocker connectLocker(& m->connectMutex);
+	QMutexLocker locker(& m->mutex);
+	// Wait for pending transactions and reconnections, so that connections are not closed while they are in use.
+	while ((m->busy > 0) || (m->connecting > 0))
+		m->idleCondition.wait(& m->mutex);
+	m->idle.clear();
+	m->down.clear();
+	for (std::unique_ptr<AbstractConnection> & connection : m->connections) {
+		connection->disconnect();
+		m->down.append(connection.get());
+	}
+	m->connected = 0;
+	m->idleCondition.wakeAll();
+}
+
+bool ConnectionPool::connected() const
+{
+	QMutexLocker locker(& m->mutex);
+	return m->connected > 0;
+}
+
+int ConnectionPool::readIr(int addr, int num, uint16_t * dest)
+{
+	return transaction([addr, num, dest](AbstractConnection * connection) {
+		return connection->readIr(addr, num, dest);
+	});
+}
+
+int ConnectionPool::readR(int addr, int num, uint16_t * dest)
+{
+	return transaction([addr, num, dest](AbstractConnection * connection) {
+		return connection->readR(addr, num, dest);
+	});
+}
+
+int ConnectionPool::writeR(int addr, uint16_t value)
+{
+	return transaction([addr, value](AbstractConnection * connection) {
+		return connection->writeR(addr, value);
+	});
+}
+
+int ConnectionPool::readIb(int addr, int num, bool * dest)
+{
+	return transaction([addr, num, dest](AbstractConnection * connection) {
+		return connection->readIb(addr, num, dest);
+	});
+}
+
+int ConnectionPool::readB(int addr, int num, bool * dest)
+{
+	return transaction([addr, num, dest](AbstractConnection * connection) {
+		return connection->readB(addr, num, dest);
+	});
+}
+
+int ConnectionPool::writeB(int addr, bool value)
+{
+	return transaction([addr, value](AbstractConnection * connection) {
+		return connection->writeB(addr, value);
+	});
+}
+
+AbstractConnection * ConnectionPool::acquire()
+{
+	QMutexLocker locker(& m->mutex);
+	while ((m->connected > 0) && (m->idle.isEmpty() || (m->busy >= m->maxConcurrent)))
+		m->idleCondition.wait(& m->mutex);
+	if (m->connected == 0)
+		return nullptr;
+	m->busy++;
+	return m->idle.takeFirst();
+}
+
+void ConnectionPool::release(AbstractConnection * connection, bool failed)
+{
+	QMutexLocker locker(& m->mutex);
+	m->busy--;
+	if (failed) {
+		CUTEHMI_MODBUS_QDEBUG("Evicting failed connection from the pool.");
+		m->connected--;
+		m->connecting++;
+		QtConcurrent::run(this, & ConnectionPool::reconnect, connection);
+	} else
+		m->idle.append(connection);
+	m->idleCondition.wakeAll();
+}
+
+void ConnectionPool::reconnect(AbstractConnection * connection)
+{
+	connection->disconnect();
+	bool status = connection->connect();
+
+	QMutexLocker locker(& m->mutex);
+	m->connecting--;
+	if (status) {
+		m->idle.append(connection);
+		m->connected++;
+	} else {
+		// Connection will be established again with next call to connect().
+		CUTEHMI_MODBUS_QDEBUG("Could not reconnect evicted connection.");
+		m->down.append(connection);
+	}
+	m->idleCondition.wakeAll();
+}
+
+template <typename FN>
+int ConnectionPool::transaction(FN fn)
+{
+	AbstractConnection * connection = acquire();
+	if (connection == nullptr)
+		return ERROR_COMMUNICATION;
+	int result = fn(connection);
+	release(connection, result == ERROR_COMMUNICATION);
+	return result;
+}
+
+}
+}
+}
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
@@ -0,0 +1,477 @@
+#include "../../../include/modbus/internal/DiscoveryScanner.hpp"
+
+#include <QThread>
+#include <QThreadPool>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QXmlStreamWriter>
+#include <QtConcurrent>
+#include <QMultiHash>
+
+#include <vector>
+#include <initializer_list>
+
+namespace cutehmi {
+namespace modbus {
+namespace internal {
+
+constexpr int DiscoveryScanner::ADDR_SPACE_SIZE;
+
+/**
+ * Connection cache. Idle connections are kept per unit, so that consecutive blocks of the same unit reuse connections.
+ * Number of open connections is limited by cache capacity. When limit is reached, idle connection of other unit is
+ * closed to make room for a new one. If there is no idle connection, caller waits until some connection is released.
+ */
+class DiscoveryScanner::ConnectionCache
+{
+	public:
+		ConnectionCache(const ConnectionFactory & factory, int capacity):
+			m_factory(factory),
+			m_capacity(capacity),
+			m_open(0)
+		{
+		}
+
+		~ConnectionCache()
+		{
+			for (AbstractConnection * connection : m_idle) {
+				connection->disconnect();
+				delete connection;
+			}
+		}
+
+		/**
+		 * Acquire connection.
+		 * @param unitId unit identifier.
+		 * @return connection to the unit or @p nullptr if connection could not be opened. Connection must be returned
+		 * with release(). Function blocks, while all the connections are in use.
+		 *
+		 * @threadsafe
+		 */
+		AbstractConnection * acquire(int unitId)
+		{
+			AbstractConnection * evicted = nullptr;
+			m_mutex.lock();
+			AbstractConnection * connection = m_idle.take(unitId);
+			while (connection == nullptr) {
+				if (m_open < m_capacity) {
+					m_open++;
+					break;
+				}
+				if (!m_idle.isEmpty()) {
+					// Evicted connection is replaced by the new one, so number of open connections does not change.
+					evicted = m_idle.begin().value();
+					m_idle.erase(m_idle.begin());
+					break;
+				}
+				m_released.wait(& m_mutex);
+				connection = m_idle.take(unitId);
+			}
+			m_mutex.unlock();
+
+			if (connection != nullptr)
+				return connection;
+
+			// Connections are closed and opened outside of the lock, so that other threads are not held by slow devices.
+			if (evicted != nullptr) {
+				evicted->disconnect();
+				delete evicted;
+			}
+			std::unique_ptr<AbstractConnection> created = m_factory(unitId);
+			if (created && created->connect())
+				return created.release();
+
+			CUTEHMI_MODBUS_QWARNING("Could not open connection to unit '" << unitId << "'.");
+			QMutexLocker locker(& m_mutex);
+			m_open--;
+			m_released.wakeOne();
+			return nullptr;
+		}
+
+		/**
+		 * Release connection.
+		 * @param unitId unit identifier.
+		 * @param connection connection obtained with acquire().
+		 *
+		 * @threadsafe
+		 */
+		void release(int unitId, AbstractConnection * connection)
+		{
+			QMutexLocker locker(& m_mutex);
+			m_idle.insert(unitId, connection);
+			m_released.wakeOne();
+		}
+
+	private:
+		const ConnectionFactory & m_factory;
+		int m_capacity;
+		int m_open;
+		QMutex m_mutex;
+		QWaitCondition m_released;
+		QMultiHash<int, AbstractConnection *> m_idle;
+};
+
+DiscoveryScanner::DiscoveryScanner(ConnectionFactory connectionFactory):
+	m(new Members(connectionFactory))
+{
+}
+
+QList<int> DiscoveryScanner::unitIds() const
+{
+	return m->unitIds;
+}
+
+void DiscoveryScanner::setUnitIds(const QList<int> & unitIds)
+{
+	m->unitIds = unitIds;
+}
+
+int DiscoveryScanner::firstAddress() const
+{
+	return m->firstAddress;
+}
+
+int DiscoveryScanner::addressCount() const
+{
+	return m->addressCount;
+}
+
+void DiscoveryScanner::setAddressRange(int first, int count)
+{
+	m->firstAddress = qBound(0, first, ADDR_SPACE_SIZE);
+	m->addressCount = qBound(0, count, ADDR_SPACE_SIZE - m->firstAddress);
+}
+
+int DiscoveryScanner::blockSize() const
+{
+	return m->blockSize;
+}
+
+void DiscoveryScanner::setBlockSize(int blockSize)
+{
+	m->blockSize = qBound(1, blockSize, 125);
+}
+
+int DiscoveryScanner::minGapSize() const
+{
+	return m->minGapSize;
+}
+
+void DiscoveryScanner::setMinGapSize(int minGapSize)
+{
+	m->minGapSize = qMax(1, minGapSize);
+}
+
+int DiscoveryScanner::maxConnections() const
+{
+	return m->maxConnections;
+}
+
+void DiscoveryScanner::setMaxConnections(int maxConnections)
+{
+	m->maxConnections = qMax(1, maxConnections);
+}
+
+double DiscoveryScanner::maxRate() const
+{
+	return m->maxRate;
+}
+
+void DiscoveryScanner::setMaxRate(double maxRate)
+{
+	m->maxRate = maxRate;
+}
+
+QList<DiscoveryScanner::UnitMap> DiscoveryScanner::scan(const QAtomicInt & run)
+{
+	struct Block
+	{
+		int unit;
+		table_t table;
+		int address;
+		int count;
+		QList<Range> ranges;
+	};
+
+	m->rateTimer.start();
+	m->nextRequestTime = 0;
+
+	ConnectionCache cache(m->connectionFactory, m->maxConnections);
+	QThreadPool pool;
+	pool.setMaxThreadCount(m->maxConnections);
+
+	// Results are written by worker threads, so containers must not be resized or detached while jobs are running.
+	std::vector<char> responded(m->unitIds.count(), false);
+	QList<QFuture<void>> futures;
+	for (int i = 0; i < m->unitIds.count(); i++) {
+		int unitId = m->unitIds.at(i);
+		char * unitResponded = & responded[i];
+		futures.append(QtConcurrent::run(& pool, [this, & cache, unitId, unitResponded, & run]() {
+			*unitResponded = probeUnit(cache, unitId, run);
+		}));
+	}
+	for (QFuture<void> & future : futures)
+		future.waitForFinished();
+	futures.clear();
+
+	// Blocks of all responding units are probed concurrently, so that a single unit is probed over several connections.
+	std::vector<Block> blocks;
+	int end = m->firstAddress + m->addressCount;
+	for (int i = 0; i < m->unitIds.count(); i++) {
+		if (!responded[i])
+			continue;
+		CUTEHMI_MODBUS_QDEBUG("Unit '" << m->unitIds.at(i) << "' has responded, probing its address space...");
+		for (table_t table : {INPUT_REGISTERS, HOLDING_REGISTERS, DISCRETE_INPUTS, COILS})
+			for (int address = m->firstAddress; address < end; address += m->blockSize)
+				blocks.push_back(Block{i, table, address, qMin(m->blockSize, end - address), QList<Range>()});
+	}
+	for (Block & block : blocks) {
+		Block * blockPtr = & block;
+		int unitId = m->unitIds.at(block.unit);
+		futures.append(QtConcurrent::run(& pool, [this, & cache, unitId, blockPtr, & run]() {
+			probeBlock(cache, unitId, blockPtr->table, blockPtr->address, blockPtr->count, blockPtr->ranges, run);
+		}));
+	}
+	for (QFuture<void> & future : futures)
+		future.waitForFinished();
+
+	// Blocks are ordered by unit, table and address, so adjacent ranges of consecutive blocks can be merged.
+	QList<UnitMap> result;
+	std::vector<int> mapIndices(m->unitIds.count(), -1);
+	for (int i = 0; i < m->unitIds.count(); i++)
+		if (responded[i]) {
+			mapIndices[i] = result.count();
+			result.append(UnitMap{m->unitIds.at(i), QList<Range>(), QList<Range>(), QList<Range>(), QList<Range>()});
+		}
+	for (const Block & block : blocks) {
+		UnitMap & map = result[mapIndices[block.unit]];
+		QList<Range> & ranges = TableRanges(map, block.table);
+		for (const Range & range : block.ranges)
+			AppendRange(ranges, range.address, range.count);
+	}
+	return result;
+}
+
+QString DiscoveryScanner::ToXML(const QList<UnitMap> & maps)
+{
+	auto writeRanges = [](QXmlStreamWriter & writer, const QString & name, const QList<Range> & ranges) {
+		for (const Range & range : ranges) {
+			writer.writeEmptyElement(name);
+			writer.writeAttribute("address", QString::number(range.address));
+			writer.writeAttribute("count", QString::number(range.count));
+		}
+	};
+
+	QString result;
+	QXmlStreamWriter writer(& result);
+	writer.setAutoFormatting(true);
+	for (const UnitMap & map : maps) {
+		writer.writeComment(QString(" Unit %1. ").arg(map.unitId));
+		writer.writeStartElement("registers");
+		writeRanges(writer, "ir", map.ir);
+		writeRanges(writer, "r", map.r);
+		writeRanges(writer, "ib", map.ib);
+		writeRanges(writer, "b", map.b);
+		writer.writeEndElement();
+	}
+	return result;
+}
+
+bool DiscoveryScanner::probeUnit(ConnectionCache & cache, int unitId, const QAtomicInt & run)
+{
+	if (!run.load())
+		return false;
+
+	AbstractConnection * connection = cache.acquire(unitId);
+	if (connection == nullptr)
+		return false;
+
+	// Any response (including exception) to any of the requests indicates that unit is alive.
+	bool responded = false;
+	for (table_t table : {INPUT_REGISTERS, HOLDING_REGISTERS, DISCRETE_INPUTS, COILS})
+		if (read(*connection, table, m->firstAddress, 1) != AbstractConnection::ERROR_COMMUNICATION) {
+			responded = true;
+			break;
+		}
+
+	cache.release(unitId, connection);
+	return responded;
+}
+
+void DiscoveryScanner::probeBlock(ConnectionCache & cache, int unitId, table_t table, int address, int count, QList<Range> & ranges, const QAtomicInt & run)
+{
+	if (!run.load())
+		return;
+
+	AbstractConnection * connection = cache.acquire(unitId);
+	if (connection == nullptr)
+		return;
+
+	if (!probe(*connection, table, address, count, ranges, run))
+		CUTEHMI_MODBUS_QWARNING("Communication with unit '" << unitId << "' failed while probing address range [" << address << ", " << address + count << ").");
+
+	cache.release(unitId, connection);
+}
+
+bool DiscoveryScanner::probe(AbstractConnection & connection, table_t table, int address, int count, QList<Range> & ranges, const QAtomicInt & run)
+{
+	if (!run.load() || (count <= 0))
+		return true;
+
+	int result = request(connection, table, address, count);
+	if (result == count) {
+		AppendRange(ranges, address, count);
+		return true;
+	}
+	if (result != AbstractConnection::ERROR_OUT_OF_RANGE)
+		return false;
+	if (count == 1)
+		return true;
+
+	// Range contains illegal address. Boundaries of its readable prefix and suffix are located by binary search.
+	int end = address + count;
+	int prefix;
+	if (!findPrefix(connection, table, address, count, prefix))
+		return false;
+	if (prefix > 0)
+		AppendRange(ranges, address, prefix);
+
+	// Address following the prefix is illegal.
+	int gap = address + prefix + 1;
+	if (gap >= end)
+		return true;
+	int suffix;
+	if (!findSuffix(connection, table, gap, end, suffix))
+		return false;
+
+	// Address preceding the suffix is illegal, unless suffix immediately follows illegal address after the prefix. Part in
+	// between may still contain readable addresses, so it is bisected. Any readable range, which is not shorter than the
+	// minimal gap size, is eventually found as a prefix or a suffix of some part.
+	int gapCount = suffix > gap ? suffix - 1 - gap : 0;
+	if (gapCount >= m->minGapSize) {
+		int half = gapCount / 2;
+		if (!probe(connection, table, gap, half, ranges, run))
+			return false;
+		if (!probe(connection, table, gap + half, gapCount - half, ranges, run))
+			return false;
+	}
+
+	if (suffix < end)
+		AppendRange(ranges, suffix, end - suffix);
+	return true;
+}
+
+bool DiscoveryScanner::findPrefix(AbstractConnection & connection, table_t table, int address, int count, int & length)
+{
+	// Invariant: first 'readable' addresses can be read and first 'unreadable' addresses can not.
+	int readable = 0;
+	int unreadable = count;
+	while (unreadable - readable > 1) {
+		// First address is checked at first, because it is common that whole range is illegal.
+		int mid = readable == 0 ? 1 : readable + (unreadable - readable) / 2;
+		int result = request(connection, table, address, mid);
+		if (result == mid)
+			readable = mid;
+		else if (result == AbstractConnection::ERROR_OUT_OF_RANGE)
+			unreadable = mid;
+		else
+			return false;
+	}
+	length = readable;
+	return true;
+}
+
+bool DiscoveryScanner::findSuffix(AbstractConnection & connection, table_t table, int address, int end, int & first)
+{
+	// Invariant: addresses starting from 'readable' can be read and addresses starting from 'unreadable' can not.
+	int unreadable = address - 1;
+	int readable = end;
+	while (readable - unreadable > 1) {
+		// Last address is checked at first, because it is common that whole range is illegal.
+		int mid = readable == end ? end - 1 : unreadable + (readable - unreadable) / 2;
+		int result = request(connection, table, mid, end - mid);
+		if (result == end - mid)
+			readable = mid;
+		else if (result == AbstractConnection::ERROR_OUT_OF_RANGE)
+			unreadable = mid;
+		else
+			return false;
+	}
+	first = readable;
+	return true;
+}
+
+int DiscoveryScanner::request(AbstractConnection & connection, table_t table, int address, int count)
+{
+	static const int MAX_ATTEMPTS = 2;
+
+	int result = AbstractConnection::ERROR_COMMUNICATION;
+	for (int attempt = 0; (attempt < MAX_ATTEMPTS) && (result == AbstractConnection::ERROR_COMMUNICATION); attempt++)
+		result = read(connection, table, address, count);
+	return result;
+}
+
+int DiscoveryScanner::read(AbstractConnection & connection, table_t table, int address, int count)
+{
+	uint16_t registers[125];
+	bool bits[125];
+
+	throttle();
+	switch (table) {
+		case INPUT_REGISTERS:
+			return connection.readIr(address, count, registers);
+		case HOLDING_REGISTERS:
+			return connection.readR(address, count, registers);
+		case DISCRETE_INPUTS:
+			return connection.readIb(address, count, bits);
+		case COILS:
+			return connection.readB(address, count, bits);
+		default:
+			return AbstractConnection::ERROR_COMMUNICATION;
+	}
+}
+
+void DiscoveryScanner::throttle()
+{
+	if (m->maxRate <= 0.0)
+		return;
+
+	qint64 interval = static_cast<qint64>(1000000000.0 / m->maxRate);
+	m->rateMutex.lock();
+	qint64 now = m->rateTimer.nsecsElapsed();
+	qint64 slot = qMax(now, m->nextRequestTime);
+	m->nextRequestTime = slot + interval;
+	m->rateMutex.unlock();
+
+	if (slot > now)
+		QThread::usleep(static_cast<unsigned long>((slot - now) / 1000));
+}
+
+QList<DiscoveryScanner::Range> & DiscoveryScanner::TableRanges(UnitMap & map, table_t table)
+{
+	switch (table) {
+		case INPUT_REGISTERS:
+			return map.ir;
+		case HOLDING_REGISTERS:
+			return map.r;
+		case DISCRETE_INPUTS:
+			return map.ib;
+		default:
+			return map.b;
+	}
+}
+
+void DiscoveryScanner::AppendRange(QList<Range> & ranges, int address, int count)
+{
+	if (!ranges.isEmpty() && (ranges.last().address + ranges.last().count == address))
+		ranges.last().count += count;
+	else
+		ranges.append(Range{address, count});
+}
+
+}
+}
+}
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
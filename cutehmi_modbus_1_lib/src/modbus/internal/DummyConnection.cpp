@@ -70,6 +70,8 @@ int DummyConnection::readIr(int addr, int num, uint16_t * dest)
 		return -1;
 	}
 	QThread::msleep(latency());
+	if ((addr < 0) || (num < 0) || (addr + num > ADDR_SPACE_SIZE))
+		return ERROR_OUT_OF_RANGE;
 	std::copy_n(m->irArr + addr, num, dest);
 	return num;
 }
@@ -81,6 +83,8 @@ int DummyConnection::readR(int addr, int num, uint16_t * dest)
 		return -1;
 	}
 	QThread::msleep(latency());
+	if ((addr < 0) || (num < 0) || (addr + num > ADDR_SPACE_SIZE))
+		return ERROR_OUT_OF_RANGE;
 	std::copy_n(m->rArr + addr, num, dest);
 	return num;
 }
@@ -103,6 +107,8 @@ int DummyConnection::readIb(int addr, int num, bool * dest)
 		return -1;
 	}
 	QThread::msleep(latency());
+	if ((addr < 0) || (num < 0) || (addr + num > ADDR_SPACE_SIZE))
+		return ERROR_OUT_OF_RANGE;
 	std::copy_n(m->ibArr + addr, num, dest);
 	return num;
 }
@@ -114,6 +120,8 @@ int DummyConnection::readB(int addr, int num, bool * dest)
 		return -1;
 	}
 	QThread::msleep(latency());
+	if ((addr < 0) || (num < 0) || (addr + num > ADDR_SPACE_SIZE))
+		return ERROR_OUT_OF_RANGE;
 	std::copy_n(m->bArr + addr, num, dest);
 	return num;
 }
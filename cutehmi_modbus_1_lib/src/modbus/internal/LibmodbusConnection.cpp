@@ -56,27 +56,31 @@ bool LibmodbusConnection::connected() const
 
 int LibmodbusConnection::readIr(int addr, int num, uint16_t * dest)
 {
-	QMutexLocker locker(& LibmodbusConnection::Mutex());
+	QMutexLocker locker(& m->mutex);
 	// libmodbus seems to take care about endianness.
 	int result = modbus_read_input_registers(context(), addr, num, dest);
-	if (result == -1)
+	if (result == -1) {
 		CUTEHMI_MODBUS_QDEBUG("libmodbus error: " << modbus_strerror(errno) << ".");
+		result = ErrorFromErrno(errno);
+	}
 	return result;
 }
 
 int LibmodbusConnection::readR(int addr, int num, uint16_t * dest)
 {
-	QMutexLocker locker(& LibmodbusConnection::Mutex());
+	QMutexLocker locker(& m->mutex);
 	// libmodbus seems to take care about endianness.
 	int result = modbus_read_registers(context(), addr, num, dest);
-	if (result == -1)
+	if (result == -1) {
 		CUTEHMI_MODBUS_QDEBUG("libmodbus error: " << modbus_strerror(errno) << ".");
+		result = ErrorFromErrno(errno);
+	}
 	return result;
 }
 
 int LibmodbusConnection::writeR(int addr, uint16_t value)
 {
-	QMutexLocker locker(& LibmodbusConnection::Mutex());
+	QMutexLocker locker(& m->mutex);
 	// libmodbus seems to take care about endianness.
 	// For some reason libmodbus uses int as a value parameter, so we need to convert it back.
 	int result = modbus_write_register(context(), addr, intFromUint16(value));
@@ -87,11 +91,13 @@ int LibmodbusConnection::writeR(int addr, uint16_t value)
 
 int LibmodbusConnection::readIb(int addr, int num, bool * dest)
 {
-	QMutexLocker locker(& LibmodbusConnection::Mutex());
+	QMutexLocker locker(& m->mutex);
 	m->bIbBuffer.reserve(num);
 	int result = modbus_read_input_bits(context(), addr, num, & m->bIbBuffer[0]);
-	if (result == -1)
+	if (result == -1) {
 		CUTEHMI_MODBUS_QDEBUG("libmodbus error: " << modbus_strerror(errno) << ".");
+		result = ErrorFromErrno(errno);
+	}
 	for (int i = 0; i < result; i++)
 		dest[i] = m->bIbBuffer[i];
 	return result;
@@ -99,11 +105,13 @@ int LibmodbusConnection::readIb(int addr, int num, bool * dest)
 
 int LibmodbusConnection::readB(int addr, int num, bool * dest)
 {
-	QMutexLocker locker(& LibmodbusConnection::Mutex());
+	QMutexLocker locker(& m->mutex);
 	m->bIbBuffer.reserve(num);
 	int result = modbus_read_bits(context(), addr, num, & m->bIbBuffer[0]);
-	if (result == -1)
+	if (result == -1) {
 		CUTEHMI_MODBUS_QDEBUG("libmodbus error: " << modbus_strerror(errno) << ".");
+		result = ErrorFromErrno(errno);
+	}
 	for (int i = 0; i < result; i++)
 		dest[i] = m->bIbBuffer[i];
 	return result;
@@ -111,7 +119,7 @@ int LibmodbusConnection::readB(int addr, int num, bool * dest)
 
 int LibmodbusConnection::writeB(int addr, bool value)
 {
-	QMutexLocker locker(& LibmodbusConnection::Mutex());
+	QMutexLocker locker(& m->mutex);
 	// "If the source type is bool, the value false is converted to zero and the value true is converted to one."
 	//		-- §4.7/4 C++ Standard via StackOverflow.
 	int result = modbus_write_bit(context(), addr, value);
@@ -140,10 +148,11 @@ void LibmodbusConnection::setContext(modbus_t * context)
 	m->context = context;
 }
 
-QMutex & LibmodbusConnection::Mutex()
+int LibmodbusConnection::ErrorFromErrno(int errnum)
 {
-	static QMutex mutex;
-	return mutex;
+	if ((errnum == EMBXILADD) || (errnum == EMBXILVAL))
+		return ERROR_OUT_OF_RANGE;
+	return ERROR_COMMUNICATION;
 }
 
 }
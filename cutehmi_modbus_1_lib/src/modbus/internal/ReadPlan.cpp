@@ -0,0 +1,83 @@
+#include "../../../include/modbus/internal/ReadPlan.hpp"
+
+#include <vector>
+
+namespace cutehmi {
+namespace modbus {
+namespace internal {
+
+constexpr int ReadPlan::ADDR_SPACE_SIZE;
+constexpr int ReadPlan::MAX_REGISTERS_SPAN;
+constexpr int ReadPlan::MAX_BITS_SPAN;
+
+int ReadPlan::MaxSpan(table_t table)
+{
+	return ((table == DISCRETE_INPUTS) || (table == COILS)) ? MAX_BITS_SPAN : MAX_REGISTERS_SPAN;
+}
+
+ReadPlan::ReadPlan(const QList<Entry> & entries):
+	m(new Members)
+{
+	for (int table = 0; table < TABLES_COUNT; table++) {
+		// Poll class of each address (0 stands for address, which is not declared).
+		std::vector<int> polls(ADDR_SPACE_SIZE, 0);
+		bool declared = false;
+		for (const Entry & entry : entries) {
+			if (entry.table != table)
+				continue;
+			int poll = qMax(1, entry.poll);
+			int first = qBound(0, entry.address, ADDR_SPACE_SIZE);
+			int end = qBound(first, entry.address + entry.count, ADDR_SPACE_SIZE);
+			for (int addr = first; addr < end; addr++)
+				if ((polls[addr] == 0) || (poll < polls[addr]))
+					polls[addr] = poll;
+			declared = declared || (end > first);
+		}
+		if (!declared)
+			continue;
+
+		QBitArray & coverage = m->coverage[table];
+		QVector<Span> & spans = m->spans[table];
+		coverage.resize(ADDR_SPACE_SIZE);
+		int maxSpan = MaxSpan(static_cast<table_t>(table));
+		for (int addr = 0; addr < ADDR_SPACE_SIZE; addr++) {
+			if (polls[addr] == 0)
+				continue;
+			coverage.setBit(addr);
+			if (!spans.isEmpty()) {
+				Span & last = spans.last();
+				if ((last.address + last.count == addr) && (last.poll == polls[addr]) && (last.count < maxSpan)) {
+					last.count++;
+					continue;
+				}
+			}
+			spans.append(Span{addr, 1, polls[addr]});
+		}
+	}
+}
+
+bool ReadPlan::isEmpty() const
+{
+	for (int table = 0; table < TABLES_COUNT; table++)
+		if (!m->spans[table].isEmpty())
+			return false;
+	return true;
+}
+
+const QVector<ReadPlan::Span> & ReadPlan::spans(table_t table) const
+{
+	return m->spans[table];
+}
+
+bool ReadPlan::covers(table_t table, int address) const
+{
+	const QBitArray & coverage = m->coverage[table];
+	return (address >= 0) && (address < coverage.size()) && coverage.testBit(address);
+}
+
+}
+}
+}
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
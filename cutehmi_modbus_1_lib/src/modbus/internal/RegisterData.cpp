@@ -0,0 +1,32 @@
+#include "../../../include/modbus/internal/RegisterData.hpp"
+
+namespace cutehmi {
+namespace modbus {
+namespace internal {
+
+namespace {
+
+QAtomicInt & AwakeCounter()
+{
+	static QAtomicInt counter(0);
+	return counter;
+}
+
+}
+
+int AwakeStamps::Next()
+{
+	return AwakeCounter().fetchAndAddOrdered(1) + 1;
+}
+
+int AwakeStamps::Last()
+{
+	return AwakeCounter().loadAcquire();
+}
+
+}
+}
+}
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
@@ -0,0 +1,143 @@
+#include "../../../include/modbus/internal/ServiceTask.hpp"
+#include "../../../include/modbus/internal/ServiceWorkerPool.hpp"
+#include "../../../include/modbus/Client.hpp"
+
+#include <QTimer>
+#include <QMutexLocker>
+#include <QtConcurrent>
+
+#include <limits>
+#include <algorithm>
+
+namespace cutehmi {
+namespace modbus {
+namespace internal {
+
+ServiceTask::ServiceTask(Client * client):
+	m_run(0),
+	m_connected(0),
+	m_active(false),
+	m_sleep(0),
+	m_thread(nullptr),
+	m_timer(nullptr),
+	m_client(client)
+{
+	connect(m_client, & Client::prefetchRequested, this, & ServiceTask::wake, Qt::DirectConnection);
+}
+
+ServiceTask::~ServiceTask()
+{
+	stop();
+	releaseThread();
+}
+
+unsigned long ServiceTask::sleep() const
+{
+	return m_sleep;
+}
+
+void ServiceTask::setSleep(unsigned long sleep)
+{
+	m_sleep = sleep;
+}
+
+void ServiceTask::wait()
+{
+	releaseThread();
+}
+
+void ServiceTask::start()
+{
+	// Release thread of a previous run, if task has finished on its own.
+	releaseThread();
+
+	QMutexLocker locker(& m_mutex);
+	m_run.storeRelease(1);
+	m_connected.storeRelease(0);
+	m_active = true;
+	m_thread = ServiceWorkerPool::Instance().acquire();
+	m_timer = new QTimer;
+	m_timer->setSingleShot(true);
+	m_timer->moveToThread(m_thread);
+	connect(m_timer, & QTimer::timeout, this, & ServiceTask::cycle, Qt::DirectConnection);
+	// Connecting blocks until device responds or timeout expires, so it must not occupy worker shared with other tasks.
+	QtConcurrent::run(ServiceWorkerPool::Instance().connectorPool(), this, & ServiceTask::connectClient);
+}
+
+void ServiceTask::stop()
+{
+	m_run.storeRelease(0);
+	wake();
+}
+
+void ServiceTask::wake()
+{
+	QMutexLocker locker(& m_mutex);
+	if (m_timer != nullptr)
+		QMetaObject::invokeMethod(m_timer, "start", Qt::QueuedConnection, Q_ARG(int, 0));
+}
+
+void ServiceTask::connectClient()
+{
+	m_client->connect();
+	if (!m_client->isConnected()) {
+		finish();	// Do not enter the loop and don't trigger additional errors unnecessarily.
+		return;
+	}
+	m_connected.storeRelease(1);
+	emit ran();
+	// Task enters worker only once it is connected.
+	wake();
+}
+
+void ServiceTask::cycle()
+{
+	// Task may be woken up by prefetch request or stop() while it is still connecting.
+	if (!m_connected.loadAcquire())
+		return;
+
+	if (m_run.loadAcquire()) {
+		m_client->readAll(m_run);
+		if (m_run.loadAcquire()) {
+			// Worker serves other tasks while this one sleeps.
+			m_timer->start(static_cast<int>(std::min(m_sleep, static_cast<unsigned long>(std::numeric_limits<int>::max()))));
+			return;
+		}
+	}
+	m_client->disconnect();
+	finish();
+}
+
+void ServiceTask::finish()
+{
+	m_mutex.lock();
+	// Timer may have pending start requests, so disconnect it before it gets deleted by the worker event loop.
+	QObject::disconnect(m_timer, nullptr, this, nullptr);
+	m_timer->deleteLater();
+	m_timer = nullptr;
+	m_active = false;
+	m_finishedCondition.wakeAll();
+	m_mutex.unlock();
+
+	emit finished();
+}
+
+void ServiceTask::releaseThread()
+{
+	m_mutex.lock();
+	while (m_active)
+		m_finishedCondition.wait(& m_mutex);
+	QThread * thread = m_thread;
+	m_thread = nullptr;
+	m_mutex.unlock();
+
+	if (thread != nullptr)
+		ServiceWorkerPool::Instance().release(thread);
+}
+
+}
+}
+}
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
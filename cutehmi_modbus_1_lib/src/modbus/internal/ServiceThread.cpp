@@ -7,9 +7,11 @@ namespace internal {
 
 ServiceThread::ServiceThread(Client * client):
 	m_run(0),
+	m_wakeRequested(0),
 	m_sleep(0),
 	m_client(client)
 {
+	connect(m_client, & Client::prefetchRequested, this, & ServiceThread::wake, Qt::DirectConnection);
 }
 
 unsigned long ServiceThread::sleep() const
@@ -32,7 +34,11 @@ void ServiceThread::run()
 
 	while (m_run.loadAcquire()) {
 		m_client->readAll(m_run);
-		msleep(m_sleep);
+		m_sleepMutex.lock();
+		if (!m_wakeRequested.fetchAndStoreAcquire(0))
+			m_sleepCondition.wait(& m_sleepMutex, m_sleep);
+		m_wakeRequested.storeRelease(0);
+		m_sleepMutex.unlock();
 	}
 	m_client->disconnect();
 }
@@ -46,6 +52,15 @@ void ServiceThread::start()
 void ServiceThread::stop()
 {
 	m_run.storeRelease(0);
+	wake();
+}
+
+void ServiceThread::wake()
+{
+	m_sleepMutex.lock();
+	m_wakeRequested.storeRelease(1);
+	m_sleepCondition.wakeAll();
+	m_sleepMutex.unlock();
 }
 
 }
@@ -0,0 +1,92 @@
+#include "../../../include/modbus/internal/ServiceWorkerPool.hpp"
+
+#include <QMutexLocker>
+
+namespace cutehmi {
+namespace modbus {
+namespace internal {
+
+ServiceWorkerPool & ServiceWorkerPool::Instance()
+{
+	static ServiceWorkerPool instance;
+	return instance;
+}
+
+int ServiceWorkerPool::size() const
+{
+	QMutexLocker locker(& m_mutex);
+	return m_size;
+}
+
+void ServiceWorkerPool::setSize(int size)
+{
+	Q_ASSERT_X(size > 0, __func__, "pool must have at least one worker");
+
+	QMutexLocker locker(& m_mutex);
+	m_size = size;
+}
+
+QThread * ServiceWorkerPool::acquire()
+{
+	QMutexLocker locker(& m_mutex);
+
+	Worker * worker = nullptr;
+	if (m_workers.count() < m_size) {
+		worker = new Worker;
+		worker->thread->setObjectName(QString("cutehmi::modbus::ServiceWorker#%1").arg(m_workers.count()));
+		m_workers.append(worker);
+	} else
+		for (Worker * candidate : m_workers)
+			if ((worker == nullptr) || (candidate->load < worker->load))
+				worker = candidate;
+
+	if (worker->load++ == 0)
+		worker->thread->start();
+	return worker->thread.get();
+}
+
+void ServiceWorkerPool::release(QThread * thread)
+{
+	QMutexLocker locker(& m_mutex);
+
+	for (Worker * worker : m_workers)
+		if (worker->thread.get() == thread) {
+			if (--worker->load == 0) {
+				worker->thread->quit();
+				worker->thread->wait();
+			}
+			return;
+		}
+	Q_ASSERT_X(false, __func__, "thread does not belong to the pool");
+}
+
+QThreadPool * ServiceWorkerPool::connectorPool()
+{
+	return & m_connectorPool;
+}
+
+ServiceWorkerPool::ServiceWorkerPool():
+	m_size(qMax(QThread::idealThreadCount(), 1))
+{
+	// Connector threads spend most of the time waiting for devices, so there can be more of them than CPU cores.
+	m_connectorPool.setMaxThreadCount(MAX_CONNECTORS);
+}
+
+ServiceWorkerPool::~ServiceWorkerPool()
+{
+	m_connectorPool.waitForDone();
+	for (Worker * worker : m_workers) {
+		worker->thread->quit();
+		worker->thread->wait();
+		delete worker;
+	}
+}
+
+constexpr int ServiceWorkerPool::MAX_CONNECTORS;
+
+}
+}
+}
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
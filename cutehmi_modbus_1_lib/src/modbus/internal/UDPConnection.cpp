@@ -0,0 +1,391 @@
+#include "../../../include/modbus/internal/UDPConnection.hpp"
+
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+#ifdef Q_OS_WIN
+	#include <winsock2.h>
+	#include <ws2tcpip.h>
+#else
+	#include <sys/types.h>
+	#include <sys/socket.h>
+	#include <netdb.h>
+	#include <poll.h>
+	#include <unistd.h>
+	#include <cerrno>
+#endif
+
+#include <cstring>
+
+namespace cutehmi {
+namespace modbus {
+namespace internal {
+
+namespace {
+
+#ifdef Q_OS_WIN
+typedef SOCKET socket_t;
+
+const socket_t INVALID_SOCKET_VALUE = INVALID_SOCKET;
+
+void CloseSocket(socket_t socket)
+{
+	::closesocket(socket);
+}
+
+int PollSocket(socket_t socket, int timeout)
+{
+	WSAPOLLFD fd;
+	fd.fd = socket;
+	fd.events = POLLRDNORM;
+	fd.revents = 0;
+	return ::WSAPoll(& fd, 1, timeout);
+}
+
+bool Interrupted()
+{
+	return ::WSAGetLastError() == WSAEINTR;
+}
+
+QString SocketErrorString()
+{
+	return QString("WSA error %1").arg(::WSAGetLastError());
+}
+#else
+typedef int socket_t;
+
+const socket_t INVALID_SOCKET_VALUE = -1;
+
+void CloseSocket(socket_t socket)
+{
+	::close(socket);
+}
+
+int PollSocket(socket_t socket, int timeout)
+{
+	pollfd fd;
+	fd.fd = socket;
+	fd.events = POLLIN;
+	fd.revents = 0;
+	return ::poll(& fd, 1, timeout);
+}
+
+bool Interrupted()
+{
+	return errno == EINTR;
+}
+
+QString SocketErrorString()
+{
+	return QString::fromLocal8Bit(std::strerror(errno));
+}
+#endif
+
+}
+
+constexpr int UDPConnection::MAX_READ_REGISTERS;
+constexpr int UDPConnection::MAX_READ_BITS;
+constexpr qintptr UDPConnection::INVALID_SOCKET_DESCRIPTOR;
+
+UDPConnection::UDPConnection(const QString & node, quint16 port, int unitId, int responseTimeout, int retries):
+	m(new Members(node, port, unitId, responseTimeout, retries))
+{
+}
+
+UDPConnection::~UDPConnection()
+{
+	disconnect();
+}
+
+const QString & UDPConnection::node() const
+{
+	return m->node;
+}
+
+quint16 UDPConnection::port() const
+{
+	return m->port;
+}
+
+int UDPConnection::unitId() const
+{
+	return m->unitId;
+}
+
+int UDPConnection::responseTimeout() const
+{
+	return m->responseTimeout;
+}
+
+void UDPConnection::setResponseTimeout(int responseTimeout)
+{
+	m->responseTimeout = responseTimeout;
+}
+
+int UDPConnection::retries() const
+{
+	return m->retries;
+}
+
+void UDPConnection::setRetries(int retries)
+{
+	m->retries = retries;
+}
+
+bool UDPConnection::connect()
+{
+	QMutexLocker locker(& m->mutex);
+	closeSocket();
+
+#ifdef Q_OS_WIN
+	// Each successful WSAStartup() call is paired with WSACleanup() in closeSocket().
+	WSADATA wsaData;
+	if (::WSAStartup(MAKEWORD(2, 2), & wsaData) != 0) {
+		CUTEHMI_MODBUS_QWARNING("Could not initialize Winsock.");
+		return false;
+	}
+#endif
+
+	// There is no handshake in UDP. Connecting socket only resolves host name and sets default peer.
+	addrinfo hints;
+	std::memset(& hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_DGRAM;
+	hints.ai_protocol = IPPROTO_UDP;
+	addrinfo * addresses = nullptr;
+	int status = ::getaddrinfo(m->node.toLocal8Bit().constData(), QByteArray::number(m->port).constData(), & hints, & addresses);
+	if (status != 0) {
+		CUTEHMI_MODBUS_QWARNING("Could not resolve UDP node '" << m->node << ":" << m->port << "' (" << ::gai_strerror(status) << ").");
+#ifdef Q_OS_WIN
+		::WSACleanup();
+#endif
+		return false;
+	}
+
+	socket_t socket = INVALID_SOCKET_VALUE;
+	for (addrinfo * address = addresses; address != nullptr; address = address->ai_next) {
+		socket = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+		if (socket == INVALID_SOCKET_VALUE)
+			continue;
+		if (::connect(socket, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0)
+			break;
+		CloseSocket(socket);
+		socket = INVALID_SOCKET_VALUE;
+	}
+	::freeaddrinfo(addresses);
+
+	if (socket == INVALID_SOCKET_VALUE) {
+		CUTEHMI_MODBUS_QWARNING("Could not set up UDP socket for '" << m->node << ":" << m->port << "' (" << SocketErrorString() << ").");
+#ifdef Q_OS_WIN
+		::WSACleanup();
+#endif
+		return false;
+	}
+	m->socket = static_cast<qintptr>(socket);
+	return true;
+}
+
+void UDPConnection::disconnect()
+{
+	QMutexLocker locker(& m->mutex);
+	closeSocket();
+}
+
+bool UDPConnection::connected() const
+{
+	QMutexLocker locker(& m->mutex);
+	return m->socket != INVALID_SOCKET_DESCRIPTOR;
+}
+
+int UDPConnection::readIr(int addr, int num, uint16_t * dest)
+{
+	return readRegisters(READ_INPUT_REGISTERS, addr, num, dest);
+}
+
+int UDPConnection::readR(int addr, int num, uint16_t * dest)
+{
+	return readRegisters(READ_HOLDING_REGISTERS, addr, num, dest);
+}
+
+int UDPConnection::writeR(int addr, uint16_t value)
+{
+	return writeSingle(WRITE_SINGLE_REGISTER, addr, value);
+}
+
+int UDPConnection::readIb(int addr, int num, bool * dest)
+{
+	return readBits(READ_DISCRETE_INPUTS, addr, num, dest);
+}
+
+int UDPConnection::readB(int addr, int num, bool * dest)
+{
+	return readBits(READ_COILS, addr, num, dest);
+}
+
+int UDPConnection::writeB(int addr, bool value)
+{
+	return writeSingle(WRITE_SINGLE_COIL, addr, value ? 0xFF00 : 0x0000);
+}
+
+int UDPConnection::transaction(const QByteArray & request, QByteArray & response)
+{
+	static const int MBAP_SIZE = 7;
+	static const int MAX_DATAGRAM_SIZE = 512;	// Modbus/TCP frame is at most 260 bytes long.
+
+	QMutexLocker locker(& m->mutex);
+	if (m->socket == INVALID_SOCKET_DESCRIPTOR)
+		return ERROR_COMMUNICATION;
+	socket_t socket = static_cast<socket_t>(m->socket);
+
+	uint16_t tid = ++m->transactionId;
+	QByteArray frame;
+	frame.reserve(MBAP_SIZE + request.size());
+	frame.append(static_cast<char>(tid >> 8)).append(static_cast<char>(tid & 0xFF));
+	frame.append('\0').append('\0');	// Protocol identifier.
+	frame.append(static_cast<char>((request.size() + 1) >> 8)).append(static_cast<char>((request.size() + 1) & 0xFF));
+	frame.append(static_cast<char>(m->unitId));
+	frame.append(request);
+
+	char datagram[MAX_DATAGRAM_SIZE];
+
+	// Discard datagrams, which arrived after previous transaction has been completed (e.g. responses to retransmissions).
+	while (PollSocket(socket, 0) > 0)
+		if (::recv(socket, datagram, MAX_DATAGRAM_SIZE, 0) < 0)
+			break;
+
+	for (int attempt = 0; attempt <= m->retries; attempt++) {
+		if (attempt > 0)
+			CUTEHMI_MODBUS_QDEBUG("Retransmitting UDP request (transaction '" << tid << "', attempt '" << attempt << "').");
+		if (::send(socket, frame.constData(), frame.size(), 0) != frame.size())
+			return ERROR_COMMUNICATION;
+
+		QElapsedTimer timer;
+		timer.start();
+		int remaining = m->responseTimeout;
+		while (remaining > 0) {
+			int ready = PollSocket(socket, remaining);
+			remaining = m->responseTimeout - static_cast<int>(timer.elapsed());
+			if (ready < 0) {
+				if (Interrupted())
+					continue;
+				return ERROR_COMMUNICATION;
+			}
+			if (ready == 0)
+				break;
+
+			// Errors reported by connected datagram socket (e.g. ICMP port unreachable) are treated as lost datagrams.
+			int size = static_cast<int>(::recv(socket, datagram, MAX_DATAGRAM_SIZE, 0));
+			if (size <= MBAP_SIZE)
+				continue;
+			const uchar * header = reinterpret_cast<const uchar *>(datagram);
+			// Frames, which do not match transaction identifier, are duplicates or late responses to previous requests.
+			if ((((header[0] << 8) | header[1]) != tid) || (header[2] != 0) || (header[3] != 0))
+				continue;
+			if (((header[4] << 8) | header[5]) != size - MBAP_SIZE + 1)
+				continue;
+			if (header[6] != static_cast<uchar>(m->unitId))
+				continue;
+
+			response = QByteArray(datagram + MBAP_SIZE, size - MBAP_SIZE);
+			uchar function = static_cast<uchar>(response.at(0));
+			uchar requestFunction = static_cast<uchar>(request.at(0));
+			if (function == (requestFunction | 0x80)) {
+				if (response.size() < 2)
+					return ERROR_COMMUNICATION;
+				uchar exception = static_cast<uchar>(response.at(1));
+				CUTEHMI_MODBUS_QDEBUG("Device has responded with exception code '" << exception << "'.");
+				// Exception codes 0x02 and 0x03 stand for illegal data address and illegal data value respectively.
+				return ((exception == 0x02) || (exception == 0x03)) ? ERROR_OUT_OF_RANGE : ERROR_COMMUNICATION;
+			}
+			if (function != requestFunction)
+				continue;
+			return 0;
+		}
+	}
+	CUTEHMI_MODBUS_QDEBUG("UDP transaction '" << tid << "' has timed out.");
+	return ERROR_COMMUNICATION;
+}
+
+int UDPConnection::readRegisters(function_t function, int addr, int num, uint16_t * dest)
+{
+	if ((num < 1) || (num > MAX_READ_REGISTERS) || (addr < 0) || (addr + num > 65536))
+		return ERROR_OUT_OF_RANGE;
+
+	QByteArray response;
+	int result = transaction(RequestPdu(function, addr, static_cast<uint16_t>(num)), response);
+	if (result < 0)
+		return result;
+
+	// Function code, byte count and register values.
+	if ((response.size() != 2 + 2 * num) || (static_cast<uchar>(response.at(1)) != 2 * num))
+		return ERROR_COMMUNICATION;
+	const uchar * data = reinterpret_cast<const uchar *>(response.constData()) + 2;
+	for (int i = 0; i < num; i++)
+		dest[i] = static_cast<uint16_t>((data[2 * i] << 8) | data[2 * i + 1]);
+	return num;
+}
+
+int UDPConnection::readBits(function_t function, int addr, int num, bool * dest)
+{
+	if ((num < 1) || (num > MAX_READ_BITS) || (addr < 0) || (addr + num > 65536))
+		return ERROR_OUT_OF_RANGE;
+
+	QByteArray response;
+	int result = transaction(RequestPdu(function, addr, static_cast<uint16_t>(num)), response);
+	if (result < 0)
+		return result;
+
+	// Function code, byte count and packed bits (least significant bit first).
+	int byteCount = (num + 7) / 8;
+	if ((response.size() != 2 + byteCount) || (static_cast<uchar>(response.at(1)) != byteCount))
+		return ERROR_COMMUNICATION;
+	const uchar * data = reinterpret_cast<const uchar *>(response.constData()) + 2;
+	for (int i = 0; i < num; i++)
+		dest[i] = (data[i / 8] >> (i % 8)) & 1;
+	return num;
+}
+
+int UDPConnection::writeSingle(function_t function, int addr, uint16_t value)
+{
+	if ((addr < 0) || (addr > 65535))
+		return ERROR_OUT_OF_RANGE;
+
+	QByteArray request = RequestPdu(function, addr, value);
+	QByteArray response;
+	int result = transaction(request, response);
+	if (result < 0)
+		return result;
+
+	// Normal response is an echo of the request.
+	if (response != request)
+		return ERROR_COMMUNICATION;
+	return 1;
+}
+
+void UDPConnection::closeSocket()
+{
+	if (m->socket != INVALID_SOCKET_DESCRIPTOR) {
+		CloseSocket(static_cast<socket_t>(m->socket));
+		m->socket = INVALID_SOCKET_DESCRIPTOR;
+#ifdef Q_OS_WIN
+		::WSACleanup();
+#endif
+	}
+}
+
+QByteArray UDPConnection::RequestPdu(function_t function, int addr, uint16_t value)
+{
+	QByteArray result;
+	result.reserve(5);
+	result.append(static_cast<char>(function));
+	result.append(static_cast<char>((addr >> 8) & 0xFF)).append(static_cast<char>(addr & 0xFF));
+	result.append(static_cast<char>(value >> 8)).append(static_cast<char>(value & 0xFF));
+	return result;
+}
+
+}
+}
+}
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
@@ -0,0 +1,196 @@
+#include <modbus/Client.hpp>
+#include <modbus/internal/DummyConnection.hpp>
+#include <modbus/internal/ServiceTask.hpp>
+#include <modbus/internal/ServiceThread.hpp>
+#include <modbus/internal/ServiceWorkerPool.hpp>
+
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QFile>
+
+#ifdef Q_OS_UNIX
+	#include <sys/resource.h>
+#endif
+
+#include <memory>
+#include <vector>
+
+namespace cutehmi {
+namespace modbus {
+
+/**
+ * Pooled service benchmark. Many devices are served for a fixed amount of time either by shared workers (ServiceTask)
+ * or by a thread per device (ServiceThread), so that both execution modes can be compared. Part of the devices are
+ * reconnecting, which is simulated with connection latency of dummy connection. Benchmark reports scan rate of the
+ * healthy devices, the longest gap between their consecutive scans, which must not be affected by devices, which are
+ * reconnecting, growth of resident memory of the process and processor time consumed by the process during the run.
+ * Memory and processor time are reported only on Unix-like systems (resident memory only on Linux). Memory released by
+ * previous rows may be reused by the allocator, so rows are best compared when run separately (e.g. by passing row name
+ * on the command line).
+ */
+class bench_ServicePool:
+	public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void scan_data();
+
+		void scan();
+
+	private:
+		static constexpr unsigned long LATENCY = 5;	// [ms] Latency of a single transaction.
+		static constexpr unsigned long CONNECT_LATENCY = 3000;	// [ms] Latency of connection attempt of a reconnecting device.
+		static constexpr unsigned long SLEEP = 100;	// [ms] Sleep between read cycles.
+		static constexpr int REGISTERS = 8;	// Number of wakeful registers per device.
+		static constexpr int DURATION = 5000;	// [ms] Duration of a single run.
+
+		/**
+		 * Get resident memory of the process.
+		 * @return resident set size [KiB] or @p -1 if it is not available.
+		 */
+		static qint64 ResidentMemory();
+
+		/**
+		 * Get processor time consumed by the process.
+		 * @return user and system time [ms] or @p -1 if it is not available.
+		 */
+		static qint64 ProcessorTime();
+};
+
+void bench_ServicePool::scan_data()
+{
+	QTest::addColumn<QString>("execution");
+	QTest::addColumn<int>("devices");
+	QTest::addColumn<int>("reconnecting");
+
+	for (const char * execution : {"pool", "thread"})
+		for (int devices : {50, 200, 500}) {
+			QTest::newRow(QString("%1, %2 devices").arg(execution).arg(devices).toLocal8Bit().constData()) << QString(execution) << devices << 0;
+			QTest::newRow(QString("%1, %2 devices, %3 reconnecting").arg(execution).arg(devices).arg(devices / 10).toLocal8Bit().constData()) << QString(execution) << devices << devices / 10;
+		}
+}
+
+void bench_ServicePool::scan()
+{
+	QFETCH(QString, execution);
+	QFETCH(int, devices);
+	QFETCH(int, reconnecting);
+
+	bool pooled = execution == "pool";
+	qint64 initialMemory = ResidentMemory();
+	std::vector<std::unique_ptr<Client>> clients;
+	std::vector<std::unique_ptr<internal::ServiceTask>> tasks;
+	std::vector<std::unique_ptr<internal::ServiceThread>> threads;
+	QVector<int> scans(devices, 0);
+	QVector<qint64> lastScan(devices, 0);
+	QVector<qint64> maxGap(devices, 0);
+	QElapsedTimer elapsed;
+
+	for (int i = 0; i < devices; i++) {
+		std::unique_ptr<internal::DummyConnection> connection(new internal::DummyConnection);
+		connection->setLatency(LATENCY);
+		// Reconnecting devices are the first ones, so that they are assigned to workers together with healthy ones.
+		if (i < reconnecting)
+			connection->setConnectLatency(CONNECT_LATENCY);
+		clients.emplace_back(new Client(std::move(connection)));
+		Client * client = clients.back().get();
+		for (int addr = 0; addr < REGISTERS; addr++)
+			client->irAt(addr)->awake();
+		if (pooled) {
+			tasks.emplace_back(new internal::ServiceTask(client));
+			tasks.back()->setSleep(SLEEP);
+		} else {
+			threads.emplace_back(new internal::ServiceThread(client));
+			threads.back()->setSleep(SLEEP);
+		}
+		connect(client, & Client::scanned, this, [i, & scans, & lastScan, & maxGap, & elapsed]() {
+			qint64 now = elapsed.elapsed();
+			scans[i]++;
+			maxGap[i] = qMax(maxGap[i], now - lastScan[i]);
+			lastScan[i] = now;
+		});
+	}
+
+	qint64 initialTime = ProcessorTime();
+	elapsed.start();
+	for (std::unique_ptr<internal::ServiceTask> & task : tasks)
+		task->start();
+	for (std::unique_ptr<internal::ServiceThread> & thread : threads)
+		thread->start();
+	QTest::qWait(DURATION);
+	// Memory is measured while services are still running, so that it includes stacks of the threads.
+	qint64 memory = ResidentMemory();
+	for (std::unique_ptr<internal::ServiceTask> & task : tasks)
+		task->stop();
+	for (std::unique_ptr<internal::ServiceThread> & thread : threads)
+		thread->stop();
+	for (std::unique_ptr<internal::ServiceTask> & task : tasks)
+		task->wait();
+	for (std::unique_ptr<internal::ServiceThread> & thread : threads)
+		thread->wait();
+	qint64 runTime = elapsed.elapsed();
+	qint64 processorTime = ProcessorTime();
+
+	int healthyScans = 0;
+	qint64 worstGap = 0;
+	for (int i = reconnecting; i < devices; i++) {
+		healthyScans += scans.at(i);
+		worstGap = qMax(worstGap, qMax(maxGap.at(i), runTime - lastScan.at(i)));
+	}
+	int healthy = devices - reconnecting;
+	qreal rate = 1000.0 * healthyScans / runTime / healthy;
+	qreal idealRate = 1000.0 / (SLEEP + LATENCY);
+
+	QString memoryInfo = (memory >= 0) && (initialMemory >= 0) ? QString("%1 KiB").arg(memory - initialMemory) : QString("n/a");
+	QString processorInfo = (processorTime >= 0) && (initialTime >= 0) ? QString("%1 ms (%2% of one core)").arg(processorTime - initialTime).arg(100.0 * (processorTime - initialTime) / runTime, 0, 'f', 1) : QString("n/a");
+	QString executionInfo = pooled ? QString("on %1 workers").arg(internal::ServiceWorkerPool::Instance().size()) : QString("in own threads");
+	qInfo().noquote() << QString("%1 devices (%2 reconnecting) %3: %4 scans/s per healthy device (ideal %5), worst gap %6 ms, memory growth %7, processor time %8.")
+						 .arg(devices).arg(reconnecting).arg(executionInfo)
+						 .arg(rate, 0, 'f', 2).arg(idealRate, 0, 'f', 2).arg(worstGap)
+						 .arg(memoryInfo).arg(processorInfo);
+	QTest::setBenchmarkResult(rate, QTest::Events);
+
+	QVERIFY(healthyScans > 0);
+	// Reconnecting devices must not stall healthy devices sharing the same workers.
+	if (reconnecting > 0)
+		QVERIFY2(worstGap < static_cast<qint64>(CONNECT_LATENCY), "healthy devices have been stalled by reconnecting ones");
+}
+
+qint64 bench_ServicePool::ResidentMemory()
+{
+#ifdef Q_OS_LINUX
+	QFile status("/proc/self/status");
+	if (status.open(QIODevice::ReadOnly | QIODevice::Text))
+		for (QByteArray line = status.readLine(); !line.isEmpty(); line = status.readLine())
+			if (line.startsWith("VmRSS:"))
+				return line.mid(6).trimmed().split(' ').first().toLongLong();
+#endif
+	return -1;
+}
+
+qint64 bench_ServicePool::ProcessorTime()
+{
+#ifdef Q_OS_UNIX
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, & usage) == 0)
+		return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000 + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000;
+#endif
+	return -1;
+}
+
+constexpr unsigned long bench_ServicePool::LATENCY;
+constexpr unsigned long bench_ServicePool::CONNECT_LATENCY;
+constexpr unsigned long bench_ServicePool::SLEEP;
+constexpr int bench_ServicePool::REGISTERS;
+constexpr int bench_ServicePool::DURATION;
+
+}
+}
+
+QTEST_GUILESS_MAIN(cutehmi::modbus::bench_ServicePool)
+
+#include "bench_ServicePool.moc"
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
@@ -0,0 +1,157 @@
+#include "LossyUDPServer.hpp"
+
+#include <QUdpSocket>
+#include <QHostAddress>
+#include <QMutexLocker>
+
+namespace cutehmi {
+namespace modbus {
+
+LossyUDPServer::LossyUDPServer(int loss, unsigned seed):
+	m_loss(loss),
+	m_random(seed),
+	m_percent(0, 99),
+	m_received(0),
+	m_dropped(0),
+	m_port(0),
+	m_bound(false)
+{
+}
+
+LossyUDPServer::~LossyUDPServer()
+{
+	quit();
+	wait();
+}
+
+quint16 LossyUDPServer::startAndWait()
+{
+	QMutexLocker locker(& m_mutex);
+	start();
+	while (!m_bound)
+		m_boundCondition.wait(& m_mutex);
+	return m_port;
+}
+
+int LossyUDPServer::received() const
+{
+	return m_received.load();
+}
+
+int LossyUDPServer::dropped() const
+{
+	return m_dropped.load();
+}
+
+void LossyUDPServer::run()
+{
+	// Socket is created within server thread, so that it has affinity to the thread, which serves it.
+	QUdpSocket socket;
+	bool bound = socket.bind(QHostAddress::LocalHost, 0);
+	connect(& socket, & QUdpSocket::readyRead, & socket, [this, & socket]() {
+		onReadyRead(& socket);
+	});
+
+	m_mutex.lock();
+	m_port = bound ? socket.localPort() : 0;
+	m_bound = true;
+	m_boundCondition.wakeAll();
+	m_mutex.unlock();
+
+	if (bound)
+		exec();
+}
+
+bool LossyUDPServer::Respond(const QByteArray & request, QByteArray & response)
+{
+	static const int MBAP_SIZE = 7;
+	static const int ADDR_SPACE_SIZE = 65536;
+
+	if (request.size() < MBAP_SIZE + 5)
+		return false;
+
+	const uchar * frame = reinterpret_cast<const uchar *>(request.constData());
+	uchar function = frame[MBAP_SIZE];
+	int addr = (frame[MBAP_SIZE + 1] << 8) | frame[MBAP_SIZE + 2];
+	int value = (frame[MBAP_SIZE + 3] << 8) | frame[MBAP_SIZE + 4];
+
+	QByteArray pdu;
+	auto exception = [& pdu, function](uchar code) {
+		pdu.clear();
+		pdu.append(static_cast<char>(function | 0x80)).append(static_cast<char>(code));
+	};
+
+	switch (function) {
+		case 0x01:	// Read coils.
+		case 0x02:	// Read discrete inputs.
+			if ((value < 1) || (value > 2000) || (addr + value > ADDR_SPACE_SIZE))
+				exception(0x02);
+			else {
+				QByteArray bits((value + 7) / 8, '\0');
+				for (int i = 0; i < value; i++)
+					if ((addr + i) & 1)
+						bits[i / 8] = static_cast<char>(bits.at(i / 8) | (1 << (i % 8)));
+				pdu.append(static_cast<char>(function)).append(static_cast<char>(bits.size())).append(bits);
+			}
+			break;
+		case 0x03:	// Read holding registers.
+		case 0x04:	// Read input registers.
+			if ((value < 1) || (value > 125) || (addr + value > ADDR_SPACE_SIZE))
+				exception(0x02);
+			else {
+				pdu.append(static_cast<char>(function)).append(static_cast<char>(2 * value));
+				for (int i = 0; i < value; i++)
+					pdu.append(static_cast<char>((addr + i) >> 8)).append(static_cast<char>((addr + i) & 0xFF));
+			}
+			break;
+		case 0x05:	// Write single coil.
+		case 0x06:	// Write single register.
+			pdu = request.mid(MBAP_SIZE, 5);
+			break;
+		default:
+			exception(0x01);
+	}
+
+	response.clear();
+	response.append(request.left(4));	// Transaction and protocol identifiers.
+	response.append(static_cast<char>((pdu.size() + 1) >> 8)).append(static_cast<char>((pdu.size() + 1) & 0xFF));
+	response.append(request.at(6));	// Unit identifier.
+	response.append(pdu);
+	return true;
+}
+
+void LossyUDPServer::onReadyRead(QUdpSocket * socket)
+{
+	while (socket->hasPendingDatagrams()) {
+		QByteArray request(static_cast<int>(qMax<qint64>(socket->pendingDatagramSize(), 0)), '\0');
+		QHostAddress sender;
+		quint16 senderPort;
+		if (socket->readDatagram(request.data(), request.size(), & sender, & senderPort) != request.size())
+			continue;
+		m_received.ref();
+
+		// Request and response are dropped independently, as if they were lost on their way.
+		if (drop())
+			continue;
+		QByteArray response;
+		if (!Respond(request, response))
+			continue;
+		if (drop())
+			continue;
+		socket->writeDatagram(response, sender, senderPort);
+	}
+}
+
+bool LossyUDPServer::drop()
+{
+	if (m_percent(m_random) >= m_loss)
+		return false;
+	m_dropped.ref();
+	return true;
+}
+
+}
+}
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
@@ -0,0 +1,80 @@
+#ifndef CUTEHMI_CUTEHMI__MODBUS__1__LIB_TESTS_BENCH_UDPCONNECTION_LOSSYUDPSERVER_HPP
+#define CUTEHMI_CUTEHMI__MODBUS__1__LIB_TESTS_BENCH_UDPCONNECTION_LOSSYUDPSERVER_HPP
+
+#include <QObject>
+#include <QThread>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <random>
+
+class QUdpSocket;
+
+namespace cutehmi {
+namespace modbus {
+
+/**
+ * Lossy Modbus/UDP server. Server answers read and single write requests of all four tables. Register value is equal to
+ * its address and bit value is the lowest bit of its address. To simulate unreliable network, each incoming request and
+ * each outgoing response is dropped with given probability. Server runs in its own thread.
+ */
+class LossyUDPServer:
+	public QThread
+{
+	Q_OBJECT
+
+	public:
+		/**
+		 * Constructor.
+		 * @param loss probability of dropping a datagram [%].
+		 * @param seed seed of random number generator, which decides, whether datagram is dropped.
+		 */
+		explicit LossyUDPServer(int loss, unsigned seed = 1);
+
+		~LossyUDPServer() override;
+
+		/**
+		 * Start server and wait until it is bound.
+		 * @return UDP port of the server or @p 0 if server could not be bound.
+		 */
+		quint16 startAndWait();
+
+		int received() const;
+
+		int dropped() const;
+
+	protected:
+		void run() override;
+
+	private:
+		/**
+		 * Process request and compose response.
+		 * @param request request frame (MBAP header followed by PDU).
+		 * @param response response frame.
+		 * @return @p true if response has been composed, @p false if request has been malformed.
+		 */
+		static bool Respond(const QByteArray & request, QByteArray & response);
+
+		void onReadyRead(QUdpSocket * socket);
+
+		bool drop();
+
+		int m_loss;
+		std::mt19937 m_random;
+		std::uniform_int_distribution<int> m_percent;
+		QAtomicInt m_received;
+		QAtomicInt m_dropped;
+		quint16 m_port;
+		bool m_bound;
+		QMutex m_mutex;
+		QWaitCondition m_boundCondition;
+};
+
+}
+}
+
+#endif
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
@@ -0,0 +1,102 @@
+#include "LossyUDPServer.hpp"
+
+#include <modbus/internal/UDPConnection.hpp>
+
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QtConcurrent>
+
+namespace cutehmi {
+namespace modbus {
+
+/**
+ * UDP connection benchmark. Connection reads spans of registers from lossy server for a fixed amount of time. Benchmark
+ * reports throughput and number of failed transactions at 0%, 1% and 5% datagram loss. Transactions are issued from
+ * a thread other than the one, which has created the connection, as it happens with pooled services.
+ */
+class bench_UDPConnection:
+	public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void throughput_data();
+
+		void throughput();
+
+	private:
+		static constexpr int RESPONSE_TIMEOUT = 50;	// [ms]
+		static constexpr int RETRIES = 3;
+		static constexpr int SPAN = internal::UDPConnection::MAX_READ_REGISTERS;
+		static constexpr int DURATION = 3000;	// [ms] Duration of a single run.
+};
+
+void bench_UDPConnection::throughput_data()
+{
+	QTest::addColumn<int>("loss");
+
+	QTest::newRow("0% loss") << 0;
+	QTest::newRow("1% loss") << 1;
+	QTest::newRow("5% loss") << 5;
+}
+
+void bench_UDPConnection::throughput()
+{
+	QFETCH(int, loss);
+
+	LossyUDPServer server(loss);
+	quint16 port = server.startAndWait();
+	QVERIFY(port != 0);
+
+	internal::UDPConnection connection("127.0.0.1", port, 0xff, RESPONSE_TIMEOUT, RETRIES);
+	QVERIFY(connection.connect());
+
+	int succeeded = 0;
+	int failed = 0;
+	int corrupted = 0;
+	QElapsedTimer elapsed;
+	elapsed.start();
+	QtConcurrent::run([& connection, & succeeded, & failed, & corrupted, & elapsed]() {
+		uint16_t values[SPAN];
+		for (int addr = 0; elapsed.elapsed() < DURATION; addr = (addr + SPAN) % (65536 - SPAN)) {
+			if (connection.readR(addr, SPAN, values) != SPAN) {
+				failed++;
+				continue;
+			}
+			succeeded++;
+			for (int i = 0; i < SPAN; i++)
+				if (values[i] != addr + i) {
+					corrupted++;
+					break;
+				}
+		}
+	}).waitForFinished();
+	qint64 runTime = elapsed.elapsed();
+	connection.disconnect();
+
+	qreal rate = 1000.0 * succeeded / runTime;
+	qInfo().noquote() << QString("%1% loss: %2 transactions/s (%3 registers/s), %4 failed, %5 of %6 datagrams dropped by server.")
+						 .arg(loss).arg(rate, 0, 'f', 1).arg(rate * SPAN, 0, 'f', 0).arg(failed)
+						 .arg(server.dropped()).arg(server.received());
+	QTest::setBenchmarkResult(rate, QTest::Events);
+
+	QCOMPARE(corrupted, 0);
+	if (loss == 0)
+		QCOMPARE(failed, 0);
+	QVERIFY(succeeded > 0);
+}
+
+constexpr int bench_UDPConnection::RESPONSE_TIMEOUT;
+constexpr int bench_UDPConnection::RETRIES;
+constexpr int bench_UDPConnection::SPAN;
+constexpr int bench_UDPConnection::DURATION;
+
+}
+}
+
+QTEST_GUILESS_MAIN(cutehmi::modbus::bench_UDPConnection)
+
+#include "bench_UDPConnection.moc"
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
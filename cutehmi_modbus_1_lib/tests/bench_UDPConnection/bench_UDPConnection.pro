@@ -0,0 +1,22 @@
+include(../../../common.pri)
+
+TEMPLATE = app
+TARGET = bench_UDPConnection
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+QT -= gui
+QT += testlib qml concurrent network
+
+include(../../../cutehmi_utils_1_lib/import.pri)
+include(../../../cutehmi_base_1_lib/import.pri)
+include(../../../cutehmi_services_1_lib/import.pri)
+include(../../../libmodbus.pri)
+include(../../import.pri)
+
+SOURCES += \
+    bench_UDPConnection.cpp \
+    LossyUDPServer.cpp
+
+HEADERS += \
+    LossyUDPServer.hpp
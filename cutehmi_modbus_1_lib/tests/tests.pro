@@ -0,0 +1,6 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    bench_ServicePool \
+    bench_UDPConnection \
+    tst_DiscoveryScanner
@@ -0,0 +1,350 @@
+#include <modbus/internal/DiscoveryScanner.hpp>
+#include <modbus/internal/DummyConnection.hpp>
+#include <modbus/internal/TCPConnection.hpp>
+
+#include <QtTest>
+#include <QThread>
+
+#include <memory>
+
+typedef QList<cutehmi::modbus::internal::DiscoveryScanner::Range> RangeList;
+
+Q_DECLARE_METATYPE(RangeList)
+
+namespace cutehmi {
+namespace modbus {
+namespace internal {
+
+bool operator ==(const DiscoveryScanner::Range & r1, const DiscoveryScanner::Range & r2)
+{
+	return (r1.address == r2.address) && (r1.count == r2.count);
+}
+
+}
+
+/**
+ * Discovery scanner test. Scanner is run against simulated devices, which reject requests touching illegal addresses,
+ * against dummy connection and, if its address is given by @p CUTEHMI_MODBUS_TEST_SERVER environmental variable (for
+ * example "127.0.0.1:502"), against local test server (SimpleModbusServer).
+ */
+class tst_DiscoveryScanner:
+	public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void ranges_data();
+
+		void ranges();
+
+		void illegalBlockRequests();
+
+		void silentUnits();
+
+		void concurrentConnections();
+
+		void dummyConnection();
+
+		void toXML();
+
+		void localServer();
+
+	private:
+		typedef internal::DiscoveryScanner::Range Range;
+
+		/**
+		 * Simulated device. All four tables share the same layout of legal addresses.
+		 */
+		struct Device
+		{
+			QVector<bool> legal;
+			QList<int> unitIds;
+			unsigned long latency;	// [ms]
+			QAtomicInt requests;
+			QAtomicInt open;
+			QAtomicInt peak;
+
+			Device():
+				legal(internal::DiscoveryScanner::ADDR_SPACE_SIZE, false),
+				unitIds({1}),
+				latency(0)
+			{
+			}
+
+			void setLegal(const RangeList & ranges)
+			{
+				for (const Range & range : ranges)
+					for (int addr = range.address; addr < range.address + range.count; addr++)
+						legal[addr] = true;
+			}
+		};
+
+		/**
+		 * Connection to simulated device.
+		 */
+		class DeviceConnection:
+			public internal::AbstractConnection
+		{
+			public:
+				DeviceConnection(Device & device, int unitId):
+					m_device(device),
+					m_unitId(unitId),
+					m_connected(false)
+				{
+				}
+
+				bool connect() override
+				{
+					int open = m_device.open.fetchAndAddOrdered(1) + 1;
+					for (int peak = m_device.peak.load(); (open > peak) && !m_device.peak.testAndSetOrdered(peak, open); peak = m_device.peak.load()) {
+					}
+					m_connected = true;
+					return true;
+				}
+
+				void disconnect() override
+				{
+					if (m_connected)
+						m_device.open.deref();
+					m_connected = false;
+				}
+
+				bool connected() const override
+				{
+					return m_connected;
+				}
+
+				int readIr(int addr, int num, uint16_t * dest) override
+				{
+					std::fill(dest, dest + qMax(0, num), 0);
+					return respond(addr, num);
+				}
+
+				int readR(int addr, int num, uint16_t * dest) override
+				{
+					std::fill(dest, dest + qMax(0, num), 0);
+					return respond(addr, num);
+				}
+
+				int writeR(int addr, uint16_t value) override
+				{
+					Q_UNUSED(value);
+					return respond(addr, 1);
+				}
+
+				int readIb(int addr, int num, bool * dest) override
+				{
+					std::fill(dest, dest + qMax(0, num), false);
+					return respond(addr, num);
+				}
+
+				int readB(int addr, int num, bool * dest) override
+				{
+					std::fill(dest, dest + qMax(0, num), false);
+					return respond(addr, num);
+				}
+
+				int writeB(int addr, bool value) override
+				{
+					Q_UNUSED(value);
+					return respond(addr, 1);
+				}
+
+			private:
+				int respond(int addr, int num)
+				{
+					m_device.requests.ref();
+					if (m_device.latency > 0)
+						QThread::msleep(m_device.latency);
+					if (!m_device.unitIds.contains(m_unitId))
+						return ERROR_COMMUNICATION;
+					for (int i = addr; i < addr + num; i++)
+						if (!m_device.legal.at(i))
+							return ERROR_OUT_OF_RANGE;
+					return num;
+				}
+
+				Device & m_device;
+				int m_unitId;
+				bool m_connected;
+		};
+
+		static internal::DiscoveryScanner::ConnectionFactory DeviceFactory(Device & device);
+};
+
+internal::DiscoveryScanner::ConnectionFactory tst_DiscoveryScanner::DeviceFactory(Device & device)
+{
+	return [& device](int unitId) {
+		return std::unique_ptr<internal::AbstractConnection>(new DeviceConnection(device, unitId));
+	};
+}
+
+void tst_DiscoveryScanner::ranges_data()
+{
+	QTest::addColumn<RangeList>("legal");
+	QTest::addColumn<RangeList>("expected");
+
+	QTest::newRow("all legal") << RangeList({{0, 300}}) << RangeList({{0, 300}});
+	QTest::newRow("nothing legal") << RangeList() << RangeList();
+	QTest::newRow("gap across blocks") << RangeList({{0, 130}, {170, 130}}) << RangeList({{0, 130}, {170, 130}});
+	QTest::newRow("gap inside block") << RangeList({{0, 40}, {60, 240}}) << RangeList({{0, 40}, {60, 240}});
+	QTest::newRow("illegal block") << RangeList({{0, 100}, {200, 100}}) << RangeList({{0, 100}, {200, 100}});
+	QTest::newRow("ranges at block ends") << RangeList({{0, 10}, {95, 10}, {290, 10}}) << RangeList({{0, 10}, {95, 10}, {290, 10}});
+	QTest::newRow("single addresses") << RangeList({{0, 1}, {99, 1}, {100, 1}, {299, 1}}) << RangeList({{0, 1}, {99, 2}, {299, 1}});
+	QTest::newRow("range across gap halves") << RangeList({{0, 10}, {40, 20}, {90, 10}}) << RangeList({{0, 10}, {40, 20}, {90, 10}});
+	QTest::newRow("range enclosed by gap half") << RangeList({{0, 10}, {20, 5}, {90, 10}}) << RangeList({{0, 10}, {20, 5}, {90, 10}});
+	QTest::newRow("island inside block") << RangeList({{40, 21}}) << RangeList({{40, 21}});
+	QTest::newRow("islands across blocks") << RangeList({{30, 8}, {95, 10}, {250, 8}}) << RangeList({{30, 8}, {95, 10}, {250, 8}});
+}
+
+void tst_DiscoveryScanner::ranges()
+{
+	QFETCH(RangeList, legal);
+	QFETCH(RangeList, expected);
+
+	Device device;
+	device.setLegal(legal);
+	internal::DiscoveryScanner scanner(DeviceFactory(device));
+	scanner.setUnitIds({1});
+	scanner.setAddressRange(0, 300);
+	scanner.setBlockSize(100);
+
+	QList<internal::DiscoveryScanner::UnitMap> maps = scanner.scan();
+	QCOMPARE(maps.count(), 1);
+	QCOMPARE(maps.at(0).unitId, 1);
+	QCOMPARE(maps.at(0).ir, expected);
+	QCOMPARE(maps.at(0).r, expected);
+	QCOMPARE(maps.at(0).ib, expected);
+	QCOMPARE(maps.at(0).b, expected);
+	QCOMPARE(device.open.load(), 0);
+}
+
+void tst_DiscoveryScanner::illegalBlockRequests()
+{
+	static constexpr int BLOCKS = 10;
+	static constexpr int BLOCK_SIZE = 100;
+
+	Device device;
+	internal::DiscoveryScanner scanner(DeviceFactory(device));
+	scanner.setUnitIds({1});
+	scanner.setAddressRange(0, BLOCKS * BLOCK_SIZE);
+	scanner.setBlockSize(BLOCK_SIZE);
+	QList<internal::DiscoveryScanner::UnitMap> maps = scanner.scan();
+	QCOMPARE(maps.count(), 1);
+
+	// Unit check takes one request. Bisection of illegal blocks should take less requests than reading address by address.
+	QVERIFY(device.requests.load() <= 1 + 4 * BLOCKS * BLOCK_SIZE);
+
+	// If gaps are not searched, each block fails as a whole and it has illegal addresses at both ends.
+	device.requests.store(0);
+	scanner.setMinGapSize(BLOCK_SIZE);
+	maps = scanner.scan();
+	QCOMPARE(maps.count(), 1);
+	QVERIFY(device.requests.load() <= 1 + 4 * BLOCKS * 3);
+}
+
+void tst_DiscoveryScanner::silentUnits()
+{
+	Device device;
+	device.unitIds = {2, 5};
+	device.setLegal({{0, 10}});
+	internal::DiscoveryScanner scanner(DeviceFactory(device));
+	scanner.setUnitIds({1, 2, 3, 4, 5});
+	scanner.setAddressRange(0, 10);
+
+	QList<internal::DiscoveryScanner::UnitMap> maps = scanner.scan();
+	QCOMPARE(maps.count(), 2);
+	QCOMPARE(maps.at(0).unitId, 2);
+	QCOMPARE(maps.at(1).unitId, 5);
+	QCOMPARE(maps.at(1).r, RangeList({{0, 10}}));
+}
+
+void tst_DiscoveryScanner::concurrentConnections()
+{
+	static constexpr int MAX_CONNECTIONS = 3;
+
+	Device device;
+	device.latency = 2;
+	device.setLegal({{0, 2000}});
+	internal::DiscoveryScanner scanner(DeviceFactory(device));
+	scanner.setUnitIds({1});
+	scanner.setAddressRange(0, 2000);
+	scanner.setMaxConnections(MAX_CONNECTIONS);
+
+	QList<internal::DiscoveryScanner::UnitMap> maps = scanner.scan();
+	QCOMPARE(maps.count(), 1);
+	QCOMPARE(maps.at(0).ir, RangeList({{0, 2000}}));
+
+	// Blocks of a single unit should be probed over several connections, but not over more than allowed.
+	QVERIFY(device.peak.load() > 1);
+	QVERIFY(device.peak.load() <= MAX_CONNECTIONS);
+	QCOMPARE(device.open.load(), 0);
+}
+
+void tst_DiscoveryScanner::dummyConnection()
+{
+	internal::DiscoveryScanner scanner([](int) {
+		return std::unique_ptr<internal::AbstractConnection>(new internal::DummyConnection);
+	});
+	scanner.setUnitIds({1, 2});
+	scanner.setAddressRange(0, 1000);
+
+	QList<internal::DiscoveryScanner::UnitMap> maps = scanner.scan();
+	QCOMPARE(maps.count(), 2);
+	for (const internal::DiscoveryScanner::UnitMap & map : maps) {
+		QCOMPARE(map.ir, RangeList({{0, 1000}}));
+		QCOMPARE(map.r, RangeList({{0, 1000}}));
+		QCOMPARE(map.ib, RangeList({{0, 1000}}));
+		QCOMPARE(map.b, RangeList({{0, 1000}}));
+	}
+}
+
+void tst_DiscoveryScanner::toXML()
+{
+	internal::DiscoveryScanner::UnitMap map{3, RangeList({{0, 10}}), RangeList({{5, 2}, {100, 20}}), RangeList(), RangeList({{7, 1}})};
+	QString xml = internal::DiscoveryScanner::ToXML({map});
+
+	QVERIFY(xml.contains("<!-- Unit 3. -->"));
+	QVERIFY(xml.contains("<ir address=\"0\" count=\"10\"/>"));
+	QVERIFY(xml.contains("<r address=\"5\" count=\"2\"/>"));
+	QVERIFY(xml.contains("<r address=\"100\" count=\"20\"/>"));
+	QVERIFY(!xml.contains("<ib "));
+	QVERIFY(xml.contains("<b address=\"7\" count=\"1\"/>"));
+}
+
+void tst_DiscoveryScanner::localServer()
+{
+	QString server = QString::fromLocal8Bit(qgetenv("CUTEHMI_MODBUS_TEST_SERVER"));
+	if (server.isEmpty())
+		QSKIP("CUTEHMI_MODBUS_TEST_SERVER is not set.");
+
+	QString node = server.section(':', 0, 0);
+	QString service = server.section(':', 1, 1);
+	if (service.isEmpty())
+		service = "502";
+
+	// Test server accepts single client and it exposes whole address space of all tables.
+	internal::DiscoveryScanner scanner([node, service](int unitId) {
+		return std::unique_ptr<internal::AbstractConnection>(new internal::TCPConnection(node, service, unitId));
+	});
+	scanner.setUnitIds({1});
+	scanner.setAddressRange(0, 200);
+	scanner.setMaxConnections(1);
+
+	QList<internal::DiscoveryScanner::UnitMap> maps = scanner.scan();
+	QCOMPARE(maps.count(), 1);
+	QCOMPARE(maps.at(0).ir, RangeList({{0, 200}}));
+	QCOMPARE(maps.at(0).r, RangeList({{0, 200}}));
+	QCOMPARE(maps.at(0).ib, RangeList({{0, 200}}));
+	QCOMPARE(maps.at(0).b, RangeList({{0, 200}}));
+}
+
+}
+}
+
+QTEST_GUILESS_MAIN(cutehmi::modbus::tst_DiscoveryScanner)
+
+#include "tst_DiscoveryScanner.moc"
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
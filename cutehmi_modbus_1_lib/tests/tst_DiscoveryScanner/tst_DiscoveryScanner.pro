@@ -0,0 +1,18 @@
+include(../../../common.pri)
+
+TEMPLATE = app
+TARGET = tst_DiscoveryScanner
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+QT -= gui
+QT += testlib qml concurrent
+
+include(../../../cutehmi_utils_1_lib/import.pri)
+include(../../../cutehmi_base_1_lib/import.pri)
+include(../../../cutehmi_services_1_lib/import.pri)
+include(../../../libmodbus.pri)
+include(../../import.pri)
+
+SOURCES += \
+    tst_DiscoveryScanner.cpp
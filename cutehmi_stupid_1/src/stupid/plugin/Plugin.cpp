@@ -65,17 +65,25 @@ void Plugin::parseStupid(const base::xml::ParseHelper & parentHelper, base::Proj
 	std::unique_ptr<Service> service;
 	std::unique_ptr<DatabaseConnectionData> dbData;
 	unsigned long serviceSleep = 0;
+	QString notificationChannel;
+	int historyConnections = 1;
+	int backgroundConnections = 0;
+	bool rollups = false;
 
 	QXmlStreamReader & xmlReader = *helper.xmlReader();
 	while (helper.readNextRecognizedElement()) {
 		if (xmlReader.name() == "client") {
 			base::xml::ParseHelper clientHelper(& helper);
-			clientHelper << base::xml::ParseElement("session", {base::xml::ParseAttribute("type", "SQL")}, 1, 1);
+			clientHelper << base::xml::ParseElement("session", {base::xml::ParseAttribute("type", "SQL")}, 1, 1)
+						 << base::xml::ParseElement("notifications", {base::xml::ParseAttribute("channel", "[A-Za-z_][A-Za-z0-9_]*")}, 0, 1)
+						 << base::xml::ParseElement("connections", {base::xml::ParseAttribute("history", "[0-9]+", false),
+																	base::xml::ParseAttribute("background", "[0-9]+", false)}, 0, 1)
+						 << base::xml::ParseElement("rollups", 0, 1);
 
 			while (clientHelper.readNextRecognizedElement()) {
 				if (xmlReader.name() == "session") {
 					base::xml::ParseHelper sessionHelper(& clientHelper);
-					sessionHelper << base::xml::ParseElement("dbms", {base::xml::ParseAttribute("name", "PostgreSQL")}, 1, 1);
+					sessionHelper << base::xml::ParseElement("dbms", {base::xml::ParseAttribute("name", "(PostgreSQL|SQLite)")}, 1, 1);
 					while (sessionHelper.readNextRecognizedElement()) {
 						if (xmlReader.name() == "dbms") {
 							dbData.reset(new DatabaseConnectionData);
@@ -83,10 +91,22 @@ void Plugin::parseStupid(const base::xml::ParseHelper & parentHelper, base::Proj
 							if (xmlReader.attributes().value("name") == "PostgreSQL") {
 								dbData->type = "QPSQL";
 								parsePostgreSQL(sessionHelper, *dbData);
+							} else if (xmlReader.attributes().value("name") == "SQLite") {
+								dbData->type = "QSQLITE";
+								dbData->port = -1;
+								parseSQLite(sessionHelper, *dbData);
 							}
 						}
 					}
-				}
+				} else if (xmlReader.name() == "notifications")
+					notificationChannel = xmlReader.attributes().value("channel").toString();
+				else if (xmlReader.name() == "connections") {
+					if (xmlReader.attributes().hasAttribute("history"))
+						historyConnections = xmlReader.attributes().value("history").toInt();
+					if (xmlReader.attributes().hasAttribute("background"))
+						backgroundConnections = xmlReader.attributes().value("background").toInt();
+				} else if (xmlReader.name() == "rollups")
+					rollups = true;
 			}
 		} else if (xmlReader.name() == "service") {
 			base::xml::ParseHelper serviceHelper(& helper);
@@ -105,6 +125,10 @@ void Plugin::parseStupid(const base::xml::ParseHelper & parentHelper, base::Proj
 
 	client.reset(new Client);
 	client->moveDatabaseConnectionData(std::move(dbData));
+	client->setNotificationChannel(notificationChannel);
+	client->setHistoryConnections(historyConnections);
+	client->setBackgroundConnections(backgroundConnections);
+	client->setRollupsEnabled(rollups);
 
 	service.reset(new Service(name, client.get()));
 	service->setSleep(serviceSleep);
@@ -158,6 +182,25 @@ void Plugin::parsePostgreSQL(const base::xml::ParseHelper & parentHelper, Databa
 	}
 }
 
+void Plugin::parseSQLite(const base::xml::ParseHelper & parentHelper, DatabaseConnectionData & dbData)
+{
+	base::xml::ParseHelper helper(& parentHelper);
+	helper << base::xml::ParseElement("sqlite", 1, 1);
+
+	QXmlStreamReader & xmlReader = *helper.xmlReader();
+	while (helper.readNextRecognizedElement()) {
+		if (xmlReader.name() == "sqlite") {
+			base::xml::ParseHelper sqliteHelper(& helper);
+			sqliteHelper << base::xml::ParseElement("file", 1, 1);
+
+			while (sqliteHelper.readNextRecognizedElement()) {
+				if (xmlReader.name() == "file")
+					dbData.databaseName = xmlReader.readElementText();
+			}
+		}
+	}
+}
+
 }
 }
 }
@@ -40,6 +40,8 @@ class Plugin:
 		void parseStupid(const base::xml::ParseHelper & parentHelper, base::ProjectNode & node, const QString & id, const QString & name);
 
 		void parsePostgreSQL(const base::xml::ParseHelper & parentHelper, stupid::DatabaseConnectionData & dbData);
+
+		void parseSQLite(const base::xml::ParseHelper & parentHelper, stupid::DatabaseConnectionData & dbData);
 };
 
 }
@@ -38,7 +38,14 @@ SOURCES += \
     src/stupid/Client.cpp \
     src/stupid/Service.cpp \
     src/stupid/internal/AsyncConnector.cpp \
-    src/stupid/internal/functions.cpp
+    src/stupid/internal/functions.cpp \
+    src/stupid/internal/HistoryCache.cpp \
+    src/stupid/internal/DatabasePool.cpp \
+    src/stupid/internal/DS18B20HistoryBatchWorker.cpp \
+    src/stupid/internal/RollupWorker.cpp \
+    src/stupid/internal/DS18B20Registry.cpp \
+    src/stupid/internal/SqlDialect.cpp \
+    src/stupid/internal/Executor.cpp
 
 HEADERS += \
     include/stupid/internal/platform.hpp \
@@ -54,7 +61,14 @@ HEADERS += \
     include/stupid/Client.hpp \
     include/stupid/Service.hpp \
     include/stupid/internal/AsyncConnector.hpp \
-    include/stupid/internal/functions.hpp
+    include/stupid/internal/functions.hpp \
+    include/stupid/internal/HistoryCache.hpp \
+    include/stupid/internal/DatabasePool.hpp \
+    include/stupid/internal/DS18B20HistoryBatchWorker.hpp \
+    include/stupid/internal/RollupWorker.hpp \
+    include/stupid/internal/DS18B20Registry.hpp \
+    include/stupid/internal/SqlDialect.hpp \
+    include/stupid/internal/Executor.hpp
 
 DISTFILES += \
     import.pri \
@@ -3,8 +3,11 @@
 
 #include "internal/common.hpp"
 #include "internal/DatabaseConnectionData.hpp"
-#include "internal/DatabaseThread.hpp"
+#include "internal/DatabasePool.hpp"
 #include "internal/AsyncConnector.hpp"
+#include "internal/DS18B20HistoryBatchWorker.hpp"
+#include "internal/RollupWorker.hpp"
+#include "internal/DS18B20Registry.hpp"
 #include "DS18B20.hpp"
 #include "DS18B20History.hpp"
 
@@ -12,6 +15,8 @@
 
 #include <QObject>
 #include <QSqlError>
+#include <QMutex>
+#include <QStringList>
 
 namespace cutehmi {
 namespace stupid {
@@ -62,6 +67,65 @@ class CUTEHMI_STUPID_API Client:
 
 		void checkDatabaseConnectionStatus();
 
+		/**
+		 * Set notification channel. If channel is set, client subscribes to database notifications sent to the channel and
+		 * it emits changesNotified() whenever they arrive. Notification payload is expected to carry @a w1_device_id of the
+		 * modified @a ds18b20 row(s) (comma-separated list is accepted), so that readAll() fetches only these rows. Notification
+		 * with empty payload makes readAll() fetch all rows changed since previous read. Sample PostgreSQL trigger:
+		 *
+		 * @code
+		 * CREATE FUNCTION ds18b20_notify() RETURNS trigger AS $$
+		 * BEGIN
+		 *     PERFORM pg_notify('ds18b20', NEW.w1_device_id::text);
+		 *     RETURN NEW;
+		 * END;
+		 * $$ LANGUAGE plpgsql;
+		 *
+		 * CREATE TRIGGER ds18b20_notify AFTER INSERT OR UPDATE ON ds18b20 FOR EACH ROW EXECUTE PROCEDURE ds18b20_notify();
+		 * @endcode
+		 *
+		 * @param channel channel name. Empty string disables notifications.
+		 *
+		 * @warning this function must not be called while client is connected.
+		 */
+		void setNotificationChannel(const QString & channel);
+
+		QString notificationChannel() const;
+
+		/**
+		 * Set number of history connections. History queries are run through dedicated database connections, so that they do
+		 * not delay polling of live values, which has its own connection.
+		 * @param count number of connections. If zero, history queries share connection with live polling.
+		 *
+		 * @warning this function must not be called while client is connected.
+		 */
+		void setHistoryConnections(int count);
+
+		int historyConnections() const;
+
+		/**
+		 * Set number of background connections. Background connections are used by low priority jobs, such as prefetching or
+		 * maintenance.
+		 * @param count number of connections. If zero, background jobs share connections with history queries.
+		 *
+		 * @warning this function must not be called while client is connected.
+		 */
+		void setBackgroundConnections(int count);
+
+		int backgroundConnections() const;
+
+		/**
+		 * Enable rollups. When rollups are enabled, client maintains per-minute, per-hour and per-day rollups of
+		 * historical data in background lane (see setBackgroundConnections()) and long-range history queries are served
+		 * from the coarsest rollup, which still provides one sample per bucket.
+		 * @param enabled whether to maintain and use rollups. Rollup tables are created, if they do not exist.
+		 *
+		 * @warning this function must not be called while client is connected.
+		 */
+		void setRollupsEnabled(bool enabled);
+
+		bool rollupsEnabled() const;
+
 	public slots:
 		/**
 		 * Connect client to the STUPiD database.
@@ -74,13 +138,27 @@ class CUTEHMI_STUPID_API Client:
 		void disconnect();
 
 		/**
-		 * Read all devices data.
+		 * Read all devices data. Only rows, which have changed since previous read are fetched from the database, except
+		 * periodic full synchronization.
 		 *
 		 * @param run indicates whether to interrupt read. Function interrupts reading and returns, if @p 0 is being set. If @p 1 is set
 		 * function will return only after reading all values of coils and registers.
 		 */
 		void readAll(const QAtomicInt & run = 1);
 
+		/**
+		 * Request history update of multiple devices. Function sets @a from, @a to and @a buckets properties of history
+		 * objects of all the listed devices and fetches their missing data with a single query, which is more efficient than
+		 * calling DS18B20History::requestUpdate() on each of them, when many trends are displayed at once.
+		 * @param w1Ids 1-wire identifiers of devices.
+		 * @param from beginning of time range.
+		 * @param to end of time range.
+		 * @param buckets number of buckets. See DS18B20History::setBuckets().
+		 * @return @p true when request was accepted. If previous request has not finished yet, @p false is returned and
+		 * request is rejected.
+		 */
+		bool requestHistoryUpdate(const QStringList & w1Ids, qint64 from, qint64 to, int buckets = 0);
+
 	signals:
 		void error(cutehmi::base::ErrorInfo errInfo);
 
@@ -92,29 +170,93 @@ class CUTEHMI_STUPID_API Client:
 
 		void ds18b20HistoryChanged();
 
+		/**
+		 * Changes notified. Database has notified that some of the devices have been updated. Signal is emitted from
+		 * database thread.
+		 */
+		void changesNotified();
+
+		/**
+		 * Changes delivered. Signal is emitted, after changes of devices have been delivered to DS18B20 objects.
+		 */
+		void changesDelivered();
+
 	protected:
 		// If there's no update for more than EXPIRE_MIN_INTERVAL + m_daemonSleep * EXPIRE_DAEMON_CYCLES, data should be marked as stalled.
 		static constexpr int EXPIRE_DAEMON_CYCLES = 1;
 		static constexpr int EXPIRE_MIN_INTERVAL = 30000;
 
+		// Rows with timestamps up to DELTA_OVERLAP milliseconds older than the newest seen timestamp are fetched again, in case
+		// they have been committed out of order.
+		static constexpr int DELTA_OVERLAP = 1000;
+
+		// Full table is fetched every FULL_SYNC_INTERVAL milliseconds to pick up changes, which are not reflected by timestamps
+		// (e.g. 'plugged' status of a device).
+		static constexpr int FULL_SYNC_INTERVAL = 30000;
+
+		// Rollups are updated every ROLLUP_INTERVAL milliseconds.
+		static constexpr int ROLLUP_INTERVAL = 60000;
+
 		void asyncConnect(QObject * connector);
 
 		void processSQLErrors();
 
 		void clearDevices();
 
+		void updateHistories();
+
+		/**
+		 * Store notified changes, so that they are fetched by next readAll() call.
+		 * @param payload notification payload.
+		 *
+		 * @note this function is thread-safe.
+		 */
+		void storeNotification(const QVariant & payload);
+
+	protected slots:
+		/**
+		 * Deliver pending changes. Signals of all the devices, which have changed since previous delivery are emitted at
+		 * once from the thread, which the client lives in.
+		 */
+		void deliverChanges();
+
 	private:
 		typedef QVector<QSqlError> SQLErrorsContainer;
 
+		struct SensorChanges
+		{
+			int valueTypes;
+			bool errorChange;
+		};
+
+		typedef QHash<DS18B20 *, SensorChanges> ChangesContainer;
+
+		void postChanges(const ChangesContainer & changes);
+
 		struct Members
 		{
 			unsigned long daemonSleep = 0;
 			bool connected = false;
 			internal::AsyncConnector * asyncConnector = nullptr;
-			internal::DatabaseThread dbThread;
+			internal::DatabasePool dbPool;
 			SQLErrorsContainer sqlErrors;
-			QVariantMap ds18b20;
+			internal::DS18B20Registry ds18b20Registry;
+			QVariantMap ds18b20;	///< View of ds18b20Registry keyed by 1-wire identifiers.
 			QVariantMap ds18b20History;
+			internal::HistoryCache historyCache;
+			std::unique_ptr<internal::DS18B20HistoryBatchWorker> historyBatchWorker;
+			QList<DS18B20History *> batchHistories;
+			bool rollupsEnabled = false;
+			std::unique_ptr<internal::RollupWorker> rollupWorker;
+			qint64 nextRollup = 0;
+			QDateTime lastSeen;
+			qint64 nextFullSync = 0;
+			qint64 nextExpireCheck = 0;
+			QMutex notifiedMutex;
+			QStringList notifiedIds;
+			bool notifiedAll = false;
+			QMutex changesMutex;
+			ChangesContainer pendingChanges;
 		};
 
 		utils::MPtr<Members> m;
@@ -72,9 +72,28 @@ class CUTEHMI_STUPID_API DS18B20:
 
 		const Data & data() const;
 
+		/**
+		 * Store data without emitting any signals. Appropriate error flags will be set.
+		 * @param data new data.
+		 * @param now current time, which is used to check whether data has expired. Data expires at the instant given by its expire date.
+		 * @param errorChange set to @p true if error flags have changed, @p false otherwise.
+		 * @return binary combination of @p valueType_t flags denoting values, which have changed.
+		 *
+		 * @note this function is thread-safe.
+		 */
+		int storeData(const Data & data, const QDateTime & now, bool & errorChange);
+
+		/**
+		 * Notify about changes. Emits valueUpdated() signal if @a valueTypes is non-zero and errorChanged() if @a errorChange
+		 * is @p true.
+		 * @param valueTypes binary combination of @p valueType_t flags as returned by storeData().
+		 * @param errorChange whether error flags have changed.
+		 */
+		void notifyChanges(int valueTypes, bool errorChange);
+
 	public slots:
 		/**
-		 * Update data. Appropriate error flags will be set.
+		 * Update data. Appropriate error flags will be set. Signals are emitted only if data or error flags have changed.
 		 * @param data new data.
 		 *
 		 * @note this function is thread-safe.
@@ -3,6 +3,7 @@
 
 #include "internal/common.hpp"
 #include "internal/DS18B20HistoryWorker.hpp"
+#include "internal/HistoryCache.hpp"
 
 #include <charts/PointSeries.hpp>
 
@@ -18,6 +19,8 @@ class CUTEHMI_STUPID_API DS18B20History:
 {
 	Q_OBJECT
 
+	friend class Client;
+
 	public:
 		Q_PROPERTY(cutehmi::charts::PointSeries * series READ series NOTIFY seriesChanged)
 		Q_PROPERTY(qint64 from READ from WRITE setFrom NOTIFY fromChanged)
@@ -25,8 +28,17 @@ class CUTEHMI_STUPID_API DS18B20History:
 		Q_PROPERTY(qint64 minimum READ minimum NOTIFY minimumChanged)
 		Q_PROPERTY(qint64 maximum READ maximum NOTIFY maximumChanged)
 		Q_PROPERTY(bool updating READ updating NOTIFY updatingChanged)
+		Q_PROPERTY(int buckets READ buckets WRITE setBuckets NOTIFY bucketsChanged)
 
-		DS18B20History(std::unique_ptr<internal::DS18B20HistoryWorker> worker = nullptr, QObject * parent = 0);
+		/**
+		 * Constructor. Constructor does not access database. Use updateRange() to provide initial values of minimum and
+		 * maximum properties; afterwards they are refreshed with each update.
+		 * @param worker worker used to fetch historical data.
+		 * @param cache history cache. If cache is provided, only ranges, which are missing from the cache are fetched. Cache
+		 * must outlive history object. If @p nullptr is passed, whole range is fetched on each update request.
+		 * @param parent parent object.
+		 */
+		DS18B20History(std::unique_ptr<internal::DS18B20HistoryWorker> worker = nullptr, internal::HistoryCache * cache = nullptr, QObject * parent = 0);
 
 		~DS18B20History() override;
 
@@ -56,12 +68,36 @@ class CUTEHMI_STUPID_API DS18B20History:
 		 */
 		qint64 maximum() const;
 
+		/**
+		 * Update range. Sets values of minimum and maximum properties and emits corresponding signals, if they have changed.
+		 * @param minimum timestamp value for which historcal data starts to be available.
+		 * @param maximum timestamp value of most recent historcal data that is available.
+		 */
+		void updateRange(qint64 minimum, qint64 maximum);
+
 		bool updating() const;
 
+		/**
+		 * Get number of buckets.
+		 * @return number of buckets into which time range is split, when fetching historical data.
+		 */
+		int buckets() const;
+
+		/**
+		 * Set number of buckets. When number of buckets is positive, database returns only first, last, minimal and maximal
+		 * sample of each bucket, so that number of transferred samples does not depend on length of time range. Typically
+		 * this property is bound to the width of the plot area in pixels.
+		 * @param buckets number of buckets. Value of @p 0 (default) fetches all samples.
+		 */
+		void setBuckets(int buckets);
+
 	public slots:
 		/**
-		 * Request update.
-		 * @return @p true when request was accepted. If previous request has not finished yet, @p false is returned and request is rejected.
+		 * Request update. If all the requested data is cached, series is updated immediately. Otherwise missing data is
+		 * inserted into the series progressively, as it is fetched. If previous request has not finished yet, it is cancelled
+		 * and superseded by the new one.
+		 * @return @p true when request was accepted. If history is being updated by Client::requestHistoryUpdate(), @p false
+		 * is returned and request is rejected.
 		 */
 		bool requestUpdate();
 
@@ -78,10 +114,34 @@ class CUTEHMI_STUPID_API DS18B20History:
 
 		void updatingChanged();
 
+		void bucketsChanged();
+
 	protected slots:
 		void update();
 
+		void appendChunk(int serial, int segment, const cutehmi::charts::PointSeries::DataContainer & chunk);
+
 	private:
+		const QString & w1Id() const;
+
+		int requestLevel() const;
+
+		/**
+		 * Begin update. Stores requested window and determines ranges, which have to be fetched. Series is set to cached
+		 * data, except points within the ranges to be fetched. If all the requested data is cached, update is completed
+		 * immediately.
+		 * @return ranges to be fetched. If empty, update has been completed and no fetch is needed.
+		 */
+		internal::HistoryCache::RangesContainer beginUpdate();
+
+		/**
+		 * Finish update.
+		 * @param results fetched results.
+		 */
+		void finishUpdate(const internal::DS18B20HistoryWorker::Results & results);
+
+		void startUpdate();
+
 		void setUpdating(bool updating);
 
 		struct Members
@@ -93,6 +153,14 @@ class CUTEHMI_STUPID_API DS18B20History:
 			qint64 from;
 			qint64 to;
 			bool updating;
+			int buckets;
+			internal::HistoryCache * cache;
+			int requestLevel;
+			qint64 requestFrom;
+			qint64 requestTo;
+			int serial;
+			bool fetching;
+			bool superseded;
 		};
 
 		utils::MPtr<Members> m;
@@ -8,6 +8,8 @@
 
 #include <services/Service.hpp>
 
+#include <QElapsedTimer>
+
 #include <memory>
 
 namespace cutehmi {
@@ -37,6 +39,8 @@ class CUTEHMI_STUPID_API Service:
 
 		void onClientDisconnected();
 
+		void onClientChangesDelivered();
+
 		void handleError(cutehmi::base::ErrorInfo errorInfo);
 
 	private:
@@ -44,6 +48,8 @@ class CUTEHMI_STUPID_API Service:
 		{
 			std::unique_ptr<internal::CommunicationThread> thread;
 			Client * client;
+			QElapsedTimer startElapsed;	///< Time elapsed since service has been started.
+			bool firstValuesPending;	///< Whether first values are yet to be delivered since service has been started.
 		};
 
 		utils::MPtr<Members> m;
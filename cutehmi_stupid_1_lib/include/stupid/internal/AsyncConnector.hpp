@@ -2,15 +2,21 @@
 #define CUTEHMI_CUTEHMI__STUPID__1__LIB_INCLUDE_STUPID_INTERNAL_ASYNCCONNECTOR_HPP
 
 #include "common.hpp"
-#include "Worker.hpp"
+#include "Executor.hpp"
 #include "DatabaseThread.hpp"
 
 #include <QStringList>
+#include <QHash>
+#include <QPair>
 
 namespace cutehmi {
 namespace stupid {
 namespace internal {
 
+/**
+ * Asynchronous connector. Connector loads data needed to set up the client (device list, history ranges of devices and
+ * settings), once database thread has connected.
+ */
 class AsyncConnector:
 	public QObject
 {
@@ -19,16 +25,38 @@ class AsyncConnector:
 	public:
 		enum status_t {
 			INIT,
-			ENUMERATE_DEVICES,
-			LOAD_DAEMON_SLEEP,
+			BOOTSTRAP,
 			FINALIZE,
 			CONNECTED
 		};
 
+		typedef QPair<qint64, qint64> HistoryRange;
+
+		typedef QHash<QString, HistoryRange> HistoryRangesContainer;
+
 		AsyncConnector(DatabaseThread * dbThread, QObject * parent = 0);
 
+		/**
+		 * Destructor. Job, which has been submitted and has not finished yet, is cancelled and destructor waits until it
+		 * finishes.
+		 */
+		~AsyncConnector() override;
+
 		const QStringList & w1Ids() const;
 
+		/**
+		 * Get device identifiers.
+		 * @return database identifiers (@a w1_device.id) of devices. Identifiers correspond to w1Ids() entries at same
+		 * positions.
+		 */
+		const QList<int> & deviceIds() const;
+
+		/**
+		 * Get history ranges. Ranges of all devices are loaded along with the device list.
+		 * @return minimal and maximal timestamp of historical data of each device, which has any historical data.
+		 */
+		const HistoryRangesContainer & historyRanges() const;
+
 		unsigned long daemonSleep() const;
 
 		status_t status() const;
@@ -40,10 +68,19 @@ class AsyncConnector:
 		void connected(QObject * connector);
 
 	private:
+		/**
+		 * Submit job to the executor of database thread. Once job is completed, connect() is called to proceed with next
+		 * step.
+		 * @param task task function.
+		 */
+		void submit(Executor::Task task);
+
 		DatabaseThread * m_dbThread;
-		Worker m_dbWorker;
+		Executor::Future m_future;
 		unsigned long m_daemonSleep;
 		QStringList m_w1Ids;
+		QList<int> m_deviceIds;
+		HistoryRangesContainer m_historyRanges;
 		status_t m_status;
 };
 
@@ -5,6 +5,8 @@
 
 #include <QThread>
 #include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
 
 namespace cutehmi {
 namespace stupid {
@@ -34,12 +36,31 @@ class CommunicationThread:
 
 		void stop();
 
+		/**
+		 * Wake thread. If thread is sleeping it starts next cycle immediately, otherwise next cycle starts as soon as current
+		 * one finishes.
+		 *
+		 * @threadsafe
+		 */
+		void wake();
+
 	private:
 		struct Members
 		{
 			QAtomicInt run;
 			unsigned long sleep;
 			Client * client;
+			QMutex wakeMutex;
+			QWaitCondition wakeCondition;
+			bool woken;
+
+			Members(Client * p_client):
+				run(0),
+				sleep(0),
+				client(p_client),
+				woken(false)
+			{
+			}
 		};
 
 		utils::MPtr<Members> m;
@@ -0,0 +1,79 @@
+#ifndef CUTEHMI_CUTEHMI__STUPID__1__LIB_INCLUDE_STUPID_INTERNAL_DS18B20HISTORYBATCHWORKER_HPP
+#define CUTEHMI_CUTEHMI__STUPID__1__LIB_INCLUDE_STUPID_INTERNAL_DS18B20HISTORYBATCHWORKER_HPP
+
+#include "common.hpp"
+#include "Worker.hpp"
+#include "DatabaseThread.hpp"
+#include "DS18B20HistoryWorker.hpp"
+#include "SqlDialect.hpp"
+
+#include <QHash>
+
+namespace cutehmi {
+namespace stupid {
+namespace internal {
+
+/**
+ * DS18B20History batch update worker. Fetches historical data of multiple devices with a single query. Device
+ * identifiers and history bounds are resolved once, ranges of all devices are combined with UNION ALL, so that each
+ * device is fetched only over its own missing ranges, and rows are demultiplexed into results of individual devices in
+ * a single pass.
+ */
+class DS18B20HistoryBatchWorker:
+	public Worker
+{
+	public:
+		typedef QHash<QString, HistoryCache::RangesContainer> RangesContainer;
+
+		typedef QHash<QString, DS18B20HistoryWorker::Results> ResultsContainer;
+
+		DS18B20HistoryBatchWorker(DatabaseThread & thread);
+
+		/**
+		 * Destructor. Job is cancelled and destructor waits until it finishes, so that job does not access members of
+		 * destroyed object.
+		 */
+		~DS18B20HistoryBatchWorker() override;
+
+		/**
+		 * Set ranges.
+		 * @param ranges time ranges to be fetched keyed by 1-wire identifiers of devices.
+		 */
+		void setRanges(const RangesContainer & ranges);
+
+		/**
+		 * Set bucket width.
+		 * @param width bucket width [ms]. Value of @p 0 fetches all samples. See DS18B20HistoryWorker::setBucketWidth().
+		 */
+		void setBucketWidth(qint64 width);
+
+		/**
+		 * Get results.
+		 * @return results of each device. Each result contains segments corresponding to requested ranges of the device.
+		 */
+		const ResultsContainer & results() const;
+
+	protected:
+		void job(const Executor::CancellationToken & token) override;
+
+	private:
+		struct Members
+		{
+			QString connectionName;
+			SqlDialect dialect;
+			RangesContainer ranges;
+			qint64 bucketWidth;
+			ResultsContainer results;
+		};
+
+		utils::MPtr<Members> m;
+};
+
+}
+}
+}
+
+#endif
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
@@ -4,44 +4,115 @@
 #include "common.hpp"
 #include "Worker.hpp"
 #include "DatabaseThread.hpp"
+#include "HistoryCache.hpp"
+#include "RollupWorker.hpp"
+#include "SqlDialect.hpp"
 
 #include <charts/PointSeries.hpp>
 
+#include <QList>
+
 namespace cutehmi {
 namespace stupid {
 namespace internal {
 
 /**
- * DS18B20History update worker.
+ * DS18B20History update worker. Rows are fetched with forward-only query and they are passed to the receiver in chunks of
+ * CHUNK_SIZE points with chunkFetched() signal, so that worker does not buffer whole result set and the receiver can
+ * display data progressively.
  */
 class DS18B20HistoryWorker:
 	public Worker
 {
+	Q_OBJECT
+
 	public:
-		struct Results
+		static constexpr int CHUNK_SIZE = 4096;
+
+		/**
+		 * Segment of historical data.
+		 */
+		struct Segment
 		{
 			qint64 from;
 			qint64 to;
+			charts::PointSeries::DataContainer data;
+		};
+
+		struct Results
+		{
 			qint64 minimum;
 			qint64 maximum;
-			charts::PointSeries::DataContainer data;
+			QList<Segment> segments;	///< Segments corresponding to requested ranges. Data of segments is passed with chunkFetched() signal.
 		};
 
 		DS18B20HistoryWorker(DatabaseThread & thread, const QString & w1Id);
 
-		void setFrom(qint64 from);
+		/**
+		 * Destructor. Job is cancelled and destructor waits until it finishes, so that job does not access members of
+		 * destroyed object.
+		 */
+		~DS18B20HistoryWorker() override;
+
+		const QString & w1Id() const;
+
+		/**
+		 * Set ranges. Data is fetched separately for each range.
+		 * @param ranges time ranges.
+		 */
+		void setRanges(const HistoryCache::RangesContainer & ranges);
 
-		void setTo(qint64 to);
+		/**
+		 * Set bucket width. If bucket width is positive, each range is split into buckets of given width and only first,
+		 * last, minimal and maximal sample of each bucket is fetched (M4 aggregation), which preserves shape of the plot at
+		 * the resolution of one bucket per pixel.
+		 * @param width bucket width [ms]. Value of @p 0 fetches all samples.
+		 */
+		void setBucketWidth(qint64 width);
+
+		/**
+		 * Enable rollups. When rollups are enabled and bucket width is at least as large as width of one of the rollups,
+		 * data, which has been already aggregated by RollupWorker, is fetched from coarsest suitable rollup table instead
+		 * of raw history.
+		 * @param enabled whether to use rollups.
+		 */
+		void setRollupsEnabled(bool enabled);
+
+		/**
+		 * Set serial number of the request. Serial number is passed along with fetched chunks, so that chunks of superseded
+		 * requests can be recognized.
+		 * @param serial serial number.
+		 */
+		void setSerial(int serial);
 
 		const Results & results() const;
 
-		void job() override;
+	signals:
+		/**
+		 * Chunk fetched. Signal is emitted from within database thread.
+		 * @param serial serial number of the request.
+		 * @param segment index of segment to which chunk belongs.
+		 * @param chunk fetched points.
+		 */
+		void chunkFetched(int serial, int segment, const cutehmi::charts::PointSeries::DataContainer & chunk);
+
+	protected:
+		/**
+		 * Fetch data. When job is cancelled, worker stops fetching data after current chunk.
+		 * @param token cancellation token.
+		 */
+		void job(const Executor::CancellationToken & token) override;
 
 	private:
 		struct Members
 		{
 			QString connectionName;
+			SqlDialect dialect;
 			QString w1Id;
+			HistoryCache::RangesContainer ranges;
+			qint64 bucketWidth;
+			bool rollupsEnabled;
+			int serial;
 			Results results;
 		};
 
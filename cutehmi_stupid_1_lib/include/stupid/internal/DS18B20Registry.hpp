@@ -0,0 +1,72 @@
+#ifndef CUTEHMI_CUTEHMI__STUPID__1__LIB_INCLUDE_STUPID_INTERNAL_DS18B20REGISTRY_HPP
+#define CUTEHMI_CUTEHMI__STUPID__1__LIB_INCLUDE_STUPID_INTERNAL_DS18B20REGISTRY_HPP
+
+#include "common.hpp"
+
+#include <QVector>
+#include <QHash>
+
+namespace cutehmi {
+namespace stupid {
+
+class DS18B20;
+
+namespace internal {
+
+/**
+ * DS18B20 registry. Maps database identifiers of devices (@a w1_device.id) to DS18B20 objects. Identifiers below
+ * MAX_DIRECT_ID are used directly as vector indices, so that lookup is a single array access. Larger identifiers are
+ * looked up in a hash.
+ *
+ * @note registry does not take ownership of DS18B20 objects.
+ */
+class DS18B20Registry
+{
+	public:
+		typedef QVector<DS18B20 *> SensorsContainer;
+
+		static constexpr int MAX_DIRECT_ID = 65536;
+
+		/**
+		 * Insert sensor.
+		 * @param id database identifier of a device.
+		 * @param sensor sensor.
+		 */
+		void insert(int id, DS18B20 * sensor);
+
+		/**
+		 * Get sensor.
+		 * @param id database identifier of a device.
+		 * @return sensor or @p nullptr if there is no sensor with given identifier.
+		 */
+		DS18B20 * at(int id) const;
+
+		/**
+		 * Get sensors.
+		 * @return all the sensors in dense storage.
+		 */
+		const SensorsContainer & sensors() const;
+
+		void clear();
+
+	private:
+		SensorsContainer m_sensors;
+		SensorsContainer m_direct;
+		QHash<int, DS18B20 *> m_indirect;
+};
+
+inline DS18B20 * DS18B20Registry::at(int id) const
+{
+	if ((id >= 0) && (id < MAX_DIRECT_ID))
+		return id < m_direct.size() ? m_direct.at(id) : nullptr;
+	return m_indirect.value(id, nullptr);
+}
+
+}
+}
+}
+
+#endif
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
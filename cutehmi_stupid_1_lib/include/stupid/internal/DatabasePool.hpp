@@ -0,0 +1,121 @@
+#ifndef CUTEHMI_CUTEHMI__STUPID__1__LIB_INCLUDE_STUPID_INTERNAL_DATABASEPOOL_HPP
+#define CUTEHMI_CUTEHMI__STUPID__1__LIB_INCLUDE_STUPID_INTERNAL_DATABASEPOOL_HPP
+
+#include "common.hpp"
+#include "DatabaseThread.hpp"
+#include "DatabaseConnectionData.hpp"
+
+#include <base/ErrorInfo.hpp>
+
+#include <QObject>
+
+#include <vector>
+#include <memory>
+
+namespace cutehmi {
+namespace stupid {
+namespace internal {
+
+/**
+ * Database pool. Set of database threads, each one with its own database connection. Threads are grouped into lanes, so
+ * that long-running jobs of one lane do not block jobs of another one. Live lane consists of a single thread, which uses
+ * original connection name. It is run with highest priority. Remaining lanes are run with lower priorities and their
+ * jobs are distributed among threads in a round-robin fashion.
+ */
+class DatabasePool:
+	public QObject
+{
+	Q_OBJECT
+
+	public:
+		enum lane_t {
+			LIVE_LANE,			///< Live values.
+			HISTORY_LANE,		///< Interactive history queries.
+			BACKGROUND_LANE,	///< Background jobs (e.g. prefetching or maintenance). If lane is empty, history lane is used instead.
+			LANES_COUNT
+		};
+
+		DatabasePool();
+
+		~DatabasePool() override;
+
+		/**
+		 * Set lane size.
+		 * @param lane lane. Size of live lane can not be changed.
+		 * @param size number of threads (and database connections) of the lane.
+		 *
+		 * @warning this function must not be called while pool is running.
+		 */
+		void setLaneSize(lane_t lane, int size);
+
+		int laneSize(lane_t lane) const;
+
+		void moveDatabaseConnectionData(std::unique_ptr<stupid::DatabaseConnectionData> dbData);
+
+		/**
+		 * Get connection data of live lane.
+		 * @return connection data.
+		 */
+		stupid::DatabaseConnectionData * dbData() const;
+
+		/**
+		 * Get live thread.
+		 * @return thread of live lane.
+		 */
+		DatabaseThread & liveThread();
+
+		/**
+		 * Get thread of a lane. Consecutive calls return consecutive threads of the lane.
+		 * @param lane lane.
+		 * @return database thread.
+		 */
+		DatabaseThread & thread(lane_t lane);
+
+		bool isRunning() const;
+
+		/**
+		 * Start all threads. Signal connected() is emitted as soon as live connection is established. Connections of remaining
+		 * lanes are established independently and their failures are reported with error() signal.
+		 */
+		void start();
+
+		/**
+		 * Stop all threads. Function blocks until threads are finished.
+		 */
+		void stop();
+
+	signals:
+		void error(cutehmi::base::ErrorInfo errInfo);
+
+		void connected();
+
+		void disconnected();
+
+	private:
+		typedef std::vector<std::unique_ptr<DatabaseThread>> ThreadsContainer;
+
+		void configureLane(lane_t lane);
+
+		struct Members
+		{
+			ThreadsContainer lanes[LANES_COUNT];
+			int next[LANES_COUNT];
+			std::unique_ptr<stupid::DatabaseConnectionData> dbData;
+
+			Members():
+				next{0, 0, 0}
+			{
+			}
+		};
+
+		utils::MPtr<Members> m;
+};
+
+}
+}
+}
+
+#endif
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
@@ -2,12 +2,15 @@
 #define CUTEHMI_CUTEHMI__STUPID__1__LIB_INCLUDE_STUPID_INTERNAL_DATABASETHREAD_HPP
 
 #include "common.hpp"
-#include "Worker.hpp"
+#include "Executor.hpp"
 #include "DatabaseConnectionData.hpp"
 
 #include <base/ErrorInfo.hpp>
 
 #include <QThread>
+#include <QSqlQuery>
+#include <QSqlDatabase>
+#include <QHash>
 
 #include <memory>
 
@@ -40,6 +43,31 @@ class DatabaseThread:
 
 		stupid::DatabaseConnectionData * dbData() const;
 
+		/**
+		 * Get executor. Executor lives in database thread, so that jobs submitted to it are run from within database thread.
+		 * Pending jobs are cancelled, when thread finishes.
+		 * @return executor of this thread.
+		 */
+		Executor & executor();
+
+		/**
+		 * Get prepared query. Statement is prepared once per connection and it is cached until connection gets closed.
+		 * @param sql SQL statement.
+		 * @return prepared query.
+		 *
+		 * @note this function must be called from within database thread (e.g. from a job submitted to executor()).
+		 */
+		QSqlQuery & preparedQuery(const QString & sql);
+
+		/**
+		 * Set notification channel. Once connection is established, thread subscribes to notifications sent to the channel
+		 * (e.g. PostgreSQL NOTIFY) and forwards them with notified() signal.
+		 * @param channel channel name. Empty string disables notifications.
+		 */
+		void setNotificationChannel(const QString & channel);
+
+		const QString & notificationChannel() const;
+
 	signals:
 		void error(cutehmi::base::ErrorInfo errInfo);
 
@@ -47,14 +75,30 @@ class DatabaseThread:
 
 		void disconnected();
 
+		/**
+		 * Notification received. Signal is emitted from within database thread.
+		 * @param payload notification payload.
+		 */
+		void notified(const QVariant & payload);
+
 	protected:
 		void run() override;
 
 	private:
+		/**
+		 * Set up SQLite database. Enables write-ahead logging and creates tables, time indices and triggers normalizing
+		 * timestamps, if they do not exist.
+		 * @param db database.
+		 */
+		static void setupSQLite(QSqlDatabase & db);
+
 		struct Members
 		{
 			std::unique_ptr<DatabaseConnectionData> dbData;
 			QMutex runLock;
+			QHash<QString, QSqlQuery> preparedQueries;
+			QString notificationChannel;
+			Executor executor;
 		};
 
 		utils::MPtr<Members> m;
@@ -0,0 +1,249 @@
+#ifndef CUTEHMI_CUTEHMI__STUPID__1__LIB_INCLUDE_STUPID_INTERNAL_EXECUTOR_HPP
+#define CUTEHMI_CUTEHMI__STUPID__1__LIB_INCLUDE_STUPID_INTERNAL_EXECUTOR_HPP
+
+#include "common.hpp"
+
+#include <QObject>
+#include <QEvent>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QList>
+
+#include <functional>
+
+namespace cutehmi {
+namespace stupid {
+namespace internal {
+
+/**
+ * Job executor. Executor processes queued jobs one at a time inside the thread, which it lives in. Jobs of higher priority
+ * are processed before jobs of lower priority and jobs of same priority are processed in order of submission. Job can be
+ * submitted with a key. Newest job replaces pending jobs with same key and a job with same key, which is being processed,
+ * is cancelled.
+ */
+class CUTEHMI_STUPID_API Executor:
+	public QObject
+{
+	typedef QObject Parent;
+
+	Q_OBJECT
+
+	struct Job;
+
+	public:
+		enum priority_t {
+			LOW_PRIORITY,
+			NORMAL_PRIORITY,
+			HIGH_PRIORITY
+		};
+
+		/**
+		 * Cancellation token. Copies of a token share the cancellation flag. Job should check the token periodically and
+		 * return as soon as possible, once it has been cancelled.
+		 */
+		class CancellationToken
+		{
+			public:
+				CancellationToken();
+
+				/**
+				 * Check whether cancellation has been requested.
+				 * @return @p true if cancellation has been requested, @p false otherwise.
+				 *
+				 * @threadsafe
+				 */
+				bool isCancelled() const;
+
+				/**
+				 * Request cancellation.
+				 *
+				 * @threadsafe
+				 */
+				void cancel();
+
+			private:
+				QSharedPointer<QAtomicInt> m_cancelled;
+		};
+
+		/**
+		 * Task function. Task is called from within executor thread.
+		 */
+		typedef std::function<void(const CancellationToken & token)> Task;
+
+		/**
+		 * Completion function. Completion is called from within thread of the context object passed to submit().
+		 * @param cancelled indicates whether job has been cancelled. Cancelled job may have been not run at all.
+		 */
+		typedef std::function<void(bool cancelled)> Completion;
+
+		/**
+		 * Future. Handle of submitted job. Default-constructed future does not refer to any job and it is considered
+		 * finished. Executor must outlive futures of its jobs, which are being cancelled.
+		 */
+		class Future
+		{
+			friend class Executor;
+
+			public:
+				Future() = default;
+
+				/**
+				 * Check whether job has finished. Job is finished, when it has been processed or removed from the queue.
+				 * @return @p true if job has finished, @p false otherwise.
+				 *
+				 * @threadsafe
+				 */
+				bool isFinished() const;
+
+				/**
+				 * Check whether job has been cancelled.
+				 * @return @p true if cancellation of the job has been requested, @p false otherwise.
+				 *
+				 * @threadsafe
+				 */
+				bool isCancelled() const;
+
+				/**
+				 * Cancel job. Pending job is removed from the queue. Job, which is being processed, has its cancellation
+				 * token set.
+				 *
+				 * @threadsafe
+				 */
+				void cancel();
+
+				/**
+				 * Wait for the job. Causes calling thread to wait until job finishes.
+				 *
+				 * @warning function must not be called from within executor thread.
+				 *
+				 * @threadsafe
+				 */
+				void wait() const;
+
+			private:
+				explicit Future(QSharedPointer<Job> job);
+
+				QSharedPointer<Job> m_job;
+		};
+
+		Executor(QObject * parent = nullptr);
+
+		/**
+		 * Destructor. Pending jobs are cancelled.
+		 */
+		~Executor() override;
+
+		/**
+		 * Submit job.
+		 * @param task task function.
+		 * @param priority job priority.
+		 * @param key job key. If key is not empty, pending jobs with the same key are cancelled and removed from the
+		 * queue, while a job with the same key, which is being processed, has its cancellation token set.
+		 * @param context context object, which determines thread in which @a completion is called. Completion is not
+		 * called if context object is destroyed in the meantime.
+		 * @param completion completion function.
+		 * @return future of the submitted job.
+		 *
+		 * @threadsafe
+		 */
+		Future submit(Task task, priority_t priority = NORMAL_PRIORITY, const QString & key = QString(), const QObject * context = nullptr, Completion completion = nullptr);
+
+		/**
+		 * Cancel all jobs. Pending jobs are removed from the queue and a job, which is being processed, has its cancellation
+		 * token set.
+		 *
+		 * @threadsafe
+		 */
+		void cancelAll();
+
+		/**
+		 * Get number of pending jobs.
+		 * @return number of jobs waiting in the queue.
+		 *
+		 * @threadsafe
+		 */
+		int pendingCount() const;
+
+	signals:
+		/**
+		 * Job finished. Signal is emitted from within executor thread, unless job has been cancelled before it was taken
+		 * from the queue, in which case signal is emitted from the thread, which cancelled the job.
+		 * @param id job identifier.
+		 * @param cancelled indicates whether job has been cancelled.
+		 */
+		void jobFinished(quint64 id, bool cancelled);
+
+	protected:
+		/**
+		 * Execute event. Each submission posts one execute event, which tells executor to process next job from the queue.
+		 */
+		class ExecuteEvent:
+				public QEvent
+		{
+			public:
+				/**
+				 * Registered event type.
+				 * @return value of a QEvent::Type registered for events of this class.
+				 */
+				static Type RegisteredType() noexcept;
+
+			public:
+				/**
+				 * Default constructor.
+				 */
+				ExecuteEvent();
+		};
+
+		bool event(QEvent * event) override;
+
+	private:
+		typedef QList<QSharedPointer<Job>> JobsContainer;
+
+		struct Job
+		{
+			Executor * executor;
+			quint64 id;
+			priority_t priority;
+			QString key;
+			Task task;
+			CancellationToken token;
+			bool finished;
+			mutable QMutex mutex;
+			mutable QWaitCondition waitCondition;
+
+			Job(Executor * p_executor, quint64 p_id, priority_t p_priority, const QString & p_key, Task p_task):
+				executor(p_executor),
+				id(p_id),
+				priority(p_priority),
+				key(p_key),
+				task(p_task),
+				finished(false)
+			{
+			}
+		};
+
+		void cancel(QSharedPointer<Job> job);
+
+		void finish(QSharedPointer<Job> job);
+
+		struct Members
+		{
+			JobsContainer queue;
+			QSharedPointer<Job> running;
+			quint64 nextId = 0;
+			mutable QMutex queueMutex;
+		};
+
+		utils::MPtr<Members> m;
+};
+
+}
+}
+}
+
+#endif
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
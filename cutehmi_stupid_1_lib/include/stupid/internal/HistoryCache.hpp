@@ -0,0 +1,156 @@
+#ifndef CUTEHMI_CUTEHMI__STUPID__1__LIB_INCLUDE_STUPID_INTERNAL_HISTORYCACHE_HPP
+#define CUTEHMI_CUTEHMI__STUPID__1__LIB_INCLUDE_STUPID_INTERNAL_HISTORYCACHE_HPP
+
+#include "common.hpp"
+
+#include <charts/PointSeries.hpp>
+
+#include <QString>
+#include <QMap>
+#include <QHash>
+#include <QPair>
+#include <QList>
+
+namespace cutehmi {
+namespace stupid {
+namespace internal {
+
+/**
+ * History cache. Stores segments of historical data, which have been fetched from the database. Segments are stored
+ * separately for each key (sensor) and level (resolution). Adjacent and overlapping segments of the same key and level
+ * are merged. Total number of cached points is bounded by a budget; least recently used segments are evicted first.
+ *
+ * @note this class is not thread-safe.
+ */
+class CUTEHMI_STUPID_API HistoryCache
+{
+	public:
+		typedef charts::PointSeries::DataContainer DataContainer;
+
+		typedef QPair<qint64, qint64> Range;	///< Time range [first, second] in milliseconds since epoch.
+
+		typedef QList<Range> RangesContainer;
+
+		static constexpr int RAW_LEVEL = -1;	///< Level of raw (not downsampled) data.
+
+		static constexpr int DEFAULT_BUDGET = 4 * 1024 * 1024;	///< Default budget (number of points).
+
+		/**
+		 * Get level matching requested resolution. Levels correspond to bucket widths, which are powers of two, so that
+		 * segments fetched for slightly different views can be reused.
+		 * @param from beginning of time range.
+		 * @param to end of time range.
+		 * @param buckets requested number of buckets. Value of @p 0 stands for raw data.
+		 * @return level, which provides at least @a buckets buckets within the time range.
+		 */
+		static int Level(qint64 from, qint64 to, int buckets);
+
+		/**
+		 * Get bucket width.
+		 * @param level level.
+		 * @return bucket width [ms] or @p 0 for RAW_LEVEL.
+		 */
+		static qint64 BucketWidth(int level);
+
+		/**
+		 * Get beginning of a bucket. Buckets are anchored at the epoch, so that buckets of data fetched for different time
+		 * ranges line up and segments can be merged without splitting buckets.
+		 * @param time time [ms].
+		 * @param width bucket width [ms]. Must be positive.
+		 * @return beginning of the bucket containing @a time, that is floor(@a time / @a width) * @a width.
+		 */
+		static qint64 BucketStart(qint64 time, qint64 width);
+
+		explicit HistoryCache(int budget = DEFAULT_BUDGET);
+
+		int budget() const;
+
+		/**
+		 * Set budget.
+		 * @param budget maximal number of cached points.
+		 */
+		void setBudget(int budget);
+
+		/**
+		 * Get number of cached points.
+		 * @return number of points.
+		 */
+		int size() const;
+
+		/**
+		 * Get missing ranges.
+		 * @param key key.
+		 * @param level level.
+		 * @param from beginning of time range.
+		 * @param to end of time range.
+		 * @return ordered list of sub-ranges of [@a from, @a to], which are not cached. For downsampled levels ranges are
+		 * extended to bucket boundaries, so that partially cached buckets are fetched as a whole.
+		 */
+		RangesContainer missing(const QString & key, int level, qint64 from, qint64 to) const;
+
+		/**
+		 * Insert segment.
+		 * @param key key.
+		 * @param level level.
+		 * @param from beginning of time range covered by the segment.
+		 * @param to end of time range covered by the segment.
+		 * @param data points ordered by x coordinate.
+		 */
+		void insert(const QString & key, int level, qint64 from, qint64 to, const DataContainer & data);
+
+		/**
+		 * Get cached data. Segments, which have been accessed, are marked as recently used.
+		 * @param key key.
+		 * @param level level.
+		 * @param from beginning of time range.
+		 * @param to end of time range.
+		 * @return cached points within time range ordered by x coordinate.
+		 */
+		DataContainer data(const QString & key, int level, qint64 from, qint64 to);
+
+		/**
+		 * Remove all segments of a key.
+		 * @param key key.
+		 */
+		void remove(const QString & key);
+
+		void clear();
+
+	private:
+		struct Segment
+		{
+			qint64 to;
+			DataContainer data;
+			quint64 lastUsed;
+		};
+
+		typedef QMap<qint64, Segment> SegmentsContainer;	///< Segments ordered by beginning of time range.
+
+		typedef QPair<QString, int> SegmentsKey;
+
+		/**
+		 * Evict least recently used segments until budget is met.
+		 * @param keep segments, which must not be evicted.
+		 * @param keepFrom beginning of the segment, which must not be evicted.
+		 */
+		void evict(const SegmentsKey & keep, qint64 keepFrom);
+
+		struct Members
+		{
+			QHash<SegmentsKey, SegmentsContainer> segments;
+			int budget;
+			int size;
+			quint64 useCounter;
+		};
+
+		utils::MPtr<Members> m;
+};
+
+}
+}
+}
+
+#endif
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
@@ -0,0 +1,107 @@
+#ifndef CUTEHMI_CUTEHMI__STUPID__1__LIB_INCLUDE_STUPID_INTERNAL_ROLLUPWORKER_HPP
+#define CUTEHMI_CUTEHMI__STUPID__1__LIB_INCLUDE_STUPID_INTERNAL_ROLLUPWORKER_HPP
+
+#include "common.hpp"
+#include "Worker.hpp"
+#include "DatabaseThread.hpp"
+#include "SqlDialect.hpp"
+
+#include <QDateTime>
+
+namespace cutehmi {
+namespace stupid {
+namespace internal {
+
+/**
+ * Rollup worker. Maintains per-minute, per-hour and per-day rollups of @a ds18b20_history table. Each rollup table
+ * stores minimal, maximal and summed temperature along with number of samples for each device and bucket, so average
+ * temperature can be obtained as @a sum_temperature / @a samples. Rollup tables are created, if they do not exist.
+ *
+ * Rollups are maintained incrementally for each device. Processed timestamp of a device is derived from data - it is the
+ * most recent timestamp of the device at the time of the run, so rollups do not depend on the clocks of the client and
+ * the database server. Each run aggregates again whole buckets, which contain rows up to OVERLAP milliseconds older than
+ * processed timestamp, and replaces them, so that rows committed out of order are picked up. Rows inserted with timestamps
+ * older than that are not reflected by rollups.
+ *
+ * History is processed in slices of at most SLICE milliseconds, each in its own transaction, so that the first run over
+ * existing history does not issue a single statement aggregating all of it and the job can be cancelled between slices.
+ */
+class RollupWorker:
+	public Worker
+{
+	public:
+		enum rollup_t {
+			MINUTE_ROLLUP,
+			HOUR_ROLLUP,
+			DAY_ROLLUP,
+			ROLLUPS_COUNT
+		};
+
+		struct Rollup
+		{
+			const char * name;	///< Rollup name, which is also date_trunc() field.
+			const char * table;	///< Table name.
+			qint64 width;		///< Bucket width [ms].
+		};
+
+		static constexpr int OVERLAP = 10000;	///< Rows up to OVERLAP milliseconds older than processed timestamp are aggregated again.
+
+		static constexpr int SLICE = 7 * 24 * 3600000;	///< Maximal time span [ms] aggregated by a single statement.
+
+		/**
+		 * Get rollup description.
+		 * @param rollup rollup.
+		 * @return rollup description.
+		 */
+		static const Rollup & Get(rollup_t rollup);
+
+		/**
+		 * Get coarsest rollup, which provides at least one sample per bucket.
+		 * @param bucketWidth bucket width [ms].
+		 * @return coarsest rollup, whose width does not exceed @a bucketWidth or @p nullptr, if there is no such rollup.
+		 */
+		static const Rollup * Coarsest(qint64 bucketWidth);
+
+		RollupWorker(DatabaseThread & thread);
+
+		/**
+		 * Destructor. Job is cancelled and destructor waits until it finishes, so that job does not access members of
+		 * destroyed object.
+		 */
+		~RollupWorker() override;
+
+	protected:
+		void job(const Executor::CancellationToken & token) override;
+
+	private:
+		bool createTables();
+
+		/**
+		 * Update rollup of a device.
+		 * @param rollup rollup.
+		 * @param deviceId database identifier of the device.
+		 * @param from beginning of the time range to aggregate. Time range is extended to the beginning of the bucket, which
+		 * contains @a from.
+		 * @param to end of the time range to aggregate. It becomes processed timestamp of the device.
+		 * @return @p true on success, @p false otherwise.
+		 */
+		bool update(const Rollup & rollup, int deviceId, const QDateTime & from, const QDateTime & to);
+
+		struct Members
+		{
+			QString connectionName;
+			SqlDialect dialect;
+			bool tablesCreated;
+		};
+
+		utils::MPtr<Members> m;
+};
+
+}
+}
+}
+
+#endif
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
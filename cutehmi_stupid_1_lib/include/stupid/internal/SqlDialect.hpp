@@ -0,0 +1,119 @@
+#ifndef CUTEHMI_CUTEHMI__STUPID__1__LIB_INCLUDE_STUPID_INTERNAL_SQLDIALECT_HPP
+#define CUTEHMI_CUTEHMI__STUPID__1__LIB_INCLUDE_STUPID_INTERNAL_SQLDIALECT_HPP
+
+#include "common.hpp"
+
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QDateTime>
+
+class QSqlQuery;
+
+namespace cutehmi {
+namespace stupid {
+namespace internal {
+
+/**
+ * SQL dialect. Provides SQL fragments, which differ between supported database management systems, so that same
+ * queries can be run against PostgreSQL and SQLite.
+ *
+ * SQLite stores timestamps as text in local time. Timestamps are kept in a single format (YYYY-MM-DDTHH:MM:SS.SSS),
+ * thus textual comparison of timestamps is equivalent to chronological one. Values bound to queries are formatted with
+ * timestampValue() and tables created by DatabaseThread normalize timestamps written in other formats with triggers.
+ * SQLite 3.25 or newer is required for window functions and upserts.
+ */
+class SqlDialect
+{
+	public:
+		enum dbms_t {
+			POSTGRESQL,
+			SQLITE
+		};
+
+		/**
+		 * Get dialect for a Qt SQL driver.
+		 * @param driverType driver type (e.g. "QPSQL", "QSQLITE").
+		 * @return dialect.
+		 */
+		static SqlDialect ForDriver(const QString & driverType);
+
+		explicit SqlDialect(dbms_t dbms = POSTGRESQL);
+
+		dbms_t dbms() const;
+
+		/**
+		 * Membership test. Values have to be bound with bindList().
+		 * @param expr tested expression.
+		 * @param list name of the placeholder of list of values.
+		 * @param count number of values.
+		 * @param integers whether list contains integers or strings.
+		 * @return condition, which is true if @a expr is one of the values of @a list.
+		 */
+		QString in(const QString & expr, const QString & list, int count, bool integers = true) const;
+
+		/**
+		 * Bind list of values. PostgreSQL receives whole list as a single parameter, so that the statement does not depend
+		 * on number of values. SQLite receives each value as a separate parameter, so that it can use an index on tested
+		 * expression.
+		 * @param query query prepared with condition returned by in().
+		 * @param list name of the placeholder of list of values.
+		 * @param values values. Number of values must match @a count passed to in().
+		 * @param integers whether list contains integers or strings.
+		 */
+		void bindList(QSqlQuery & query, const QString & list, const QStringList & values, bool integers = true) const;
+
+		/**
+		 * Get timestamp value, which can be bound to a query.
+		 * @param dateTime date and time.
+		 * @return value of @a dateTime in a format expected by the database.
+		 */
+		QVariant timestampValue(const QDateTime & dateTime) const;
+
+		/**
+		 * Bucket index.
+		 * @param timestamp timestamp expression.
+		 * @param from timestamp expression denoting beginning of first bucket.
+		 * @param width expression denoting bucket width [ms].
+		 * @return expression evaluating to index of bucket to which @a timestamp belongs. Timestamp must not be older than
+		 * @a from.
+		 */
+		QString bucketIndex(const QString & timestamp, const QString & from, const QString & width) const;
+
+		/**
+		 * Truncate timestamp.
+		 * @param unit unit ("minute", "hour" or "day").
+		 * @param timestamp timestamp expression.
+		 * @return expression evaluating to timestamp truncated to specified precision.
+		 */
+		QString truncate(const QString & unit, const QString & timestamp) const;
+
+		/**
+		 * Timestamp conversion.
+		 * @param expr expression (e.g. placeholder of bound QDateTime value).
+		 * @return expression evaluating to timestamp, which can be passed to functions such as truncate().
+		 */
+		QString timestamp(const QString & expr) const;
+
+		QString greatest(const QString & expr1, const QString & expr2) const;
+
+		QString least(const QString & expr1, const QString & expr2) const;
+
+		/**
+		 * Get timestamp, which precedes all other timestamps.
+		 * @return literal.
+		 */
+		QString minTimestamp() const;
+
+	private:
+		dbms_t m_dbms;
+};
+
+}
+}
+}
+
+#endif
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
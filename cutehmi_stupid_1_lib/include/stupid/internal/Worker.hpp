@@ -2,21 +2,19 @@
 #define CUTEHMI_CUTEHMI__STUPID__1__LIB_INCLUDE_STUPID_INTERNAL_WORKER_HPP
 
 #include "common.hpp"
+#include "Executor.hpp"
+#include "DatabaseThread.hpp"
 
 #include <QObject>
-#include <QEvent>
 #include <QMutex>
-#include <QWaitCondition>
-#include <QThread>
-
-#include <functional>
 
 namespace cutehmi {
 namespace stupid {
 namespace internal {
 
 /**
- * Worker. This class acts as a container that allows specified code to be run in a specified thread.
+ * Worker. This class acts as a container that allows reimplemented job() to be run repeatedly by the executor of specified
+ * database thread. Worker object itself stays in the thread, which it has been created in.
  */
 class Worker:
 	public QObject
@@ -27,33 +25,17 @@ class Worker:
 
 	public:
 		/**
-		 * Default constructor.
-		 * @param task task function. See job().
-		 */
-		Worker(std::function<void()> task = nullptr);
-
-		/**
-		 * Constructor. This constructors acts as if employ(@a thread, false) was called immediately after
-		 * constructing default worker object.
+		 * Constructor.
 		 * @param thread thread in which worker's job should be run.
+		 * @param priority priority of worker's jobs.
 		 */
-		Worker(QThread & thread);
-
-		~Worker() override;
+		Worker(DatabaseThread & thread, Executor::priority_t priority = Executor::NORMAL_PRIORITY);
 
 		/**
-		 * Set task.
-		 * @param task task function. See job().
+		 * Destructor. Job may access members of derived class, therefore derived class must cancel the job and wait until
+		 * it finishes in its own destructor.
 		 */
-		void setTask(std::function<void()> task);
-
-		/**
-		 * Worker's job. This function is called when worker receives WorkEvent. Use employ() function to
-		 * run job in a specified thread. This function can be reimplemented. Default implementation calls
-		 * @a task function (it can be passed to the constructor or set via setTask()), if it has been set.
-		 * Default implementation does nothing if @a task has not been set (i.e. @a task = @p nullptr).
-		 */
-		virtual void job();
+		~Worker() override;
 
 		/**
 		 * Wait for the worker. Causes calling thread to wait until worker finishes its job. Function
@@ -74,75 +56,66 @@ class Worker:
 
 		/**
 		 * Check if worker is working.
-		 * @return @p true if worker is processing its job, @p false otherwise.
+		 * @return @p true if job is queued or it is being processed, @p false otherwise.
 		 *
 		 * @threadsafe
 		 */
 		bool isWorking() const;
 
 		/**
-		 * Employ worker. Employs worker in another thread. Internally this function moves worker object
-		 * to the specified thread. This function imposes same restrictions as QObject::moveToThread().
-		 * @param thread thread in which worker's job should be run.
-		 * @param if start is set to @p true, then work() is called immediately.
+		 * Check if job has been cancelled.
+		 * @return @p true if cancellation of most recent job has been requested, @p false otherwise.
+		 *
+		 * @threadsafe
 		 */
-		void employ(QThread & thread, bool start = true);
+		bool isCancelled() const;
 
 		/**
-		 * Work. This function posts WorkEvent, which tells worker to process the job() inside the thread in which it is employed.
+		 * Work. This function submits job() to the executor of the thread in which worker is employed. If previous job is
+		 * still queued, it is replaced by the new one. If previous job is being processed, it is cancelled.
+		 *
+		 * @warning parameters of the job should not be altered while worker is working.
 		 *
 		 * @threadsafe
 		 */
 		void work();
 
-	protected:
-		enum class State {
-			UNEMPLOYED,
-			EMPLOYED,
-			WORKING,
-			READY
-		};
-
 		/**
-		 * Work event. This class is provided to interact with AbstractWorker through Qt event system.
+		 * Cancel job.
+		 *
+		 * @threadsafe
 		 */
-		class WorkEvent:
-				public QEvent
-		{
-			public:
-				/**
-				 * Registered event type.
-				 * @return value of a QEvent::Type registered for events of this class.
-				 */
-				static Type RegisteredType() noexcept;
-
-			public:
-				/**
-				 * Default constructor.
-				 */
-				WorkEvent();
-		};
-
-		bool event(QEvent * event) override;
+		void cancel();
 
 	signals:
 		/**
-		 * Results are ready. This signal is emitted when the job() has been completed and the results are ready.
+		 * Results are ready. This signal is emitted from within thread in which worker lives, when most recent job has
+		 * been completed or cancelled and the results are ready.
 		 */
 		void ready();
 
+	protected:
+		/**
+		 * Worker's job. This function is called from within database thread, once work() has been called.
+		 * @param token cancellation token. Job should return as soon as possible, once cancellation has been requested.
+		 */
+		virtual void job(const Executor::CancellationToken & token) = 0;
+
 	private:
 		struct Members
 		{
-			State state;
-			std::function<void()> task;
-			mutable QMutex stateMutex;
-			mutable QWaitCondition waitCondition;
-			mutable QMutex workMutex;
-
-			Members(std::function<void()> p_task):
-				state(State::UNEMPLOYED),
-				task(p_task)
+			DatabaseThread * thread;
+			Executor::priority_t priority;
+			QString key;
+			Executor::Future future;
+			int serial;
+			mutable QMutex futureMutex;
+
+			Members(DatabaseThread * p_thread, Executor::priority_t p_priority, const QString & p_key):
+				thread(p_thread),
+				priority(p_priority),
+				key(p_key),
+				serial(0)
 			{
 			}
 		};
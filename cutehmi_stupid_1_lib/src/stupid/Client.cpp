@@ -1,10 +1,13 @@
 #include "../../include/stupid/Client.hpp"
 #include "../../include/stupid/internal/functions.hpp"
+#include "../../include/stupid/internal/SqlDialect.hpp"
 
 #include <QtConcurrent>
 #include <QSqlQuery>
 #include <QSqlDatabase>
 
+#include <limits>
+
 namespace cutehmi {
 namespace stupid {
 
@@ -13,7 +16,9 @@ Client::Client(QObject * parent):
 	m(new Members)
 {
 	// Forward database errors.
-	QObject::connect(& m->dbThread, & internal::DatabaseThread::error, this, & Client::error);
+	QObject::connect(& m->dbPool, & internal::DatabasePool::error, this, & Client::error);
+	// Notifications are handled directly in database thread.
+	QObject::connect(& m->dbPool.liveThread(), & internal::DatabaseThread::notified, this, & Client::storeNotification, Qt::DirectConnection);
 }
 
 Client::~Client()
@@ -49,15 +54,55 @@ bool Client::isDisconnected() const
 
 void Client::moveDatabaseConnectionData(std::unique_ptr<stupid::DatabaseConnectionData> dbData)
 {
-	m->dbThread.moveDatabaseConnectionData(std::move(dbData));
+	m->dbPool.moveDatabaseConnectionData(std::move(dbData));
 }
 
 void Client::checkDatabaseConnectionStatus()
 {
-	m->sqlErrors.push_back(QSqlDatabase::database(m->dbThread.dbData()->connectionName, false).lastError());
+	m->sqlErrors.push_back(QSqlDatabase::database(m->dbPool.dbData()->connectionName, false).lastError());
 	processSQLErrors();
 }
 
+void Client::setNotificationChannel(const QString & channel)
+{
+	m->dbPool.liveThread().setNotificationChannel(channel);
+}
+
+QString Client::notificationChannel() const
+{
+	return m->dbPool.liveThread().notificationChannel();
+}
+
+void Client::setHistoryConnections(int count)
+{
+	m->dbPool.setLaneSize(internal::DatabasePool::HISTORY_LANE, count);
+}
+
+int Client::historyConnections() const
+{
+	return m->dbPool.laneSize(internal::DatabasePool::HISTORY_LANE);
+}
+
+void Client::setBackgroundConnections(int count)
+{
+	m->dbPool.setLaneSize(internal::DatabasePool::BACKGROUND_LANE, count);
+}
+
+int Client::backgroundConnections() const
+{
+	return m->dbPool.laneSize(internal::DatabasePool::BACKGROUND_LANE);
+}
+
+void Client::setRollupsEnabled(bool enabled)
+{
+	m->rollupsEnabled = enabled;
+}
+
+bool Client::rollupsEnabled() const
+{
+	return m->rollupsEnabled;
+}
+
 void Client::connect()
 {
 	if (!isDisconnected()) {
@@ -65,9 +110,9 @@ void Client::connect()
 		return;
 	}
 
-	m->asyncConnector = new internal::AsyncConnector(& m->dbThread, this);
+	m->asyncConnector = new internal::AsyncConnector(& m->dbPool.liveThread(), this);
 	QObject::connect(m->asyncConnector, & internal::AsyncConnector::connected, this, & Client::asyncConnect);
-	m->dbThread.start();	// asyncConnector will respond to m->dbThread->connected() signal.
+	m->dbPool.start();	// asyncConnector will respond to live thread connected() signal.
 }
 
 void Client::disconnect()
@@ -81,10 +126,8 @@ void Client::disconnect()
 	m->asyncConnector->disconnect(this);
 	m->asyncConnector->deleteLater();
 
-	if (m->dbThread.isRunning()) {
-		m->dbThread.quit();
-		m->dbThread.wait();
-	}
+	if (m->dbPool.isRunning())
+		m->dbPool.stop();
 
 	m->asyncConnector = nullptr;
 	m->connected = false;
@@ -101,33 +144,147 @@ void Client::readAll(const QAtomicInt & run)
 		return;
 	}
 
-	internal::Worker dbWorker([this]() {
-		QSqlQuery query(QSqlDatabase::database(m->dbThread.dbData()->connectionName, false));
-		query.exec("SELECT w1_device.w1_id, w1_device.plugged, ds18b20.temperature, ds18b20.crc, ds18b20.crc_ok, ds18b20.timestamp "
-				   "FROM ds18b20 INNER JOIN w1_device ON ds18b20.w1_device_id = w1_device.id");
+	// Live data takes precedence over any other job, which may have been submitted to the live thread.
+	internal::Executor::Future readFuture = m->dbPool.liveThread().executor().submit([this](const internal::Executor::CancellationToken &) {
+		qint64 now = QDateTime::currentMSecsSinceEpoch();
+		bool fullSync = !m->lastSeen.isValid() || (now >= m->nextFullSync);
+
+		m->notifiedMutex.lock();
+		QStringList notifiedIds;
+		notifiedIds.swap(m->notifiedIds);
+		bool notifiedAll = m->notifiedAll;
+		m->notifiedAll = false;
+		m->notifiedMutex.unlock();
+
+		QSqlQuery * queryPtr;
+		internal::SqlDialect dialect = internal::SqlDialect::ForDriver(m->dbPool.dbData()->type);
+		if (!fullSync && !notifiedAll && !notifiedIds.isEmpty()) {
+			// Fetch only rows, which have been notified.
+			queryPtr = & m->dbPool.liveThread().preparedQuery(QString("SELECT ds18b20.w1_device_id, w1_device.plugged, ds18b20.temperature, ds18b20.crc, ds18b20.crc_ok, ds18b20.timestamp "
+																	  "FROM ds18b20 INNER JOIN w1_device ON ds18b20.w1_device_id = w1_device.id "
+																	  "WHERE %1").arg(dialect.in("ds18b20.w1_device_id", ":ids", notifiedIds.count())));
+			dialect.bindList(*queryPtr, ":ids", notifiedIds);
+		} else {
+			queryPtr = & m->dbPool.liveThread().preparedQuery("SELECT ds18b20.w1_device_id, w1_device.plugged, ds18b20.temperature, ds18b20.crc, ds18b20.crc_ok, ds18b20.timestamp "
+												   "FROM ds18b20 INNER JOIN w1_device ON ds18b20.w1_device_id = w1_device.id "
+												   "WHERE ds18b20.timestamp > :since");
+			queryPtr->bindValue(":since", dialect.timestampValue(fullSync ? QDateTime::fromMSecsSinceEpoch(0) : m->lastSeen.addMSecs(-DELTA_OVERLAP)));
+		}
+		// Current time is evaluated once per cycle and changes of all devices are delivered as a single batch.
+		QDateTime nowUtc = QDateTime::fromMSecsSinceEpoch(now, Qt::UTC);
+		ChangesContainer changes;
+		auto storeData = [& changes, & nowUtc](DS18B20 * sensor, const DS18B20::Data & data) {
+			bool errorChange;
+			int valueTypes = sensor->storeData(data, nowUtc, errorChange);
+			if ((valueTypes != 0) || errorChange) {
+				SensorChanges & sensorChanges = changes[sensor];
+				sensorChanges.valueTypes |= valueTypes;
+				sensorChanges.errorChange |= errorChange;
+			}
+		};
+
+		QSqlQuery & query = *queryPtr;
+		query.exec();
 		m->sqlErrors.push_back(query.lastError());
 		while (query.next()) {
-			QString w1Id = query.value(0).toString();
+			DS18B20 * sensor = m->ds18b20Registry.at(query.value(0).toInt());
+			if (sensor == nullptr)
+				continue;
+			const DS18B20::Data & current = sensor->data();
 			DS18B20::Data data;
 			data.plugged = query.value(1).toBool();
 			data.temperature = query.value(2).toLongLong();
 			data.crc = query.value(3).toInt();
 			data.crcOK = query.value(4).toBool();
 			data.timestamp = query.value(5).toDateTime();
-			if (m->ds18b20[w1Id].value<DS18B20 *>()->data().timestamp == data.timestamp)
-				data.expire = m->ds18b20[w1Id].value<DS18B20 *>()->data().expire;
-			else
-				data.expire.setMSecsSinceEpoch(QDateTime::currentDateTimeUtc().toMSecsSinceEpoch() + m->daemonSleep * EXPIRE_DAEMON_CYCLES + EXPIRE_MIN_INTERVAL);
-			m->ds18b20[w1Id].value<DS18B20 *>()->updateData(data);
+			if (!m->lastSeen.isValid() || (data.timestamp > m->lastSeen))
+				m->lastSeen = data.timestamp;
+			if (current.timestamp == data.timestamp) {
+				// Skip rows, which have not changed.
+				if ((current.plugged == data.plugged) && (current.temperature == data.temperature) && (current.crc == data.crc) && (current.crcOK == data.crcOK))
+					continue;
+				data.expire = current.expire;
+			} else {
+				data.expire.setMSecsSinceEpoch(now + m->daemonSleep * EXPIRE_DAEMON_CYCLES + EXPIRE_MIN_INTERVAL);
+				m->nextExpireCheck = qMin(m->nextExpireCheck, data.expire.toMSecsSinceEpoch());
+			}
+			storeData(sensor, data);
+		}
+		query.finish();
+		if (fullSync)
+			m->nextFullSync = now + FULL_SYNC_INTERVAL;
+
+		// Sensors, which are not updated, are not present in delta results, so their expiration has to be checked separately.
+		if (now >= m->nextExpireCheck) {
+			m->nextExpireCheck = std::numeric_limits<qint64>::max();
+			for (DS18B20 * sensor : m->ds18b20Registry.sensors()) {
+				qint64 expire = sensor->data().expire.toMSecsSinceEpoch();
+				if (expire <= now) {
+					if (!(sensor->error() & DS18B20::ERROR_DATA_STALL))
+						storeData(sensor, sensor->data());
+				} else
+					m->nextExpireCheck = qMin(m->nextExpireCheck, expire);
+			}
 		}
-	});
-	dbWorker.employ(m->dbThread);
-	dbWorker.wait();
+
+		postChanges(changes);
+	}, internal::Executor::HIGH_PRIORITY);
+	readFuture.wait();
 	processSQLErrors();
+
+	if (m->rollupWorker && !m->rollupWorker->isWorking()) {
+		qint64 now = QDateTime::currentMSecsSinceEpoch();
+		if (now >= m->nextRollup) {
+			m->nextRollup = now + ROLLUP_INTERVAL;
+			m->rollupWorker->work();
+		}
+	}
+}
+
+bool Client::requestHistoryUpdate(const QStringList & w1Ids, qint64 from, qint64 to, int buckets)
+{
+	if (!m->historyBatchWorker) {
+		CUTEHMI_STUPID_QDEBUG("History update request rejected - client is not connected.");
+		return false;
+	}
+	if (m->historyBatchWorker->isWorking() || !m->batchHistories.isEmpty()) {
+		CUTEHMI_STUPID_QDEBUG("History update request rejected - worker has not finished its previous job yet.");
+		return false;
+	}
+
+	// Each device is fetched only over its own missing ranges, but ranges of all devices are fetched with a single query.
+	internal::DS18B20HistoryBatchWorker::RangesContainer fetchRanges;
+	for (const QString & w1Id : w1Ids) {
+		DS18B20History * history = m->ds18b20History.value(w1Id).value<DS18B20History *>();
+		if (history == nullptr)
+			continue;
+		if (history->updating()) {
+			CUTEHMI_STUPID_QDEBUG("History of device '" << w1Id << "' is being updated already.");
+			continue;
+		}
+		history->setFrom(from);
+		history->setTo(to);
+		history->setBuckets(buckets);
+		internal::HistoryCache::RangesContainer ranges = history->beginUpdate();
+		if (ranges.isEmpty())
+			continue;
+		fetchRanges.insert(w1Id, ranges);
+		m->batchHistories.append(history);
+	}
+
+	if (!fetchRanges.isEmpty()) {
+		m->historyBatchWorker->setRanges(fetchRanges);
+		m->historyBatchWorker->setBucketWidth(internal::HistoryCache::BucketWidth(m->batchHistories.first()->requestLevel()));
+		m->historyBatchWorker->work();
+	}
+	return true;
 }
 
 constexpr int Client::EXPIRE_DAEMON_CYCLES;
 constexpr int Client::EXPIRE_MIN_INTERVAL;
+constexpr int Client::DELTA_OVERLAP;
+constexpr int Client::FULL_SYNC_INTERVAL;
+constexpr int Client::ROLLUP_INTERVAL;
 
 void Client::asyncConnect(QObject * connector)
 {
@@ -137,16 +294,49 @@ void Client::asyncConnect(QObject * connector)
 	}
 
 	m->daemonSleep = m->asyncConnector->daemonSleep();
-	for (QStringList::const_iterator w1Id = m->asyncConnector->w1Ids().begin(); w1Id != m->asyncConnector->w1Ids().end(); ++w1Id) {
-		m->ds18b20.insert(*w1Id, QVariant::fromValue(new DS18B20));
-		std::unique_ptr<internal::DS18B20HistoryWorker> worker(new internal::DS18B20HistoryWorker(m->dbThread, *w1Id));
-		m->ds18b20History.insert(*w1Id, QVariant::fromValue(new DS18B20History(std::move(worker))));
+	for (int i = 0; i < m->asyncConnector->w1Ids().count(); i++) {
+		const QString & w1Id = m->asyncConnector->w1Ids().at(i);
+		DS18B20 * sensor = new DS18B20;
+		m->ds18b20Registry.insert(m->asyncConnector->deviceIds().at(i), sensor);
+		m->ds18b20.insert(w1Id, QVariant::fromValue(sensor));
+		std::unique_ptr<internal::DS18B20HistoryWorker> worker(new internal::DS18B20HistoryWorker(m->dbPool.thread(internal::DatabasePool::HISTORY_LANE), w1Id));
+		worker->setRollupsEnabled(m->rollupsEnabled);
+		DS18B20History * history = new DS18B20History(std::move(worker), & m->historyCache);
+		internal::AsyncConnector::HistoryRangesContainer::const_iterator range = m->asyncConnector->historyRanges().constFind(w1Id);
+		if (range != m->asyncConnector->historyRanges().constEnd())
+			history->updateRange(range->first, range->second);
+		m->ds18b20History.insert(w1Id, QVariant::fromValue(history));
 	}
+	m->historyBatchWorker.reset(new internal::DS18B20HistoryBatchWorker(m->dbPool.thread(internal::DatabasePool::HISTORY_LANE)));
+	QObject::connect(m->historyBatchWorker.get(), & internal::DS18B20HistoryBatchWorker::ready, this, & Client::updateHistories);
+	if (m->rollupsEnabled)
+		m->rollupWorker.reset(new internal::RollupWorker(m->dbPool.thread(internal::DatabasePool::BACKGROUND_LANE)));
 	CUTEHMI_STUPID_QDEBUG("Connection has been established.");
 	m->connected = true;
 	emit connected();
 }
 
+void Client::storeNotification(const QVariant & payload)
+{
+	QStringList ids = payload.toString().split(',', QString::SkipEmptyParts);
+	bool valid = !ids.isEmpty();
+	for (QStringList::iterator it = ids.begin(); valid && it != ids.end(); ++it) {
+		*it = it->trimmed();
+		it->toInt(& valid);
+	}
+
+	m->notifiedMutex.lock();
+	if (valid) {
+		for (const QString & id : ids)
+			if (!m->notifiedIds.contains(id))
+				m->notifiedIds.append(id);
+	} else
+		m->notifiedAll = true;
+	m->notifiedMutex.unlock();
+
+	emit changesNotified();
+}
+
 void Client::processSQLErrors()
 {
 	for (SQLErrorsContainer::iterator it = m->sqlErrors.begin(); it != m->sqlErrors.end(); ++it)
@@ -155,14 +345,82 @@ void Client::processSQLErrors()
 	m->sqlErrors.clear();
 }
 
+void Client::updateHistories()
+{
+	const internal::DS18B20HistoryBatchWorker::ResultsContainer & results = m->historyBatchWorker->results();
+	for (DS18B20History * history : m->batchHistories) {
+		internal::DS18B20HistoryBatchWorker::ResultsContainer::const_iterator it = results.constFind(history->w1Id());
+		if (it != results.constEnd())
+			history->finishUpdate(*it);
+		else
+			history->finishUpdate(internal::DS18B20HistoryWorker::Results{history->minimum(), history->maximum(), {}});
+	}
+	m->batchHistories.clear();
+}
+
+void Client::deliverChanges()
+{
+	ChangesContainer changes;
+	m->changesMutex.lock();
+	changes.swap(m->pendingChanges);
+	m->changesMutex.unlock();
+
+	for (ChangesContainer::const_iterator it = changes.constBegin(); it != changes.constEnd(); ++it)
+		it.key()->notifyChanges(it.value().valueTypes, it.value().errorChange);
+
+	if (!changes.isEmpty())
+		emit changesDelivered();
+}
+
+void Client::postChanges(const ChangesContainer & changes)
+{
+	if (changes.isEmpty())
+		return;
+
+	// Changes are merged with those, which have not been delivered yet, so that at most one delivery is queued at a time.
+	m->changesMutex.lock();
+	bool queued = !m->pendingChanges.isEmpty();
+	for (ChangesContainer::const_iterator it = changes.constBegin(); it != changes.constEnd(); ++it) {
+		SensorChanges & pending = m->pendingChanges[it.key()];
+		pending.valueTypes |= it.value().valueTypes;
+		pending.errorChange |= it.value().errorChange;
+	}
+	m->changesMutex.unlock();
+
+	if (!queued)
+		QMetaObject::invokeMethod(this, "deliverChanges", Qt::QueuedConnection);
+}
+
 void Client::clearDevices()
 {
-	for (QVariantMap::iterator it = m->ds18b20.begin(); it != m->ds18b20.end(); ++it)
-		delete it.value().value<DS18B20 *>();
+	if (m->historyBatchWorker) {
+		m->historyBatchWorker->wait();
+		m->historyBatchWorker.reset();
+	}
+	m->batchHistories.clear();
+	if (m->rollupWorker) {
+		m->rollupWorker->wait();
+		m->rollupWorker.reset();
+	}
+	m->nextRollup = 0;
+	for (DS18B20 * sensor : m->ds18b20Registry.sensors())
+		delete sensor;
+	m->ds18b20Registry.clear();
 	m->ds18b20.clear();
 	for (QVariantMap::iterator it = m->ds18b20History.begin(); it != m->ds18b20History.end(); ++it)
 		delete it.value().value<DS18B20History *>();
 	m->ds18b20History.clear();
+	m->historyCache.clear();
+	m->lastSeen = QDateTime();
+	m->nextFullSync = 0;
+	m->nextExpireCheck = 0;
+	m->notifiedMutex.lock();
+	m->notifiedIds.clear();
+	m->notifiedAll = false;
+	m->notifiedMutex.unlock();
+	m->changesMutex.lock();
+	m->pendingChanges.clear();
+	m->changesMutex.unlock();
 }
 
 }
@@ -78,25 +78,50 @@ const DS18B20::Data & DS18B20::data() const
 	return m->data;
 }
 
-void DS18B20::updateData(const Data & data)
+int DS18B20::storeData(const Data & data, const QDateTime & now, bool & errorChange)
 {
 	int error = ERROR_OK;
 	if (!data.crcOK)
 		error |= ERROR_WRONG_CRC;
 	if (!data.plugged)
 		error |= ERROR_UNPLUGGED;
-	if (data.expire < QDateTime::currentDateTimeUtc())
+	if (data.expire <= now)
 		error |= ERROR_DATA_STALL;
 
+	int valueTypes = 0;
 	m->dataLock.lockForWrite();
+	if (m->data.plugged != data.plugged)
+		valueTypes |= PLUGGED;
+	if (m->data.temperature != data.temperature)
+		valueTypes |= TEMPERATURE;
+	if (m->data.crc != data.crc)
+		valueTypes |= CRC;
+	if (m->data.crcOK != data.crcOK)
+		valueTypes |= CRC_OK;
+	if (m->data.timestamp != data.timestamp)
+		valueTypes |= TIMESTAMP;
+	if (m->data.expire != data.expire)
+		valueTypes |= EXPIRE;
 	m->data = data;
 	m->dataLock.unlock();
-	emit valueUpdated(PLUGGED | TEMPERATURE | CRC | CRC_OK | TIMESTAMP | EXPIRE);
 
-	if (error != m->error.load()) {
-		m->error.store(error);
+	errorChange = m->error.fetchAndStoreOrdered(error) != error;
+	return valueTypes;
+}
+
+void DS18B20::notifyChanges(int valueTypes, bool errorChange)
+{
+	if (valueTypes != 0)
+		emit valueUpdated(valueTypes);
+	if (errorChange)
 		emit errorChanged();
-	}
+}
+
+void DS18B20::updateData(const Data & data)
+{
+	bool errorChange;
+	int valueTypes = storeData(data, QDateTime::currentDateTimeUtc(), errorChange);
+	notifyChanges(valueTypes, errorChange);
 }
 
 }
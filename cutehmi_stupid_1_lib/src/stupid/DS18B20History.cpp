@@ -2,26 +2,44 @@
 
 #include <QtDebug>
 
+#include <algorithm>
+
 namespace cutehmi {
 namespace stupid {
 
-DS18B20History::DS18B20History(std::unique_ptr<internal::DS18B20HistoryWorker> worker, QObject * parent):
+namespace {
+
+/**
+ * Find first point, which is not placed before given x coordinate.
+ * @param data points ordered by x coordinate.
+ * @param x x coordinate.
+ * @return index of first point, whose x coordinate is not less than @a x.
+ */
+int LowerBound(const charts::PointSeries::DataContainer & data, qreal x)
+{
+	return static_cast<int>(std::lower_bound(data.begin(), data.end(), x, [](const QPointF & point, qreal x) {
+		return point.x() < x;
+	}) - data.begin());
+}
+
+}
+
+DS18B20History::DS18B20History(std::unique_ptr<internal::DS18B20HistoryWorker> worker, internal::HistoryCache * cache, QObject * parent):
 	QObject(parent),
-	m(new Members{std::move(worker), new charts::PointSeries(this), 0, 0, 0, 0, false})
+	m(new Members{std::move(worker), new charts::PointSeries(this), 0, 0, 0, 0, false, 0, cache, internal::HistoryCache::RAW_LEVEL, 0, 0, 0, false, false})
 {
 	if (m->worker) {
-		m->worker->work();
-		m->worker->wait();
-		m->minimum = m->worker->results().minimum;
-		m->maximum = m->worker->results().maximum;
 		connect(m->worker.get(), & internal::DS18B20HistoryWorker::ready, this, & DS18B20History::update);
+		connect(m->worker.get(), & internal::DS18B20HistoryWorker::chunkFetched, this, & DS18B20History::appendChunk);
 	}
 }
 
 DS18B20History::~DS18B20History()
 {
-	if (m->worker)
+	if (m->worker) {
+		m->worker->cancel();
 		m->worker->wait();
+	}
 }
 
 charts::PointSeries * DS18B20History::series() const
@@ -65,22 +83,51 @@ qint64 DS18B20History::maximum() const
 	return m->maximum;
 }
 
+void DS18B20History::updateRange(qint64 minimum, qint64 maximum)
+{
+	if (m->minimum != minimum) {
+		m->minimum = minimum;
+		emit minimumChanged();
+	}
+	if (m->maximum != maximum) {
+		m->maximum = maximum;
+		emit maximumChanged();
+	}
+}
+
 bool DS18B20History::updating() const
 {
 	return m->updating;
 }
 
+int DS18B20History::buckets() const
+{
+	return m->buckets;
+}
+
+void DS18B20History::setBuckets(int buckets)
+{
+	if (m->buckets != buckets) {
+		m->buckets = buckets;
+		emit bucketsChanged();
+	}
+}
+
 bool DS18B20History::requestUpdate()
 {
 	if (m->worker) {
-		if (m->worker->isWorking()) {
-			CUTEHMI_STUPID_QDEBUG("Update request rejected - worker has not finished its previous job yet.");
+		if (m->fetching) {
+			// Stop fetching data, which is no longer needed. New request is issued, once worker finishes. Pending job is
+			// cancelled immediately, so flag has to be set first.
+			CUTEHMI_STUPID_QDEBUG("Request in progress has been superseded.");
+			m->superseded = true;
+			m->worker->cancel();
+			return true;
+		} else if (m->updating) {
+			CUTEHMI_STUPID_QDEBUG("Update request rejected - history is being updated by batched request.");
 			return false;
 		} else {
-			setUpdating(true);
-			m->worker->setFrom(from());
-			m->worker->setTo(to());
-			m->worker->work();
+			startUpdate();
 			return true;
 		}
 	} else {
@@ -91,16 +138,110 @@ bool DS18B20History::requestUpdate()
 
 void DS18B20History::update()
 {
-	const internal::DS18B20HistoryWorker::Results & results = m->worker->results();
-	if (m->minimum != results.minimum) {
-		m->minimum = results.minimum;
-		emit minimumChanged();
+	m->fetching = false;
+	if (m->worker->isCancelled()) {
+		// Data of cancelled request is incomplete, so it is not passed to the cache.
+		setUpdating(false);
+		if (m->superseded) {
+			m->superseded = false;
+			startUpdate();
+		}
+		return;
 	}
-	if (m->maximum != results.maximum) {
-		m->maximum = results.maximum;
-		emit maximumChanged();
+
+	// Fetched data has been already inserted into the series, so data of segments is cut out of it.
+	internal::DS18B20HistoryWorker::Results results = m->worker->results();
+	const charts::PointSeries::DataContainer & data = m->series->data();
+	for (internal::DS18B20HistoryWorker::Segment & segment : results.segments) {
+		int first = LowerBound(data, segment.from);
+		// Timestamps are whole milliseconds.
+		segment.data = data.mid(first, LowerBound(data, segment.to + 1) - first);
+	}
+	finishUpdate(results);
+}
+
+void DS18B20History::appendChunk(int serial, int segment, const charts::PointSeries::DataContainer & chunk)
+{
+	Q_UNUSED(segment)
+
+	// Ignore chunks of cancelled requests, which may still be queued.
+	if ((serial != m->serial) || m->worker->isCancelled() || chunk.isEmpty())
+		return;
+
+	// Segments may be fetched before or between cached data, so chunk is inserted at its position in the series.
+	m->series->insert(LowerBound(m->series->data(), chunk.first().x()), chunk);
+}
+
+const QString & DS18B20History::w1Id() const
+{
+	return m->worker->w1Id();
+}
+
+int DS18B20History::requestLevel() const
+{
+	return m->requestLevel;
+}
+
+internal::HistoryCache::RangesContainer DS18B20History::beginUpdate()
+{
+	m->requestLevel = internal::HistoryCache::Level(from(), to(), buckets());
+	m->requestFrom = from();
+	m->requestTo = to();
+	internal::HistoryCache::RangesContainer ranges;
+	if (m->cache) {
+		ranges = m->cache->missing(m->worker->w1Id(), m->requestLevel, m->requestFrom, m->requestTo);
+		// Cached part of the window is displayed immediately, missing parts are inserted, as they arrive. Ranges of
+		// downsampled levels are extended to whole buckets, so cached points, which are going to be fetched again, are
+		// left out to avoid duplicates.
+		charts::PointSeries::DataContainer cached = m->cache->data(m->worker->w1Id(), m->requestLevel, m->requestFrom, m->requestTo);
+		charts::PointSeries::DataContainer data;
+		data.reserve(cached.count());
+		internal::HistoryCache::RangesContainer::const_iterator range = ranges.constBegin();
+		for (const QPointF & point : cached) {
+			while ((range != ranges.constEnd()) && (range->second < point.x()))
+				++range;
+			if ((range == ranges.constEnd()) || (point.x() < range->first))
+				data.append(point);
+		}
+		m->series->setData(data);
+		if (ranges.isEmpty())
+			return ranges;
+	} else {
+		ranges.append(internal::HistoryCache::Range(m->requestFrom, m->requestTo));
+		m->series->setData(charts::PointSeries::DataContainer());
+	}
+	setUpdating(true);
+	return ranges;
+}
+
+void DS18B20History::startUpdate()
+{
+	internal::HistoryCache::RangesContainer ranges = beginUpdate();
+	if (!ranges.isEmpty()) {
+		m->serial++;
+		m->fetching = true;
+		m->worker->setSerial(m->serial);
+		m->worker->setRanges(ranges);
+		m->worker->setBucketWidth(internal::HistoryCache::BucketWidth(m->requestLevel));
+		m->worker->work();
+	}
+}
+
+void DS18B20History::finishUpdate(const internal::DS18B20HistoryWorker::Results & results)
+{
+	updateRange(results.minimum, results.maximum);
+	if (m->cache) {
+		for (const internal::DS18B20HistoryWorker::Segment & segment : results.segments)
+			// Samples newer than most recent one may still arrive, so the range past it is not cached.
+			if (segment.from <= results.maximum)
+				m->cache->insert(m->worker->w1Id(), m->requestLevel, segment.from, qMin(segment.to, results.maximum), segment.data);
+		m->series->setData(m->cache->data(m->worker->w1Id(), m->requestLevel, m->requestFrom, m->requestTo));
+	} else {
+		charts::PointSeries::DataContainer data;
+		for (const internal::DS18B20HistoryWorker::Segment & segment : results.segments)
+			data << segment.data;
+		m->series->setData(data);
 	}
-	m->series->setData(results.data);
 	setUpdating(false);
 }
 
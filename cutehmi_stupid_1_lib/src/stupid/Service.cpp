@@ -9,11 +9,14 @@ namespace stupid {
 
 Service::Service(const QString & name, Client * client, QObject * parent):
 	services::Service(name, parent),
-	m(new Members{std::unique_ptr<internal::CommunicationThread>(new internal::CommunicationThread(client)), client})
+	m(new Members{std::unique_ptr<internal::CommunicationThread>(new internal::CommunicationThread(client)), client, QElapsedTimer(), false})
 {
 	QObject::connect(m->client, & Client::error, this, & Service::handleError);
 	QObject::connect(m->client, & Client::connected, this, & Service::onClientConnected);
 	QObject::connect(m->client, & Client::disconnected, this, & Service::onClientDisconnected);
+	QObject::connect(m->client, & Client::changesDelivered, this, & Service::onClientChangesDelivered);
+	// Database notifications start next cycle without waiting for sleep interval to elapse.
+	QObject::connect(m->client, & Client::changesNotified, m->thread.get(), & internal::CommunicationThread::wake, Qt::DirectConnection);
 }
 
 Service::~Service()
@@ -35,6 +38,9 @@ void Service::setSleep(unsigned long sleep)
 Service::state_t Service::customStart()
 {
 	setState(STARTING);
+	// Startup is measured up to the moment, when first values are delivered, since this is what user is waiting for.
+	m->startElapsed.start();
+	m->firstValuesPending = true;
 	m->client->connect();	// onClientConnected() is connected to m->client->connected() signal.
 	return state();
 }
@@ -48,6 +54,7 @@ Service::state_t Service::customStop()
 		m->thread->wait();
 		CUTEHMI_STUPID_QDEBUG("STUPiD client thread finished.");
 	}
+	m->firstValuesPending = false;
 	setState(STOPPING);
 	m->client->disconnect();
 	return state();
@@ -55,6 +62,7 @@ Service::state_t Service::customStop()
 
 void Service::onClientConnected()
 {
+	CUTEHMI_STUPID_QDEBUG("STUPiD client connected in " << m->startElapsed.elapsed() << " ms since service start.");
 	CUTEHMI_STUPID_QDEBUG("Starting STUPiD client thread...");
 	m->thread->start();
 	setState(STARTED);
@@ -65,6 +73,15 @@ void Service::onClientDisconnected()
 	setState(STOPPED);
 }
 
+void Service::onClientChangesDelivered()
+{
+	if (!m->firstValuesPending)
+		return;
+
+	m->firstValuesPending = false;
+	CUTEHMI_STUPID_QDEBUG("First values delivered in " << m->startElapsed.elapsed() << " ms since service start.");
+}
+
 void Service::handleError(cutehmi::base::ErrorInfo errorInfo)
 {
 	base::Prompt::Critical(errorInfo);
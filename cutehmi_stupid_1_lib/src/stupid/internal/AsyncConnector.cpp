@@ -1,6 +1,7 @@
 #include "../../../include/stupid/internal/AsyncConnector.hpp"
 
 #include <QSqlQuery>
+#include <QDateTime>
 
 namespace cutehmi {
 namespace stupid {
@@ -12,9 +13,13 @@ AsyncConnector::AsyncConnector(DatabaseThread * dbThread, QObject * parent):
 	m_daemonSleep(0),
 	m_status(INIT)
 {
-	m_dbWorker.employ(*m_dbThread, false);
 	QObject::connect(m_dbThread, & DatabaseThread::connected, this, & AsyncConnector::connect);
-	QObject::connect(& m_dbWorker, & Worker::ready, this, & AsyncConnector::connect);
+}
+
+AsyncConnector::~AsyncConnector()
+{
+	m_future.cancel();
+	m_future.wait();
 }
 
 const QStringList & AsyncConnector::w1Ids() const
@@ -22,6 +27,16 @@ const QStringList & AsyncConnector::w1Ids() const
 	return m_w1Ids;
 }
 
+const QList<int> & AsyncConnector::deviceIds() const
+{
+	return m_deviceIds;
+}
+
+const AsyncConnector::HistoryRangesContainer & AsyncConnector::historyRanges() const
+{
+	return m_historyRanges;
+}
+
 unsigned long AsyncConnector::daemonSleep() const
 {
 	return m_daemonSleep;
@@ -37,30 +52,38 @@ void AsyncConnector::connect()
 	switch (m_status) {
 		case INIT:
 			CUTEHMI_STUPID_QDEBUG("Establishing connection - 'INIT'.");
-			m_status= ENUMERATE_DEVICES;
-		case ENUMERATE_DEVICES:
-			CUTEHMI_STUPID_QDEBUG("Establishing connection - 'ENUMERATE_DEVICES'.");
+			m_status= BOOTSTRAP;
+		case BOOTSTRAP:
+			CUTEHMI_STUPID_QDEBUG("Establishing connection - 'BOOTSTRAP'.");
 			// For proper thread affinity of DS18B20* objects do not create them inside m_dbThread, just store the results of a query.
-			m_dbWorker.setTask([this]() {
+			m_status= FINALIZE;
+			submit([this](const Executor::CancellationToken &) {
+				// Device list, history ranges and settings are fetched with a single statement, so that bootstrap takes one
+				// round trip regardless of the number of devices. Settings are carried by a separate row, which has no device
+				// identifier, so that they are loaded even if there are no devices. History bounds are evaluated per device with
+				// correlated subqueries, which can be answered from (w1_device_id, timestamp) index instead of aggregating
+				// whole history.
 				QSqlQuery query(QSqlDatabase::database(m_dbThread->dbData()->connectionName, false));
-				query.exec("SELECT w1_device.w1_id "
+				query.setForwardOnly(true);
+				query.exec("SELECT NULL, NULL, NULL, NULL, daemon_sleep FROM settings "
+						   "UNION ALL "
+						   "SELECT w1_device.w1_id, w1_device.id, "
+						   "(SELECT min(h.timestamp) FROM ds18b20_history h WHERE h.w1_device_id = w1_device.id), "
+						   "(SELECT max(h.timestamp) FROM ds18b20_history h WHERE h.w1_device_id = w1_device.id), "
+						   "NULL "
 						   "FROM ds18b20 INNER JOIN w1_device ON ds18b20.w1_device_id = w1_device.id");
-				while (query.next())
-					m_w1Ids.append(query.value(0).toString());
-			});
-			m_status= LOAD_DAEMON_SLEEP;
-			m_dbWorker.work();
-			break;
-		case LOAD_DAEMON_SLEEP:
-			CUTEHMI_STUPID_QDEBUG("Establishing connection - 'LOAD_DAEMON_SLEEP'.");
-			m_dbWorker.setTask([this]() {
-				QSqlQuery query(QSqlDatabase::database(m_dbThread->dbData()->connectionName, false));
-				query.exec("SELECT daemon_sleep FROM settings");
-				while (query.next())
-					m_daemonSleep = query.value(0).toLongLong();
+				while (query.next()) {
+					if (query.isNull(0)) {
+						m_daemonSleep = query.value(4).toLongLong();
+						continue;
+					}
+					QString w1Id = query.value(0).toString();
+					m_w1Ids.append(w1Id);
+					m_deviceIds.append(query.value(1).toInt());
+					if (!query.isNull(2))
+						m_historyRanges.insert(w1Id, HistoryRange(query.value(2).toDateTime().toMSecsSinceEpoch(), query.value(3).toDateTime().toMSecsSinceEpoch()));
+				}
 			});
-			m_status= FINALIZE;
-			m_dbWorker.work();
 			break;
 		case FINALIZE:
 			CUTEHMI_STUPID_QDEBUG("Establishing connection - 'FINALIZE'.");
@@ -77,6 +100,14 @@ void AsyncConnector::connect()
 
 }
 
+void AsyncConnector::submit(Executor::Task task)
+{
+	m_future = m_dbThread->executor().submit(task, Executor::HIGH_PRIORITY, QString(), this, [this](bool cancelled) {
+		if (!cancelled)
+			connect();
+	});
+}
+
 }
 }
 }
@@ -6,7 +6,7 @@ namespace stupid {
 namespace internal {
 
 CommunicationThread::CommunicationThread(Client * client):
-	m(new Members{0, 0, client})
+	m(new Members(client))
 {
 }
 
@@ -25,7 +25,12 @@ void CommunicationThread::run()
 	while (m->run.loadAcquire()) {
 		m->client->checkDatabaseConnectionStatus();
 		m->client->readAll(m->run);
-		msleep(m->sleep);
+
+		m->wakeMutex.lock();
+		if (!m->woken && m->run.loadAcquire())
+			m->wakeCondition.wait(& m->wakeMutex, m->sleep);
+		m->woken = false;
+		m->wakeMutex.unlock();
 	}
 }
 
@@ -38,6 +43,15 @@ void CommunicationThread::start()
 void CommunicationThread::stop()
 {
 	m->run.storeRelease(0);
+	wake();
+}
+
+void CommunicationThread::wake()
+{
+	m->wakeMutex.lock();
+	m->woken = true;
+	m->wakeCondition.wakeAll();
+	m->wakeMutex.unlock();
 }
 
 }
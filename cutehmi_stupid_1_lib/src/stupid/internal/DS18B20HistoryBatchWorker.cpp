@@ -0,0 +1,141 @@
+#include "../../../include/stupid/internal/DS18B20HistoryBatchWorker.hpp"
+
+#include <QSqlQuery>
+#include <QVariant>
+#include <QDateTime>
+#include <QPair>
+#include <QVector>
+
+#include <limits>
+
+namespace cutehmi {
+namespace stupid {
+namespace internal {
+
+DS18B20HistoryBatchWorker::DS18B20HistoryBatchWorker(DatabaseThread & thread):
+	Worker(thread),
+	m(new Members{thread.dbData()->connectionName, SqlDialect::ForDriver(thread.dbData()->type), {}, 0, {}})
+{
+}
+
+DS18B20HistoryBatchWorker::~DS18B20HistoryBatchWorker()
+{
+	cancel();
+	wait();
+}
+
+void DS18B20HistoryBatchWorker::setRanges(const RangesContainer & ranges)
+{
+	m->ranges = ranges;
+}
+
+void DS18B20HistoryBatchWorker::setBucketWidth(qint64 width)
+{
+	m->bucketWidth = width;
+}
+
+const DS18B20HistoryBatchWorker::ResultsContainer & DS18B20HistoryBatchWorker::results() const
+{
+	return m->results;
+}
+
+void DS18B20HistoryBatchWorker::job(const Executor::CancellationToken & token)
+{
+	// Partial results would be cached as complete ones, so job is not interrupted.
+	Q_UNUSED(token);
+
+	m->results.clear();
+	if (m->ranges.isEmpty())
+		return;
+
+	// Resolve device identifiers and history bounds once for all devices. Bounds are evaluated per device with correlated
+	// subqueries, which can be answered from (w1_device_id, timestamp) index instead of aggregating whole history.
+	QList<QPair<int, QString>> devices;
+	QStringList w1Ids = m->ranges.keys();
+	QSqlQuery query(QSqlDatabase::database(m->connectionName, false));
+	query.prepare(QString("SELECT id, w1_id, "
+						  "(SELECT min(h.timestamp) FROM ds18b20_history h WHERE h.w1_device_id = w1_device.id), "
+						  "(SELECT max(h.timestamp) FROM ds18b20_history h WHERE h.w1_device_id = w1_device.id) "
+						  "FROM w1_device WHERE %1").arg(m->dialect.in("w1_id", ":w1Ids", w1Ids.count(), false)));
+	m->dialect.bindList(query, ":w1Ids", w1Ids, false);
+	query.exec();
+	while (query.next()) {
+		QString w1Id = query.value(1).toString();
+		devices.append(QPair<int, QString>(query.value(0).toInt(), w1Id));
+		DS18B20HistoryWorker::Results & results = m->results[w1Id];
+		results.minimum = query.isNull(2) ? 0 : query.value(2).toDateTime().toMSecsSinceEpoch();
+		results.maximum = query.isNull(3) ? 0 : query.value(3).toDateTime().toMSecsSinceEpoch();
+	}
+	if (devices.isEmpty())
+		return;
+
+	// Each range of each device is selected by its own branch of UNION ALL, so that only missing ranges are fetched and
+	// each branch can use (w1_device_id, timestamp) index. Rows are tagged with index of the range they belong to.
+	QVector<charts::PointSeries::DataContainer *> rangeData;
+	QStringList branches;
+	QList<QPair<int, HistoryCache::Range>> branchRanges;
+	qint64 from = std::numeric_limits<qint64>::max();
+	for (const QPair<int, QString> & device : devices) {
+		DS18B20HistoryWorker::Results & results = m->results[device.second];
+		for (const HistoryCache::Range & range : m->ranges.value(device.second))
+			results.segments.append(DS18B20HistoryWorker::Segment{range.first, range.second, {}});
+		for (DS18B20HistoryWorker::Segment & segment : results.segments) {
+			branches.append(QString("SELECT %1 AS range_index, timestamp, temperature FROM ds18b20_history "
+									"WHERE w1_device_id = :id%1 AND timestamp >= :from%1 AND timestamp <= :to%1").arg(rangeData.count()));
+			branchRanges.append(QPair<int, HistoryCache::Range>(device.first, HistoryCache::Range(segment.from, segment.to)));
+			rangeData.append(& segment.data);
+			from = qMin(from, segment.from);
+		}
+	}
+	if (rangeData.isEmpty())
+		return;
+
+	query.setForwardOnly(true);
+	if (m->bucketWidth > 0) {
+		// M4 aggregation, as in DS18B20HistoryWorker, but buckets are partitioned by range as well. Buckets are anchored at
+		// the epoch (see HistoryCache::BucketStart()), so they line up across ranges of all devices.
+		query.prepare(QString("SELECT range_index, timestamp, temperature FROM ("
+							  "SELECT range_index, timestamp, temperature, "
+							  "row_number() OVER (PARTITION BY range_index, bucket ORDER BY timestamp) AS first_rank, "
+							  "row_number() OVER (PARTITION BY range_index, bucket ORDER BY timestamp DESC) AS last_rank, "
+							  "row_number() OVER (PARTITION BY range_index, bucket ORDER BY temperature, timestamp) AS min_rank, "
+							  "row_number() OVER (PARTITION BY range_index, bucket ORDER BY temperature DESC, timestamp) AS max_rank "
+							  "FROM ("
+							  "SELECT range_index, timestamp, temperature, "
+							  "%1 AS bucket "
+							  "FROM (%2) AS requested"
+							  ") AS samples"
+							  ") AS ranked "
+							  "WHERE first_rank = 1 OR last_rank = 1 OR min_rank = 1 OR max_rank = 1 "
+							  "ORDER BY range_index, timestamp").arg(m->dialect.bucketIndex("timestamp", ":bucketFrom", ":bucketWidth"), branches.join(" UNION ALL ")));
+		query.bindValue(":bucketFrom", m->dialect.timestampValue(QDateTime::fromMSecsSinceEpoch(HistoryCache::BucketStart(from, m->bucketWidth))));
+		query.bindValue(":bucketWidth", m->bucketWidth);
+	} else
+		query.prepare(QString("SELECT range_index, timestamp, temperature FROM (%1) AS requested "
+							  "ORDER BY range_index, timestamp").arg(branches.join(" UNION ALL ")));
+	for (int i = 0; i < branchRanges.count(); i++) {
+		query.bindValue(QString(":id%1").arg(i), branchRanges.at(i).first);
+		query.bindValue(QString(":from%1").arg(i), m->dialect.timestampValue(QDateTime::fromMSecsSinceEpoch(branchRanges.at(i).second.first)));
+		query.bindValue(QString(":to%1").arg(i), m->dialect.timestampValue(QDateTime::fromMSecsSinceEpoch(branchRanges.at(i).second.second)));
+	}
+	query.exec();
+
+	// Rows are ordered by range, so container has to be looked up only when range changes.
+	int currentIndex = -1;
+	charts::PointSeries::DataContainer * data = nullptr;
+	while (query.next()) {
+		int index = query.value(0).toInt();
+		if (index != currentIndex) {
+			currentIndex = index;
+			data = rangeData.value(index);
+		}
+		data->append(QPointF(query.value(1).toDateTime().toMSecsSinceEpoch(), static_cast<int32_t>(query.value(2).toLongLong())));
+	}
+}
+
+}
+}
+}
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
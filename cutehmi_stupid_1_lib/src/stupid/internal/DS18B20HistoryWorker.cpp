@@ -11,18 +11,39 @@ namespace internal {
 
 DS18B20HistoryWorker::DS18B20HistoryWorker(DatabaseThread & thread, const QString & w1Id):
 	Worker(thread),
-	m(new Members{thread.dbData()->connectionName, w1Id, {0, 0, 0, 0, {}}})
+	m(new Members{thread.dbData()->connectionName, SqlDialect::ForDriver(thread.dbData()->type), w1Id, {}, 0, false, 0, {0, 0, {}}})
 {
 }
 
-void DS18B20HistoryWorker::setFrom(qint64 from)
+DS18B20HistoryWorker::~DS18B20HistoryWorker()
 {
-	m->results.from = from;
+	cancel();
+	wait();
 }
 
-void DS18B20HistoryWorker::setTo(qint64 to)
+const QString & DS18B20HistoryWorker::w1Id() const
 {
-	m->results.to = to;
+	return m->w1Id;
+}
+
+void DS18B20HistoryWorker::setRanges(const HistoryCache::RangesContainer & ranges)
+{
+	m->ranges = ranges;
+}
+
+void DS18B20HistoryWorker::setBucketWidth(qint64 width)
+{
+	m->bucketWidth = width;
+}
+
+void DS18B20HistoryWorker::setSerial(int serial)
+{
+	m->serial = serial;
+}
+
+void DS18B20HistoryWorker::setRollupsEnabled(bool enabled)
+{
+	m->rollupsEnabled = enabled;
 }
 
 const DS18B20HistoryWorker::Results & DS18B20HistoryWorker::results() const
@@ -30,7 +51,7 @@ const DS18B20HistoryWorker::Results & DS18B20HistoryWorker::results() const
 	return m->results;
 }
 
-void DS18B20HistoryWorker::job()
+void DS18B20HistoryWorker::job(const Executor::CancellationToken & token)
 {
 	QSqlQuery query(QSqlDatabase::database(m->connectionName, false));
 	query.prepare("SELECT min(timestamp), max(timestamp) FROM ds18b20_history WHERE w1_device_id = (SELECT id FROM w1_device WHERE w1_id = :w1Id LIMIT 1)");
@@ -41,18 +62,105 @@ void DS18B20HistoryWorker::job()
 		m->results.maximum = query.value(1).toDateTime().toMSecsSinceEpoch();
 	}
 
-	m->results.data.clear();
-	query.prepare("SELECT timestamp, temperature FROM ds18b20_history WHERE "
-				  "w1_device_id = (SELECT id FROM w1_device WHERE w1_id = :w1Id LIMIT 1)"
-				  "AND timestamp >= :from AND timestamp <= :to");
-	query.bindValue(":w1Id", m->w1Id);
-	query.bindValue(":from", QDateTime::fromMSecsSinceEpoch(m->results.from));
-	query.bindValue(":to", QDateTime::fromMSecsSinceEpoch(m->results.to));
-	query.exec();
-	while (query.next())
-		m->results.data.append(QPointF(query.value(0).toDateTime().toMSecsSinceEpoch(), static_cast<int32_t>(query.value(1).toLongLong())));
+	m->results.segments.clear();
+	// Coarsest rollup, which still provides at least one sample per bucket, is used for data, which has been already
+	// aggregated. Remaining data is fetched from raw history.
+	const RollupWorker::Rollup * rollup = m->rollupsEnabled ? RollupWorker::Coarsest(m->bucketWidth) : nullptr;
+	QString processed("(SELECT processed FROM ds18b20_rollup_state WHERE rollup = :rollup AND w1_device_id = (SELECT id FROM w1_device WHERE w1_id = :w1Id LIMIT 1))");
+	QString rawCondition = rollup ? QString("AND timestamp > COALESCE(%1, %2) ").arg(processed, m->dialect.minTimestamp()) : QString();
+	// Forward-only query lets the driver stream rows instead of buffering whole result set.
+	query.setForwardOnly(true);
+	for (int i = 0; (i < m->ranges.count()) && !token.isCancelled(); i++) {
+		const HistoryCache::Range & range = m->ranges.at(i);
+		Segment segment{range.first, range.second, {}};
+		charts::PointSeries::DataContainer chunk;
+		chunk.reserve(CHUNK_SIZE);
+		auto flush = [this, i, & chunk]() {
+			emit chunkFetched(m->serial, i, chunk);
+			chunk = charts::PointSeries::DataContainer();
+			chunk.reserve(CHUNK_SIZE);
+		};
+
+		if (rollup) {
+			// For each bucket select minimal and maximal value of rollup rows, which fall into the bucket. Rollup row, which
+			// begins before the range, may still contain samples from within the range, so it is included and its timestamp
+			// is clamped to the beginning of the range.
+			QString bucket = m->dialect.greatest("bucket", ":from");
+			query.prepare(QString("SELECT min(%2), min(min_temperature), max(max_temperature) FROM %1 WHERE "
+								  "w1_device_id = (SELECT id FROM w1_device WHERE w1_id = :w1Id LIMIT 1) "
+								  "AND bucket > :after AND bucket <= :to "
+								  "AND bucket <= %3 "
+								  "GROUP BY %4 "
+								  "ORDER BY 1").arg(QString(rollup->table), bucket, processed, m->dialect.bucketIndex(bucket, ":bucketFrom", ":bucketWidth")));
+			query.bindValue(":w1Id", m->w1Id);
+			query.bindValue(":from", m->dialect.timestampValue(QDateTime::fromMSecsSinceEpoch(segment.from)));
+			query.bindValue(":after", m->dialect.timestampValue(QDateTime::fromMSecsSinceEpoch(segment.from - rollup->width)));
+			query.bindValue(":to", m->dialect.timestampValue(QDateTime::fromMSecsSinceEpoch(segment.to)));
+			query.bindValue(":rollup", rollup->name);
+			query.bindValue(":bucketFrom", m->dialect.timestampValue(QDateTime::fromMSecsSinceEpoch(HistoryCache::BucketStart(segment.from, m->bucketWidth))));
+			query.bindValue(":bucketWidth", m->bucketWidth);
+			query.exec();
+			while (query.next()) {
+				qreal timestamp = query.value(0).toDateTime().toMSecsSinceEpoch();
+				chunk.append(QPointF(timestamp, static_cast<int32_t>(query.value(1).toLongLong())));
+				chunk.append(QPointF(timestamp, static_cast<int32_t>(query.value(2).toLongLong())));
+				if (chunk.count() >= CHUNK_SIZE) {
+					flush();
+					if (token.isCancelled())
+						break;
+				}
+			}
+			query.finish();
+		}
+
+		if (m->bucketWidth > 0) {
+			// For each bucket select first, last, minimal and maximal sample. Buckets are anchored at the epoch (see HistoryCache::BucketStart()).
+			query.prepare(QString("SELECT timestamp, temperature FROM ("
+								  "SELECT timestamp, temperature, "
+								  "row_number() OVER (PARTITION BY bucket ORDER BY timestamp) AS first_rank, "
+								  "row_number() OVER (PARTITION BY bucket ORDER BY timestamp DESC) AS last_rank, "
+								  "row_number() OVER (PARTITION BY bucket ORDER BY temperature, timestamp) AS min_rank, "
+								  "row_number() OVER (PARTITION BY bucket ORDER BY temperature DESC, timestamp) AS max_rank "
+								  "FROM ("
+								  "SELECT timestamp, temperature, "
+								  "%1 AS bucket "
+								  "FROM ds18b20_history WHERE "
+								  "w1_device_id = (SELECT id FROM w1_device WHERE w1_id = :w1Id LIMIT 1) "
+								  "AND timestamp >= :from AND timestamp <= :to %2"
+								  ") AS samples"
+								  ") AS ranked "
+								  "WHERE first_rank = 1 OR last_rank = 1 OR min_rank = 1 OR max_rank = 1 "
+								  "ORDER BY timestamp").arg(m->dialect.bucketIndex("timestamp", ":bucketFrom", ":bucketWidth"), rawCondition));
+			query.bindValue(":bucketFrom", m->dialect.timestampValue(QDateTime::fromMSecsSinceEpoch(HistoryCache::BucketStart(segment.from, m->bucketWidth))));
+			query.bindValue(":bucketWidth", m->bucketWidth);
+		} else
+			query.prepare("SELECT timestamp, temperature FROM ds18b20_history WHERE "
+						  "w1_device_id = (SELECT id FROM w1_device WHERE w1_id = :w1Id LIMIT 1)"
+						  "AND timestamp >= :from AND timestamp <= :to ORDER BY timestamp");
+		query.bindValue(":w1Id", m->w1Id);
+		query.bindValue(":from", m->dialect.timestampValue(QDateTime::fromMSecsSinceEpoch(segment.from)));
+		query.bindValue(":to", m->dialect.timestampValue(QDateTime::fromMSecsSinceEpoch(segment.to)));
+		if (rollup)
+			query.bindValue(":rollup", rollup->name);
+		if (!token.isCancelled())
+			query.exec();
+		while (query.isActive() && query.next()) {
+			chunk.append(QPointF(query.value(0).toDateTime().toMSecsSinceEpoch(), static_cast<int32_t>(query.value(1).toLongLong())));
+			if (chunk.count() >= CHUNK_SIZE) {
+				flush();
+				if (token.isCancelled())
+					break;
+			}
+		}
+		if (!chunk.isEmpty())
+			flush();
+		query.finish();
+		m->results.segments.append(segment);
+	}
 }
 
+constexpr int DS18B20HistoryWorker::CHUNK_SIZE;
+
 }
 }
 }
@@ -0,0 +1,37 @@
+#include "../../../include/stupid/internal/DS18B20Registry.hpp"
+
+namespace cutehmi {
+namespace stupid {
+namespace internal {
+
+void DS18B20Registry::insert(int id, DS18B20 * sensor)
+{
+	if ((id >= 0) && (id < MAX_DIRECT_ID)) {
+		if (id >= m_direct.size())
+			m_direct.resize(id + 1);
+		m_direct[id] = sensor;
+	} else
+		m_indirect.insert(id, sensor);
+	m_sensors.append(sensor);
+}
+
+const DS18B20Registry::SensorsContainer & DS18B20Registry::sensors() const
+{
+	return m_sensors;
+}
+
+void DS18B20Registry::clear()
+{
+	m_sensors.clear();
+	m_direct.clear();
+	m_indirect.clear();
+}
+
+constexpr int DS18B20Registry::MAX_DIRECT_ID;
+
+}
+}
+}
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
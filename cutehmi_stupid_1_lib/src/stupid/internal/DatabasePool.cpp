@@ -0,0 +1,127 @@
+#include "../../../include/stupid/internal/DatabasePool.hpp"
+
+namespace cutehmi {
+namespace stupid {
+namespace internal {
+
+DatabasePool::DatabasePool():
+	m(new Members)
+{
+	m->lanes[LIVE_LANE].emplace_back(new DatabaseThread);
+	m->lanes[HISTORY_LANE].emplace_back(new DatabaseThread);
+	for (int lane = 0; lane < LANES_COUNT; lane++)
+		configureLane(static_cast<lane_t>(lane));
+}
+
+DatabasePool::~DatabasePool()
+{
+	stop();
+}
+
+void DatabasePool::setLaneSize(lane_t lane, int size)
+{
+	Q_ASSERT_X(!isRunning(), __FUNCTION__, "altering lane size while pool is running");
+	Q_ASSERT_X(lane != LIVE_LANE, __FUNCTION__, "size of live lane can not be changed");
+
+	ThreadsContainer & threads = m->lanes[lane];
+	threads.clear();
+	for (int i = 0; i < size; i++)
+		threads.emplace_back(new DatabaseThread);
+	m->next[lane] = 0;
+	configureLane(lane);
+}
+
+int DatabasePool::laneSize(lane_t lane) const
+{
+	return static_cast<int>(m->lanes[lane].size());
+}
+
+void DatabasePool::moveDatabaseConnectionData(std::unique_ptr<stupid::DatabaseConnectionData> dbData)
+{
+	Q_ASSERT_X(!isRunning(), __FUNCTION__, "altering connection data while pool is running");
+
+	m->dbData = std::move(dbData);
+	for (int lane = 0; lane < LANES_COUNT; lane++)
+		configureLane(static_cast<lane_t>(lane));
+}
+
+stupid::DatabaseConnectionData * DatabasePool::dbData() const
+{
+	return m->lanes[LIVE_LANE].front()->dbData();
+}
+
+DatabaseThread & DatabasePool::liveThread()
+{
+	return *m->lanes[LIVE_LANE].front();
+}
+
+DatabaseThread & DatabasePool::thread(lane_t lane)
+{
+	if ((lane == BACKGROUND_LANE) && m->lanes[BACKGROUND_LANE].empty())
+		lane = HISTORY_LANE;
+	if (m->lanes[lane].empty())
+		lane = LIVE_LANE;
+
+	ThreadsContainer & threads = m->lanes[lane];
+	int index = m->next[lane] % static_cast<int>(threads.size());
+	m->next[lane] = index + 1;
+	return *threads[index];
+}
+
+bool DatabasePool::isRunning() const
+{
+	for (int lane = 0; lane < LANES_COUNT; lane++)
+		for (const std::unique_ptr<DatabaseThread> & thread : m->lanes[lane])
+			if (thread->isRunning())
+				return true;
+	return false;
+}
+
+void DatabasePool::start()
+{
+	static const QThread::Priority PRIORITIES[LANES_COUNT] = {QThread::HighPriority, QThread::NormalPriority, QThread::LowPriority};
+
+	for (int lane = 0; lane < LANES_COUNT; lane++)
+		for (std::unique_ptr<DatabaseThread> & thread : m->lanes[lane])
+			thread->start(PRIORITIES[lane]);
+}
+
+void DatabasePool::stop()
+{
+	for (int lane = 0; lane < LANES_COUNT; lane++)
+		for (std::unique_ptr<DatabaseThread> & thread : m->lanes[lane])
+			thread->quit();
+	for (int lane = 0; lane < LANES_COUNT; lane++)
+		for (std::unique_ptr<DatabaseThread> & thread : m->lanes[lane])
+			thread->wait();
+}
+
+void DatabasePool::configureLane(lane_t lane)
+{
+	static const char * const LANE_NAMES[LANES_COUNT] = {"live", "history", "background"};
+
+	ThreadsContainer & threads = m->lanes[lane];
+	for (std::size_t i = 0; i < threads.size(); i++) {
+		DatabaseThread * thread = threads[i].get();
+		QObject::disconnect(thread, nullptr, this, nullptr);
+		QObject::connect(thread, & DatabaseThread::error, this, & DatabasePool::error);
+		if (lane == LIVE_LANE) {
+			QObject::connect(thread, & DatabaseThread::connected, this, & DatabasePool::connected);
+			QObject::connect(thread, & DatabaseThread::disconnected, this, & DatabasePool::disconnected);
+		}
+		if (m->dbData) {
+			std::unique_ptr<stupid::DatabaseConnectionData> dbData(new stupid::DatabaseConnectionData(*m->dbData));
+			// Each thread needs its own connection. Live thread keeps original connection name.
+			if (lane != LIVE_LANE)
+				dbData->connectionName = QString("%1.%2.%3").arg(m->dbData->connectionName).arg(LANE_NAMES[lane]).arg(i);
+			thread->moveDatabaseConnectionData(std::move(dbData));
+		}
+	}
+}
+
+}
+}
+}
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
@@ -1,6 +1,9 @@
 #include "../../../include/stupid/internal/DatabaseThread.hpp"
 
 #include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QSqlDriver>
 #include <QCoreApplication>
 #include <QAbstractEventDispatcher>
 
@@ -11,6 +14,7 @@ namespace internal {
 DatabaseThread::DatabaseThread():
 	m(new Members)
 {
+	m->executor.moveToThread(this);
 }
 
 QString DatabaseThread::Error::str() const
@@ -37,6 +41,67 @@ stupid::DatabaseConnectionData * DatabaseThread::dbData() const
 	return m->dbData.get();
 }
 
+Executor & DatabaseThread::executor()
+{
+	return m->executor;
+}
+
+QSqlQuery & DatabaseThread::preparedQuery(const QString & sql)
+{
+	Q_ASSERT_X(QThread::currentThread() == this, __FUNCTION__, "prepared queries must be used from within database thread");
+
+	QHash<QString, QSqlQuery>::iterator it = m->preparedQueries.find(sql);
+	if (it == m->preparedQueries.end()) {
+		QSqlQuery query(QSqlDatabase::database(m->dbData->connectionName, false));
+		query.prepare(sql);
+		it = m->preparedQueries.insert(sql, query);
+	}
+	return *it;
+}
+
+void DatabaseThread::setNotificationChannel(const QString & channel)
+{
+	Q_ASSERT_X(!isRunning(), __FUNCTION__, "altering notification channel while database thread is running");
+
+	m->notificationChannel = channel;
+}
+
+const QString & DatabaseThread::notificationChannel() const
+{
+	return m->notificationChannel;
+}
+
+void DatabaseThread::setupSQLite(QSqlDatabase & db)
+{
+	static const char * const STATEMENTS[] = {
+		// Write-ahead log lets readers of different connections proceed concurrently with a writer.
+		"PRAGMA journal_mode=WAL",
+		"PRAGMA synchronous=NORMAL",
+		"CREATE TABLE IF NOT EXISTS w1_device (id INTEGER PRIMARY KEY, w1_id TEXT NOT NULL UNIQUE, plugged BOOLEAN NOT NULL DEFAULT 0)",
+		"CREATE TABLE IF NOT EXISTS ds18b20 (w1_device_id INTEGER PRIMARY KEY REFERENCES w1_device (id), temperature INTEGER, crc INTEGER, crc_ok BOOLEAN, timestamp TEXT)",
+		"CREATE INDEX IF NOT EXISTS ds18b20_timestamp_idx ON ds18b20 (timestamp)",
+		"CREATE TABLE IF NOT EXISTS ds18b20_history (w1_device_id INTEGER NOT NULL REFERENCES w1_device (id), temperature INTEGER NOT NULL, timestamp TEXT NOT NULL)",
+		"CREATE INDEX IF NOT EXISTS ds18b20_history_device_timestamp_idx ON ds18b20_history (w1_device_id, timestamp)",
+		// Timestamps are compared as text, so timestamps written in other formats (e.g. "YYYY-MM-DD HH:MM:SS") are
+		// normalized to the format used by SqlDialect::timestampValue().
+		"CREATE TRIGGER IF NOT EXISTS ds18b20_timestamp_insert_trg AFTER INSERT ON ds18b20 "
+		"WHEN NEW.timestamp IS NOT strftime('%Y-%m-%dT%H:%M:%f', NEW.timestamp) "
+		"BEGIN UPDATE ds18b20 SET timestamp = strftime('%Y-%m-%dT%H:%M:%f', NEW.timestamp) WHERE w1_device_id = NEW.w1_device_id; END",
+		"CREATE TRIGGER IF NOT EXISTS ds18b20_timestamp_update_trg AFTER UPDATE OF timestamp ON ds18b20 "
+		"WHEN NEW.timestamp IS NOT strftime('%Y-%m-%dT%H:%M:%f', NEW.timestamp) "
+		"BEGIN UPDATE ds18b20 SET timestamp = strftime('%Y-%m-%dT%H:%M:%f', NEW.timestamp) WHERE w1_device_id = NEW.w1_device_id; END",
+		"CREATE TRIGGER IF NOT EXISTS ds18b20_history_timestamp_insert_trg AFTER INSERT ON ds18b20_history "
+		"WHEN NEW.timestamp IS NOT strftime('%Y-%m-%dT%H:%M:%f', NEW.timestamp) "
+		"BEGIN UPDATE ds18b20_history SET timestamp = strftime('%Y-%m-%dT%H:%M:%f', NEW.timestamp) WHERE rowid = NEW.rowid; END",
+		"CREATE TABLE IF NOT EXISTS settings (daemon_sleep INTEGER)"
+	};
+
+	QSqlQuery query(db);
+	for (const char * statement : STATEMENTS)
+		if (!query.exec(statement))
+			CUTEHMI_STUPID_QWARNING("Could not set up SQLite database: " << query.lastError().text() << ".");
+}
+
 void DatabaseThread::run()
 {
 	QMutexLocker locker(& m->runLock);
@@ -50,6 +115,20 @@ void DatabaseThread::run()
 		db.setPassword(m->dbData->password);
 		if (db.open()) {
 			CUTEHMI_STUPID_QDEBUG("[TODO provide App with a UI for signaling errors] Connected with database.");
+			if (m->dbData->type == "QSQLITE")
+				setupSQLite(db);
+			if (!m->notificationChannel.isEmpty() && !db.driver()->hasFeature(QSqlDriver::EventNotifications))
+				CUTEHMI_STUPID_QWARNING("Database driver '" << m->dbData->type << "' does not support notifications.");
+			else if (!m->notificationChannel.isEmpty()) {
+				QObject::connect(db.driver(), static_cast<void (QSqlDriver::*)(const QString &, QSqlDriver::NotificationSource, const QVariant &)>(& QSqlDriver::notification),
+						[this](const QString & name, QSqlDriver::NotificationSource source, const QVariant & payload) {
+					Q_UNUSED(source);
+					if (name == m->notificationChannel)
+						emit notified(payload);
+				});
+				if (!db.driver()->subscribeToNotification(m->notificationChannel))
+					CUTEHMI_STUPID_QWARNING("Could not subscribe to notification channel '" << m->notificationChannel << "'.");
+			}
 			emit connected();
 		} else {
 			CUTEHMI_STUPID_QDEBUG("[TODO provide App with a UI for signaling errors] Could not connect with database.");
@@ -60,6 +139,10 @@ void DatabaseThread::run()
 		emit (base::errorInfo(Error(Error::NOT_CONFIGURED)));
 		exec();
 	}
+	// Jobs, which have not been processed, would wait until thread is started again.
+	m->executor.cancelAll();
+	// Prepared queries must be released before connection is removed.
+	m->preparedQueries.clear();
 	if (m->dbData) {
 		{
 			QSqlDatabase db = QSqlDatabase::database(m->dbData->connectionName, false);
@@ -0,0 +1,210 @@
+#include "../../../include/stupid/internal/Executor.hpp"
+
+#include <QCoreApplication>
+#include <QThread>
+
+namespace cutehmi {
+namespace stupid {
+namespace internal {
+
+Executor::CancellationToken::CancellationToken():
+	m_cancelled(new QAtomicInt(0))
+{
+}
+
+bool Executor::CancellationToken::isCancelled() const
+{
+	return m_cancelled->load();
+}
+
+void Executor::CancellationToken::cancel()
+{
+	m_cancelled->store(1);
+}
+
+Executor::Future::Future(QSharedPointer<Job> job):
+	m_job(job)
+{
+}
+
+bool Executor::Future::isFinished() const
+{
+	if (!m_job)
+		return true;
+
+	QMutexLocker locker(& m_job->mutex);
+	return m_job->finished;
+}
+
+bool Executor::Future::isCancelled() const
+{
+	return m_job && m_job->token.isCancelled();
+}
+
+void Executor::Future::cancel()
+{
+	if (m_job)
+		m_job->executor->cancel(m_job);
+}
+
+void Executor::Future::wait() const
+{
+	if (!m_job)
+		return;
+
+	Q_ASSERT_X(QThread::currentThread() != m_job->executor->thread(), __FUNCTION__, "waiting for a job from within executor thread");
+
+	m_job->mutex.lock();
+	while (!m_job->finished)
+		m_job->waitCondition.wait(& m_job->mutex);
+	m_job->mutex.unlock();
+}
+
+Executor::Executor(QObject * parent):
+	QObject(parent),
+	m(new Members)
+{
+}
+
+Executor::~Executor()
+{
+	cancelAll();
+}
+
+Executor::Future Executor::submit(Task task, priority_t priority, const QString & key, const QObject * context, Completion completion)
+{
+	m->queueMutex.lock();
+	QSharedPointer<Job> job(new Job(this, m->nextId++, priority, key, task));
+	m->queueMutex.unlock();
+
+	if (context && completion) {
+		// Connection is released as soon as completion has been called or context object has been destroyed.
+		quint64 id = job->id;
+		QSharedPointer<QMetaObject::Connection> connection(new QMetaObject::Connection);
+		*connection = connect(this, & Executor::jobFinished, context, [id, completion, connection](quint64 finishedId, bool cancelled) {
+			if (finishedId != id)
+				return;
+			QObject::disconnect(*connection);
+			completion(cancelled);
+		});
+	}
+
+	JobsContainer superseded;
+	m->queueMutex.lock();
+	if (!key.isEmpty()) {
+		for (JobsContainer::iterator it = m->queue.begin(); it != m->queue.end();)
+			if ((*it)->key == key) {
+				superseded.append(*it);
+				it = m->queue.erase(it);
+			} else
+				++it;
+		if (m->running && (m->running->key == key))
+			m->running->token.cancel();
+	}
+	// Queue is kept sorted by priority. Job is placed after all the jobs of same or higher priority.
+	JobsContainer::iterator pos = m->queue.begin();
+	while ((pos != m->queue.end()) && ((*pos)->priority >= priority))
+		++pos;
+	m->queue.insert(pos, job);
+	m->queueMutex.unlock();
+
+	for (QSharedPointer<Job> supersededJob : superseded) {
+		supersededJob->token.cancel();
+		finish(supersededJob);
+	}
+
+	QCoreApplication::postEvent(this, new ExecuteEvent);
+
+	return Future(job);
+}
+
+void Executor::cancelAll()
+{
+	JobsContainer cancelled;
+	m->queueMutex.lock();
+	cancelled.swap(m->queue);
+	if (m->running)
+		m->running->token.cancel();
+	m->queueMutex.unlock();
+
+	for (QSharedPointer<Job> job : cancelled) {
+		job->token.cancel();
+		finish(job);
+	}
+}
+
+int Executor::pendingCount() const
+{
+	QMutexLocker locker(& m->queueMutex);
+	return m->queue.count();
+}
+
+bool Executor::event(QEvent * event)
+{
+	if (event->type() == ExecuteEvent::RegisteredType()) {
+		m->queueMutex.lock();
+		// Queue may be already empty, if jobs have been superseded or cancelled.
+		QSharedPointer<Job> job;
+		if (!m->queue.isEmpty())
+			job = m->queue.takeFirst();
+		m->running = job;
+		m->queueMutex.unlock();
+
+		if (job) {
+			if (!job->token.isCancelled())
+				job->task(job->token);
+
+			m->queueMutex.lock();
+			m->running.reset();
+			m->queueMutex.unlock();
+
+			finish(job);
+		}
+		return true;
+	}
+
+	return Parent::event(event);
+}
+
+Executor::ExecuteEvent::ExecuteEvent():
+	QEvent(RegisteredType())
+{
+}
+
+QEvent::Type Executor::ExecuteEvent::RegisteredType() noexcept
+{
+	static const QEvent::Type type = static_cast<QEvent::Type>(QEvent::registerEventType());
+	return type;
+}
+
+void Executor::cancel(QSharedPointer<Job> job)
+{
+	job->token.cancel();
+
+	m->queueMutex.lock();
+	bool pending = m->queue.removeOne(job);
+	m->queueMutex.unlock();
+
+	// Job, which is being processed, is finished by the executor thread.
+	if (pending)
+		finish(job);
+}
+
+void Executor::finish(QSharedPointer<Job> job)
+{
+	job->mutex.lock();
+	job->finished = true;
+	// Task may hold resources captured by value, so it is released before waiting threads are woken up.
+	job->task = nullptr;
+	job->waitCondition.wakeAll();
+	job->mutex.unlock();
+
+	emit jobFinished(job->id, job->token.isCancelled());
+}
+
+}
+}
+}
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
@@ -0,0 +1,213 @@
+#include "../../../include/stupid/internal/HistoryCache.hpp"
+
+#include <limits>
+#include <algorithm>
+
+namespace cutehmi {
+namespace stupid {
+namespace internal {
+
+constexpr int HistoryCache::RAW_LEVEL;
+constexpr int HistoryCache::DEFAULT_BUDGET;
+
+int HistoryCache::Level(qint64 from, qint64 to, int buckets)
+{
+	if ((buckets <= 0) || (to <= from))
+		return RAW_LEVEL;
+
+	qint64 width = (to - from) / buckets;
+	int level = 0;
+	while ((level < 62) && ((Q_INT64_C(1) << (level + 1)) <= width))
+		level++;
+	return level;
+}
+
+qint64 HistoryCache::BucketWidth(int level)
+{
+	return level == RAW_LEVEL ? 0 : Q_INT64_C(1) << level;
+}
+
+qint64 HistoryCache::BucketStart(qint64 time, qint64 width)
+{
+	Q_ASSERT(width > 0);
+
+	// Division truncates towards zero, so negative times have to be adjusted to obtain floor().
+	qint64 index = time / width;
+	if ((time % width) < 0)
+		index--;
+	return index * width;
+}
+
+HistoryCache::HistoryCache(int budget):
+	m(new Members{{}, budget, 0, 0})
+{
+}
+
+int HistoryCache::budget() const
+{
+	return m->budget;
+}
+
+void HistoryCache::setBudget(int budget)
+{
+	m->budget = budget;
+	evict(SegmentsKey(), 0);
+}
+
+int HistoryCache::size() const
+{
+	return m->size;
+}
+
+HistoryCache::RangesContainer HistoryCache::missing(const QString & key, int level, qint64 from, qint64 to) const
+{
+	RangesContainer result;
+	qint64 cursor = from;
+	QHash<SegmentsKey, SegmentsContainer>::const_iterator segmentsIt = m->segments.constFind(SegmentsKey(key, level));
+	if (segmentsIt != m->segments.constEnd()) {
+		const SegmentsContainer & segments = segmentsIt.value();
+		// Start from the last segment beginning at or before 'from', as it may cover beginning of the range.
+		SegmentsContainer::const_iterator it = segments.upperBound(from);
+		if (it != segments.constBegin())
+			--it;
+		for (; (it != segments.constEnd()) && (it.key() <= to) && (cursor <= to); ++it) {
+			if (it.value().to < cursor)
+				continue;
+			if (it.key() > cursor)
+				result.append(Range(cursor, it.key()));
+			cursor = qMax(cursor, it.value().to);
+		}
+	}
+	if (cursor < to)
+		result.append(Range(cursor, to));
+
+	if (level != RAW_LEVEL) {
+		qint64 width = BucketWidth(level);
+		RangesContainer aligned;
+		for (const Range & range : result) {
+			// Apart from the boundaries of requested range, boundaries of gaps are cached points.
+			qint64 first = range.first == from ? range.first : range.first + 1;
+			qint64 last = range.second == to ? range.second : range.second - 1;
+			if (last < first)
+				continue;
+			Range bucketRange(BucketStart(first, width), BucketStart(last, width) + width - 1);
+			if (!aligned.isEmpty() && (aligned.last().second + 1 >= bucketRange.first))
+				aligned.last().second = qMax(aligned.last().second, bucketRange.second);
+			else
+				aligned.append(bucketRange);
+		}
+		return aligned;
+	}
+	return result;
+}
+
+void HistoryCache::insert(const QString & key, int level, qint64 from, qint64 to, const DataContainer & data)
+{
+	if (to < from)
+		return;
+
+	SegmentsKey segmentsKey(key, level);
+	SegmentsContainer & segments = m->segments[segmentsKey];
+
+	// Merge overlapping and adjacent segments into a new one.
+	Segment merged{to, DataContainer(), ++m->useCounter};
+	qint64 mergedFrom = from;
+	DataContainer before;
+	DataContainer after;
+	SegmentsContainer::iterator it = segments.upperBound(from);
+	if (it != segments.begin())
+		--it;
+	while ((it != segments.end()) && (it.key() <= to)) {
+		if (it.value().to < from) {
+			++it;
+			continue;
+		}
+		for (const QPointF & point : it.value().data)
+			if (point.x() < from)
+				before.append(point);
+			else if (point.x() > to)
+				after.append(point);
+		mergedFrom = qMin(mergedFrom, it.key());
+		merged.to = qMax(merged.to, it.value().to);
+		m->size -= it.value().data.count();
+		it = segments.erase(it);
+	}
+	merged.data.reserve(before.count() + data.count() + after.count());
+	merged.data << before << data << after;
+	m->size += merged.data.count();
+	segments.insert(mergedFrom, merged);
+
+	evict(segmentsKey, mergedFrom);
+}
+
+HistoryCache::DataContainer HistoryCache::data(const QString & key, int level, qint64 from, qint64 to)
+{
+	DataContainer result;
+	QHash<SegmentsKey, SegmentsContainer>::iterator segmentsIt = m->segments.find(SegmentsKey(key, level));
+	if (segmentsIt == m->segments.end())
+		return result;
+
+	SegmentsContainer & segments = segmentsIt.value();
+	SegmentsContainer::iterator it = segments.upperBound(from);
+	if (it != segments.begin())
+		--it;
+	for (; (it != segments.end()) && (it.key() <= to); ++it) {
+		if (it.value().to < from)
+			continue;
+		it.value().lastUsed = ++m->useCounter;
+		const DataContainer & data = it.value().data;
+		DataContainer::const_iterator first = std::lower_bound(data.begin(), data.end(), from, [](const QPointF & point, qint64 x) {
+			return point.x() < x;
+		});
+		for (DataContainer::const_iterator point = first; (point != data.end()) && (point->x() <= to); ++point)
+			result.append(*point);
+	}
+	return result;
+}
+
+void HistoryCache::remove(const QString & key)
+{
+	for (QHash<SegmentsKey, SegmentsContainer>::iterator it = m->segments.begin(); it != m->segments.end();)
+		if (it.key().first == key) {
+			for (const Segment & segment : it.value())
+				m->size -= segment.data.count();
+			it = m->segments.erase(it);
+		} else
+			++it;
+}
+
+void HistoryCache::clear()
+{
+	m->segments.clear();
+	m->size = 0;
+}
+
+void HistoryCache::evict(const SegmentsKey & keep, qint64 keepFrom)
+{
+	while (m->size > m->budget) {
+		QHash<SegmentsKey, SegmentsContainer>::iterator lruSegments = m->segments.end();
+		SegmentsContainer::iterator lru;
+		quint64 lruUsed = std::numeric_limits<quint64>::max();
+		for (QHash<SegmentsKey, SegmentsContainer>::iterator segmentsIt = m->segments.begin(); segmentsIt != m->segments.end(); ++segmentsIt)
+			for (SegmentsContainer::iterator it = segmentsIt.value().begin(); it != segmentsIt.value().end(); ++it)
+				if ((it.value().lastUsed < lruUsed) && !((segmentsIt.key() == keep) && (it.key() == keepFrom))) {
+					lruSegments = segmentsIt;
+					lru = it;
+					lruUsed = it.value().lastUsed;
+				}
+		if (lruSegments == m->segments.end())
+			break;
+
+		m->size -= lru.value().data.count();
+		lruSegments.value().erase(lru);
+		if (lruSegments.value().isEmpty())
+			m->segments.erase(lruSegments);
+	}
+}
+
+}
+}
+}
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
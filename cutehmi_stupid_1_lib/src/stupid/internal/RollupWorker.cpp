@@ -0,0 +1,176 @@
+#include "../../../include/stupid/internal/RollupWorker.hpp"
+
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QVariant>
+#include <QDateTime>
+#include <QStringList>
+
+namespace cutehmi {
+namespace stupid {
+namespace internal {
+
+const RollupWorker::Rollup & RollupWorker::Get(rollup_t rollup)
+{
+	static const Rollup ROLLUPS[ROLLUPS_COUNT] = {
+		{"minute", "ds18b20_rollup_minute", Q_INT64_C(60000)},
+		{"hour", "ds18b20_rollup_hour", Q_INT64_C(3600000)},
+		{"day", "ds18b20_rollup_day", Q_INT64_C(86400000)}
+	};
+	return ROLLUPS[rollup];
+}
+
+const RollupWorker::Rollup * RollupWorker::Coarsest(qint64 bucketWidth)
+{
+	for (int rollup = ROLLUPS_COUNT - 1; rollup >= 0; rollup--)
+		if (Get(static_cast<rollup_t>(rollup)).width <= bucketWidth)
+			return & Get(static_cast<rollup_t>(rollup));
+	return nullptr;
+}
+
+RollupWorker::RollupWorker(DatabaseThread & thread):
+	Worker(thread, Executor::LOW_PRIORITY),
+	m(new Members{thread.dbData()->connectionName, SqlDialect::ForDriver(thread.dbData()->type), false})
+{
+}
+
+RollupWorker::~RollupWorker()
+{
+	cancel();
+	wait();
+}
+
+void RollupWorker::job(const Executor::CancellationToken & token)
+{
+	if (!m->tablesCreated) {
+		m->tablesCreated = createTables();
+		if (!m->tablesCreated)
+			return;
+	}
+
+	// Bounds of history and processed timestamps of all devices are fetched with a single statement.
+	QStringList processedColumns;
+	for (int rollup = 0; rollup < ROLLUPS_COUNT; rollup++)
+		processedColumns.append(QString("(SELECT processed FROM ds18b20_rollup_state s WHERE s.w1_device_id = w1_device.id AND s.rollup = '%1')").arg(Get(static_cast<rollup_t>(rollup)).name));
+	QSqlQuery query(QSqlDatabase::database(m->connectionName, false));
+	query.setForwardOnly(true);
+	query.exec(QString("SELECT id, "
+					   "(SELECT min(h.timestamp) FROM ds18b20_history h WHERE h.w1_device_id = w1_device.id), "
+					   "(SELECT max(h.timestamp) FROM ds18b20_history h WHERE h.w1_device_id = w1_device.id), "
+					   "%1 FROM w1_device").arg(processedColumns.join(", ")));
+	struct Device
+	{
+		int id;
+		QDateTime minimum;
+		QDateTime maximum;
+		QDateTime processed[ROLLUPS_COUNT];
+	};
+	QList<Device> devices;
+	while (query.next()) {
+		if (query.isNull(1))
+			continue;
+		Device device{query.value(0).toInt(), query.value(1).toDateTime(), query.value(2).toDateTime(), {}};
+		for (int rollup = 0; rollup < ROLLUPS_COUNT; rollup++)
+			if (!query.isNull(3 + rollup))
+				device.processed[rollup] = query.value(3 + rollup).toDateTime();
+		devices.append(device);
+	}
+	query.finish();
+
+	for (const Device & device : devices)
+		for (int rollup = 0; rollup < ROLLUPS_COUNT; rollup++) {
+			const QDateTime & processed = device.processed[rollup];
+			if (processed.isValid() && (processed >= device.maximum))
+				continue;
+
+			QDateTime from = processed.isValid() ? processed.addMSecs(-OVERLAP) : device.minimum;
+			QDateTime to;
+			do {
+				if (token.isCancelled())
+					return;
+
+				to = qMin(from.addMSecs(SLICE), device.maximum);
+				if (!update(Get(static_cast<rollup_t>(rollup)), device.id, from, to))
+					return;
+				from = to;
+			} while (to < device.maximum);
+		}
+}
+
+bool RollupWorker::update(const Rollup & rollup, int deviceId, const QDateTime & from, const QDateTime & to)
+{
+	QSqlDatabase db = QSqlDatabase::database(m->connectionName, false);
+	QSqlQuery query(db);
+	QString table(rollup.table);
+
+	// Buckets are aggregated as a whole from their beginning, so existing rows are replaced rather than merged.
+	db.transaction();
+	query.prepare(QString("INSERT INTO %1 (w1_device_id, bucket, min_temperature, max_temperature, sum_temperature, samples) "
+						  "SELECT w1_device_id, %2, min(temperature), max(temperature), sum(temperature), count(*) "
+						  "FROM ds18b20_history WHERE "
+						  "w1_device_id = :deviceId AND timestamp >= %3 AND timestamp <= :to "
+						  "GROUP BY 1, 2 "
+						  "ON CONFLICT (w1_device_id, bucket) DO UPDATE SET "
+						  "min_temperature = EXCLUDED.min_temperature, "
+						  "max_temperature = EXCLUDED.max_temperature, "
+						  "sum_temperature = EXCLUDED.sum_temperature, "
+						  "samples = EXCLUDED.samples").arg(table,
+															m->dialect.truncate(rollup.name, "timestamp"),
+															m->dialect.truncate(rollup.name, m->dialect.timestamp(":from"))));
+	query.bindValue(":deviceId", deviceId);
+	query.bindValue(":from", m->dialect.timestampValue(from));
+	query.bindValue(":to", m->dialect.timestampValue(to));
+	bool ok = query.exec();
+	if (ok) {
+		query.prepare("INSERT INTO ds18b20_rollup_state (rollup, w1_device_id, processed) VALUES (:rollup, :deviceId, :processed) "
+					  "ON CONFLICT (rollup, w1_device_id) DO UPDATE SET processed = EXCLUDED.processed");
+		query.bindValue(":rollup", rollup.name);
+		query.bindValue(":deviceId", deviceId);
+		query.bindValue(":processed", m->dialect.timestampValue(to));
+		ok = query.exec();
+	}
+	if (!ok) {
+		CUTEHMI_STUPID_QWARNING("Could not update '" << rollup.name << "' rollup: " << query.lastError().text() << ".");
+		db.rollback();
+		return false;
+	}
+	return db.commit();
+}
+
+bool RollupWorker::createTables()
+{
+	QSqlQuery query(QSqlDatabase::database(m->connectionName, false));
+	if (!query.exec("CREATE TABLE IF NOT EXISTS ds18b20_rollup_state ("
+					"rollup varchar(16) NOT NULL, "
+					"w1_device_id integer NOT NULL, "
+					"processed timestamp NOT NULL, "
+					"PRIMARY KEY (rollup, w1_device_id))")) {
+		CUTEHMI_STUPID_QWARNING("Could not create rollup state table: " << query.lastError().text() << ".");
+		return false;
+	}
+	for (int rollup = 0; rollup < ROLLUPS_COUNT; rollup++) {
+		const Rollup & r = Get(static_cast<rollup_t>(rollup));
+		if (!query.exec(QString("CREATE TABLE IF NOT EXISTS %1 ("
+								"w1_device_id integer NOT NULL, "
+								"bucket timestamp NOT NULL, "
+								"min_temperature integer NOT NULL, "
+								"max_temperature integer NOT NULL, "
+								"sum_temperature bigint NOT NULL, "
+								"samples integer NOT NULL, "
+								"PRIMARY KEY (w1_device_id, bucket))").arg(r.table))) {
+			CUTEHMI_STUPID_QWARNING("Could not create '" << r.table << "' table: " << query.lastError().text() << ".");
+			return false;
+		}
+	}
+	return true;
+}
+
+constexpr int RollupWorker::OVERLAP;
+constexpr int RollupWorker::SLICE;
+
+}
+}
+}
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
@@ -0,0 +1,136 @@
+#include "../../../include/stupid/internal/SqlDialect.hpp"
+
+#include <QSqlQuery>
+
+namespace cutehmi {
+namespace stupid {
+namespace internal {
+
+SqlDialect SqlDialect::ForDriver(const QString & driverType)
+{
+	if (driverType == "QSQLITE")
+		return SqlDialect(SQLITE);
+	return SqlDialect(POSTGRESQL);
+}
+
+SqlDialect::SqlDialect(dbms_t dbms):
+	m_dbms(dbms)
+{
+}
+
+SqlDialect::dbms_t SqlDialect::dbms() const
+{
+	return m_dbms;
+}
+
+QString SqlDialect::in(const QString & expr, const QString & list, int count, bool integers) const
+{
+	switch (m_dbms) {
+		case SQLITE: {
+			Q_UNUSED(integers)
+
+			QStringList placeholders;
+			for (int i = 0; i < count; i++)
+				placeholders.append(QString("%1_%2").arg(list).arg(i));
+			return QString("%1 IN (%2)").arg(expr).arg(placeholders.join(", "));
+		}
+		default:
+			if (integers)
+				return QString("%1 = ANY(string_to_array(%2, ',')::integer[])").arg(expr).arg(list);
+			return QString("%1 = ANY(string_to_array(%2, ','))").arg(expr).arg(list);
+	}
+}
+
+void SqlDialect::bindList(QSqlQuery & query, const QString & list, const QStringList & values, bool integers) const
+{
+	switch (m_dbms) {
+		case SQLITE:
+			for (int i = 0; i < values.count(); i++)
+				query.bindValue(QString("%1_%2").arg(list).arg(i), integers ? QVariant(values.at(i).toLongLong()) : QVariant(values.at(i)));
+			break;
+		default:
+			query.bindValue(list, values.join(','));
+	}
+}
+
+QVariant SqlDialect::timestampValue(const QDateTime & dateTime) const
+{
+	switch (m_dbms) {
+		case SQLITE:
+			return dateTime.toLocalTime().toString("yyyy-MM-dd'T'HH:mm:ss.zzz");
+		default:
+			return dateTime;
+	}
+}
+
+QString SqlDialect::bucketIndex(const QString & timestamp, const QString & from, const QString & width) const
+{
+	switch (m_dbms) {
+		case SQLITE:
+			// Timestamp is not older than 'from', so truncation is equivalent to floor().
+			return QString("CAST((julianday(%1) - julianday(%2)) * 86400000.0 / %3 AS INTEGER)").arg(timestamp).arg(from).arg(width);
+		default:
+			return QString("floor(extract(epoch FROM (%1 - %2)) * 1000 / %3)").arg(timestamp).arg(from).arg(width);
+	}
+}
+
+QString SqlDialect::truncate(const QString & unit, const QString & timestamp) const
+{
+	switch (m_dbms) {
+		case SQLITE:
+			if (unit == "minute")
+				return QString("strftime('%Y-%m-%dT%H:%M:00.000', %1)").arg(timestamp);
+			else if (unit == "hour")
+				return QString("strftime('%Y-%m-%dT%H:00:00.000', %1)").arg(timestamp);
+			return QString("strftime('%Y-%m-%dT00:00:00.000', %1)").arg(timestamp);
+		default:
+			return QString("date_trunc('%1', %2)").arg(unit).arg(timestamp);
+	}
+}
+
+QString SqlDialect::timestamp(const QString & expr) const
+{
+	switch (m_dbms) {
+		case SQLITE:
+			return QString("strftime('%Y-%m-%dT%H:%M:%f', %1)").arg(expr);
+		default:
+			return QString("CAST(%1 AS timestamp)").arg(expr);
+	}
+}
+
+QString SqlDialect::greatest(const QString & expr1, const QString & expr2) const
+{
+	switch (m_dbms) {
+		case SQLITE:
+			return QString("max(%1, %2)").arg(expr1).arg(expr2);
+		default:
+			return QString("GREATEST(%1, %2)").arg(expr1).arg(expr2);
+	}
+}
+
+QString SqlDialect::least(const QString & expr1, const QString & expr2) const
+{
+	switch (m_dbms) {
+		case SQLITE:
+			return QString("min(%1, %2)").arg(expr1).arg(expr2);
+		default:
+			return QString("LEAST(%1, %2)").arg(expr1).arg(expr2);
+	}
+}
+
+QString SqlDialect::minTimestamp() const
+{
+	switch (m_dbms) {
+		case SQLITE:
+			return "''";
+		default:
+			return "'-infinity'";
+	}
+}
+
+}
+}
+}
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
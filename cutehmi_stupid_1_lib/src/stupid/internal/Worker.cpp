@@ -1,108 +1,77 @@
 #include "../../../include/stupid/internal/Worker.hpp"
 
-#include <QCoreApplication>
-
 namespace cutehmi {
 namespace stupid {
 namespace internal {
 
-Worker::Worker(std::function<void()> task):
-	m(new Members(task))
+Worker::Worker(DatabaseThread & thread, Executor::priority_t priority):
+	// Address of the worker serves as a key, so that newer job of the worker supersedes the older one.
+	m(new Members(& thread, priority, QString("Worker@%1").arg(reinterpret_cast<quintptr>(this), 0, 16)))
 {
 }
 
-Worker::Worker(QThread & thread):
-	Worker()
-{
-	employ(thread, false);
-}
-
 Worker::~Worker()
 {
-	// This acts as a failproof synchronization mechanism that prevents deletion before object finishes processing WorkEvent.
-	m->workMutex.lock();
-	m->workMutex.unlock();	// Mutex should be unlocked before it gets deleted.
-}
-
-void Worker::setTask(std::function<void()> task)
-{
-	m->task = task;
-}
-
-void Worker::job()
-{
-	if (m->task)
-		m->task();
+	Q_ASSERT_X(!isWorking(), __FUNCTION__, "worker destroyed while its job is running; derived class must cancel the job and wait for it in its destructor");
 }
 
 void Worker::wait() const
 {
-	m->stateMutex.lock();
-	if (m->state == State::WORKING)
-		// wait() uses internal mechanisms to prevent wakeAll() from waking up threads after m->stateMutex is locked.
-		m->waitCondition.wait(& m->stateMutex);
-	m->stateMutex.unlock();
+	m->futureMutex.lock();
+	Executor::Future future = m->future;
+	m->futureMutex.unlock();
+	future.wait();
 }
 
 bool Worker::isReady() const
 {
-	QMutexLocker locker(& m->stateMutex);
-	return m->state == State::READY;
+	QMutexLocker locker(& m->futureMutex);
+	return m->future.isFinished() && !m->future.isCancelled();
 }
 
 bool Worker::isWorking() const
 {
-	QMutexLocker locker(& m->stateMutex);
-	return m->state == State::WORKING;
+	QMutexLocker locker(& m->futureMutex);
+	return !m->future.isFinished();
 }
 
-void Worker::employ(QThread & thread, bool start)
+bool Worker::isCancelled() const
 {
-	moveToThread(& thread);
-	m->state = State::EMPLOYED;
-	if (start)
-		work();
+	QMutexLocker locker(& m->futureMutex);
+	return m->future.isCancelled();
 }
 
 void Worker::work()
 {
-	m->workMutex.lock();
-	m->stateMutex.lock();
-	m->state = State::WORKING;
-	m->stateMutex.unlock();
-	QCoreApplication::postEvent(this, new WorkEvent);
-}
-
-bool Worker::event(QEvent * event)
-{
-	if (event->type() == WorkEvent::RegisteredType()) {
-		job();
-		m->stateMutex.lock();
-		m->state = State::READY;
-		emit ready();
-		m->waitCondition.wakeAll();
-		m->stateMutex.unlock();
-
-//<principle id="cutehmi.stupid.AbstractWorker.event.member_access_forbidden">
-// After unlocking m->workMutex object may be deleted from its former thread.
-// From now on members of worker object must not be accessed from within itself or undefined behaviour will occur.
-		m->workMutex.unlock();
-		return true;
-//</principle>
-	}
-
-	return Parent::event(event);
-}
-
-QEvent::Type Worker::WorkEvent::RegisteredType() noexcept
-{
-	static const QEvent::Type type = static_cast<QEvent::Type>(QEvent::registerEventType());
-	return type;
-}
-
-Worker::WorkEvent::WorkEvent():
-	QEvent(RegisteredType())
+	m->futureMutex.lock();
+	int serial = ++m->serial;
+	m->futureMutex.unlock();
+
+	// Mutex can not be held while submitting, because completion of superseded job may be called directly.
+	Executor::Future future = m->thread->executor().submit([this](const Executor::CancellationToken & token) {
+		job(token);
+	}, m->priority, m->key, this, [this, serial](bool cancelled) {
+		Q_UNUSED(cancelled);
+		// Completion of superseded job is not reported.
+		m->futureMutex.lock();
+		bool current = serial == m->serial;
+		m->futureMutex.unlock();
+		if (current)
+			emit ready();
+	});
+
+	m->futureMutex.lock();
+	if (serial == m->serial)
+		m->future = future;
+	m->futureMutex.unlock();
+}
+
+void Worker::cancel()
 {
+	m->futureMutex.lock();
+	Executor::Future future = m->future;
+	m->futureMutex.unlock();
+	future.cancel();
 }
 
 }
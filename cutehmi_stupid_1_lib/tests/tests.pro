@@ -0,0 +1,6 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    tst_HistoryCache \
+    tst_Executor \
+    bench_ClientLatency
@@ -0,0 +1,223 @@
+#include <stupid/internal/Executor.hpp>
+
+#include <QtTest>
+#include <QThread>
+#include <QSemaphore>
+
+#include <memory>
+
+typedef cutehmi::stupid::internal::Executor Executor;
+
+namespace cutehmi {
+namespace stupid {
+
+/**
+ * Executor test. Covers ordering of jobs by priority, superseding of jobs with same key, cancellation and completion
+ * callbacks.
+ */
+class tst_Executor:
+	public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void priorityOrder();
+
+		void supersedeByKey();
+
+		void cancelPending();
+
+		void cancelRunning();
+
+		void cancelAll();
+
+		void completion();
+
+		void completionContextDestroyed();
+};
+
+void tst_Executor::priorityOrder()
+{
+	Executor executor;
+	QStringList order;
+	auto record = [& order](const QString & name) {
+		return [& order, name](const Executor::CancellationToken &) {
+			order.append(name);
+		};
+	};
+
+	// Jobs are not processed until events of the executor are delivered.
+	executor.submit(record("low"), Executor::LOW_PRIORITY);
+	executor.submit(record("normal 1"), Executor::NORMAL_PRIORITY);
+	executor.submit(record("high"), Executor::HIGH_PRIORITY);
+	executor.submit(record("normal 2"), Executor::NORMAL_PRIORITY);
+	QCOMPARE(executor.pendingCount(), 4);
+
+	QCoreApplication::sendPostedEvents(& executor);
+	QCOMPARE(order, QStringList({"high", "normal 1", "normal 2", "low"}));
+	QCOMPARE(executor.pendingCount(), 0);
+}
+
+void tst_Executor::supersedeByKey()
+{
+	Executor executor;
+	QStringList order;
+	QList<bool> cancelled;
+	QObject context;
+	auto record = [& order](const QString & name) {
+		return [& order, name](const Executor::CancellationToken &) {
+			order.append(name);
+		};
+	};
+	auto completion = [& cancelled](bool jobCancelled) {
+		cancelled.append(jobCancelled);
+	};
+
+	Executor::Future first = executor.submit(record("first"), Executor::NORMAL_PRIORITY, "key", & context, completion);
+	executor.submit(record("other"), Executor::NORMAL_PRIORITY, "other key");
+	Executor::Future second = executor.submit(record("second"), Executor::NORMAL_PRIORITY, "key", & context, completion);
+
+	// Superseded job is finished immediately and its completion is called from within submitting thread.
+	QVERIFY(first.isFinished());
+	QVERIFY(first.isCancelled());
+	QCOMPARE(cancelled, QList<bool>({true}));
+	QCOMPARE(executor.pendingCount(), 2);
+
+	QCoreApplication::sendPostedEvents(& executor);
+	QCOMPARE(order, QStringList({"other", "second"}));
+	QVERIFY(second.isFinished());
+	QVERIFY(!second.isCancelled());
+	QCOMPARE(cancelled, QList<bool>({true, false}));
+}
+
+void tst_Executor::cancelPending()
+{
+	Executor executor;
+	bool run = false;
+	Executor::Future future = executor.submit([& run](const Executor::CancellationToken &) {
+		run = true;
+	});
+	QVERIFY(!future.isFinished());
+
+	future.cancel();
+	QVERIFY(future.isFinished());
+	QVERIFY(future.isCancelled());
+	QCOMPARE(executor.pendingCount(), 0);
+	future.wait();
+
+	QCoreApplication::sendPostedEvents(& executor);
+	QVERIFY(!run);
+
+	// Default-constructed future does not refer to any job.
+	Executor::Future empty;
+	QVERIFY(empty.isFinished());
+	QVERIFY(!empty.isCancelled());
+	empty.cancel();
+	empty.wait();
+}
+
+void tst_Executor::cancelRunning()
+{
+	QThread thread;
+	std::unique_ptr<Executor> executor(new Executor);
+	executor->moveToThread(& thread);
+	thread.start();
+
+	QSemaphore started;
+	QAtomicInt interrupted(0);
+	Executor::Future future = executor->submit([& started, & interrupted](const Executor::CancellationToken & token) {
+		started.release();
+		while (!token.isCancelled())
+			QThread::msleep(1);
+		interrupted.store(1);
+	});
+	QVERIFY(started.tryAcquire(1, 5000));
+	QVERIFY(!future.isFinished());
+
+	// Job, which is being processed, is finished by the executor thread, once it returns.
+	future.cancel();
+	future.wait();
+	QVERIFY(future.isFinished());
+	QVERIFY(future.isCancelled());
+	QCOMPARE(interrupted.load(), 1);
+
+	thread.quit();
+	thread.wait();
+}
+
+void tst_Executor::cancelAll()
+{
+	Executor executor;
+	int run = 0;
+	auto count = [& run](const Executor::CancellationToken &) {
+		run++;
+	};
+	Executor::Future low = executor.submit(count, Executor::LOW_PRIORITY);
+	Executor::Future high = executor.submit(count, Executor::HIGH_PRIORITY, "key");
+
+	executor.cancelAll();
+	QCOMPARE(executor.pendingCount(), 0);
+	QVERIFY(low.isFinished() && low.isCancelled());
+	QVERIFY(high.isFinished() && high.isCancelled());
+
+	QCoreApplication::sendPostedEvents(& executor);
+	QCOMPARE(run, 0);
+
+	// Executor accepts new jobs after cancellation.
+	Executor::Future next = executor.submit(count);
+	QCoreApplication::sendPostedEvents(& executor);
+	QCOMPARE(run, 1);
+	QVERIFY(next.isFinished() && !next.isCancelled());
+}
+
+void tst_Executor::completion()
+{
+	QThread thread;
+	std::unique_ptr<Executor> executor(new Executor);
+	executor->moveToThread(& thread);
+	thread.start();
+
+	// Completion is called from within thread of the context object.
+	QObject context;
+	QThread * taskThread = nullptr;
+	QThread * completionThread = nullptr;
+	QList<bool> cancelled;
+	executor->submit([& taskThread](const Executor::CancellationToken &) {
+		taskThread = QThread::currentThread();
+	}, Executor::NORMAL_PRIORITY, QString(), & context, [& completionThread, & cancelled](bool jobCancelled) {
+		completionThread = QThread::currentThread();
+		cancelled.append(jobCancelled);
+	});
+	QTRY_COMPARE(cancelled, QList<bool>({false}));
+	QCOMPARE(taskThread, & thread);
+	QCOMPARE(completionThread, QThread::currentThread());
+
+	thread.quit();
+	thread.wait();
+}
+
+void tst_Executor::completionContextDestroyed()
+{
+	Executor executor;
+	bool called = false;
+	std::unique_ptr<QObject> context(new QObject);
+	Executor::Future future = executor.submit([](const Executor::CancellationToken &) {
+	}, Executor::NORMAL_PRIORITY, QString(), context.get(), [& called](bool) {
+		called = true;
+	});
+
+	context.reset();
+	QCoreApplication::sendPostedEvents(& executor);
+	QVERIFY(future.isFinished());
+	QVERIFY(!called);
+}
+
+}
+}
+
+QTEST_GUILESS_MAIN(cutehmi::stupid::tst_Executor)
+
+#include "tst_Executor.moc"
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
@@ -0,0 +1,18 @@
+include(../../../common.pri)
+
+TEMPLATE = app
+TARGET = tst_Executor
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+QT -= gui
+QT += testlib qml concurrent sql
+
+include(../../../cutehmi_utils_1_lib/import.pri)
+include(../../../cutehmi_base_1_lib/import.pri)
+include(../../../cutehmi_services_1_lib/import.pri)
+include(../../../cutehmi_charts_1_lib/import.pri)
+include(../../import.pri)
+
+SOURCES += \
+    tst_Executor.cpp
@@ -0,0 +1,275 @@
+#include <stupid/internal/HistoryCache.hpp>
+
+#include <QtTest>
+
+typedef cutehmi::stupid::internal::HistoryCache::RangesContainer RangesContainer;
+typedef cutehmi::stupid::internal::HistoryCache::DataContainer DataContainer;
+
+Q_DECLARE_METATYPE(RangesContainer)
+
+namespace cutehmi {
+namespace stupid {
+
+/**
+ * History cache test. Covers merging of segments, eviction of least recently used segments and alignment of downsampled
+ * ranges to bucket boundaries.
+ */
+class tst_HistoryCache:
+	public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void level_data();
+
+		void level();
+
+		void bucketStart_data();
+
+		void bucketStart();
+
+		void missingRaw();
+
+		void missingAligned_data();
+
+		void missingAligned();
+
+		void mergeAdjacent();
+
+		void mergeOverlapping();
+
+		void separateLevels();
+
+		void evictLeastRecentlyUsed();
+
+		void keepInsertedSegment();
+
+		void shrinkBudget();
+
+		void remove();
+
+	private:
+		typedef internal::HistoryCache HistoryCache;
+		typedef HistoryCache::Range Range;
+
+		static DataContainer Points(std::initializer_list<qreal> xs, qreal y = 0.0);
+};
+
+DataContainer tst_HistoryCache::Points(std::initializer_list<qreal> xs, qreal y)
+{
+	DataContainer result;
+	for (qreal x : xs)
+		result.append(QPointF(x, y));
+	return result;
+}
+
+void tst_HistoryCache::level_data()
+{
+	QTest::addColumn<qint64>("from");
+	QTest::addColumn<qint64>("to");
+	QTest::addColumn<int>("buckets");
+	QTest::addColumn<int>("level");
+
+	QTest::newRow("raw") << Q_INT64_C(0) << Q_INT64_C(1000) << 0 << int(HistoryCache::RAW_LEVEL);
+	QTest::newRow("empty range") << Q_INT64_C(1000) << Q_INT64_C(1000) << 10 << int(HistoryCache::RAW_LEVEL);
+	QTest::newRow("width 100") << Q_INT64_C(0) << Q_INT64_C(1000) << 10 << 6;
+	QTest::newRow("width 1") << Q_INT64_C(0) << Q_INT64_C(1000) << 1000 << 0;
+	QTest::newRow("width below 1") << Q_INT64_C(0) << Q_INT64_C(1000) << 2000 << 0;
+	QTest::newRow("shifted window") << Q_INT64_C(5000) << Q_INT64_C(6000) << 10 << 6;
+}
+
+void tst_HistoryCache::level()
+{
+	QFETCH(qint64, from);
+	QFETCH(qint64, to);
+	QFETCH(int, buckets);
+	QFETCH(int, level);
+
+	QCOMPARE(HistoryCache::Level(from, to, buckets), level);
+	if (level != HistoryCache::RAW_LEVEL)
+		QVERIFY(HistoryCache::BucketWidth(level) <= qMax(Q_INT64_C(1), (to - from) / buckets));
+}
+
+void tst_HistoryCache::bucketStart_data()
+{
+	QTest::addColumn<qint64>("time");
+	QTest::addColumn<qint64>("width");
+	QTest::addColumn<qint64>("start");
+
+	QTest::newRow("zero") << Q_INT64_C(0) << Q_INT64_C(64) << Q_INT64_C(0);
+	QTest::newRow("end of first bucket") << Q_INT64_C(63) << Q_INT64_C(64) << Q_INT64_C(0);
+	QTest::newRow("beginning of second bucket") << Q_INT64_C(64) << Q_INT64_C(64) << Q_INT64_C(64);
+	QTest::newRow("inside bucket") << Q_INT64_C(130) << Q_INT64_C(64) << Q_INT64_C(128);
+	QTest::newRow("negative") << Q_INT64_C(-1) << Q_INT64_C(64) << Q_INT64_C(-64);
+	QTest::newRow("negative boundary") << Q_INT64_C(-64) << Q_INT64_C(64) << Q_INT64_C(-64);
+	QTest::newRow("negative inside bucket") << Q_INT64_C(-65) << Q_INT64_C(64) << Q_INT64_C(-128);
+	QTest::newRow("epoch milliseconds") << Q_INT64_C(1500000000123) << Q_INT64_C(1024) << Q_INT64_C(1500000000000);
+}
+
+void tst_HistoryCache::bucketStart()
+{
+	QFETCH(qint64, time);
+	QFETCH(qint64, width);
+	QFETCH(qint64, start);
+
+	QCOMPARE(HistoryCache::BucketStart(time, width), start);
+}
+
+void tst_HistoryCache::missingRaw()
+{
+	HistoryCache cache;
+	QCOMPARE(cache.missing("a", HistoryCache::RAW_LEVEL, 0, 100), RangesContainer({Range(0, 100)}));
+
+	cache.insert("a", HistoryCache::RAW_LEVEL, 10, 20, Points({10, 15, 20}));
+	cache.insert("a", HistoryCache::RAW_LEVEL, 40, 50, Points({45}));
+	QCOMPARE(cache.missing("a", HistoryCache::RAW_LEVEL, 0, 100), RangesContainer({Range(0, 10), Range(20, 40), Range(50, 100)}));
+	QCOMPARE(cache.missing("a", HistoryCache::RAW_LEVEL, 12, 18), RangesContainer());
+	QCOMPARE(cache.missing("b", HistoryCache::RAW_LEVEL, 12, 18), RangesContainer({Range(12, 18)}));
+}
+
+void tst_HistoryCache::missingAligned_data()
+{
+	QTest::addColumn<RangesContainer>("cached");
+	QTest::addColumn<qint64>("from");
+	QTest::addColumn<qint64>("to");
+	QTest::addColumn<RangesContainer>("missing");
+
+	// Level 4 has buckets of 16 ms.
+	QTest::newRow("empty cache") << RangesContainer() << Q_INT64_C(5) << Q_INT64_C(40) << RangesContainer({Range(0, 47)});
+	QTest::newRow("cached head") << RangesContainer({Range(0, 31)}) << Q_INT64_C(5) << Q_INT64_C(40) << RangesContainer({Range(32, 47)});
+	QTest::newRow("gap between buckets") << RangesContainer({Range(0, 31), Range(48, 63)}) << Q_INT64_C(5) << Q_INT64_C(60) << RangesContainer({Range(32, 47)});
+	QTest::newRow("partially cached bucket") << RangesContainer({Range(20, 25)}) << Q_INT64_C(0) << Q_INT64_C(40) << RangesContainer({Range(0, 47)});
+	QTest::newRow("everything cached") << RangesContainer({Range(0, 63)}) << Q_INT64_C(5) << Q_INT64_C(60) << RangesContainer();
+}
+
+void tst_HistoryCache::missingAligned()
+{
+	static constexpr int LEVEL = 4;
+
+	QFETCH(RangesContainer, cached);
+	QFETCH(qint64, from);
+	QFETCH(qint64, to);
+	QFETCH(RangesContainer, missing);
+
+	HistoryCache cache;
+	for (const Range & range : cached)
+		cache.insert("a", LEVEL, range.first, range.second, Points({static_cast<qreal>(range.first)}));
+
+	RangesContainer result = cache.missing("a", LEVEL, from, to);
+	QCOMPARE(result, missing);
+	for (const Range & range : result) {
+		QCOMPARE(HistoryCache::BucketStart(range.first, HistoryCache::BucketWidth(LEVEL)), range.first);
+		QCOMPARE(HistoryCache::BucketStart(range.second + 1, HistoryCache::BucketWidth(LEVEL)), range.second + 1);
+	}
+}
+
+void tst_HistoryCache::mergeAdjacent()
+{
+	HistoryCache cache;
+	cache.insert("a", HistoryCache::RAW_LEVEL, 0, 10, Points({0, 5}));
+	cache.insert("a", HistoryCache::RAW_LEVEL, 10, 20, Points({10, 15, 20}));
+
+	QCOMPARE(cache.size(), 5);
+	QCOMPARE(cache.missing("a", HistoryCache::RAW_LEVEL, 0, 20), RangesContainer());
+	QCOMPARE(cache.data("a", HistoryCache::RAW_LEVEL, 0, 20), Points({0, 5, 10, 15, 20}));
+	QCOMPARE(cache.data("a", HistoryCache::RAW_LEVEL, 4, 16), Points({5, 10, 15}));
+}
+
+void tst_HistoryCache::mergeOverlapping()
+{
+	HistoryCache cache;
+	cache.insert("a", HistoryCache::RAW_LEVEL, 0, 10, Points({0, 5, 10}, 1.0));
+	// Points of the cached segment, which fall into the inserted range, are replaced.
+	cache.insert("a", HistoryCache::RAW_LEVEL, 3, 7, Points({4}, 2.0));
+
+	QCOMPARE(cache.size(), 3);
+	QCOMPARE(cache.data("a", HistoryCache::RAW_LEVEL, 0, 10), DataContainer({QPointF(0, 1.0), QPointF(4, 2.0), QPointF(10, 1.0)}));
+
+	// Segment spanning over several segments merges all of them.
+	cache.insert("a", HistoryCache::RAW_LEVEL, 20, 30, Points({25}, 1.0));
+	cache.insert("a", HistoryCache::RAW_LEVEL, 8, 22, Points({8, 22}, 3.0));
+	QCOMPARE(cache.missing("a", HistoryCache::RAW_LEVEL, 0, 30), RangesContainer());
+	QCOMPARE(cache.data("a", HistoryCache::RAW_LEVEL, 0, 30), DataContainer({QPointF(0, 1.0), QPointF(4, 2.0), QPointF(8, 3.0), QPointF(22, 3.0), QPointF(25, 1.0)}));
+	QCOMPARE(cache.size(), 5);
+}
+
+void tst_HistoryCache::separateLevels()
+{
+	HistoryCache cache;
+	cache.insert("a", HistoryCache::RAW_LEVEL, 0, 10, Points({0, 10}));
+	cache.insert("a", 2, 0, 10, Points({0, 4, 8}));
+	cache.insert("b", HistoryCache::RAW_LEVEL, 0, 10, Points({5}));
+
+	QCOMPARE(cache.size(), 6);
+	QCOMPARE(cache.data("a", HistoryCache::RAW_LEVEL, 0, 10), Points({0, 10}));
+	QCOMPARE(cache.data("a", 2, 0, 10), Points({0, 4, 8}));
+	QCOMPARE(cache.data("b", HistoryCache::RAW_LEVEL, 0, 10), Points({5}));
+}
+
+void tst_HistoryCache::evictLeastRecentlyUsed()
+{
+	HistoryCache cache(4);
+	cache.insert("a", HistoryCache::RAW_LEVEL, 0, 10, Points({0, 10}));
+	cache.insert("a", HistoryCache::RAW_LEVEL, 20, 30, Points({20, 30}));
+	QCOMPARE(cache.size(), 4);
+
+	// Accessing first segment makes the second one least recently used.
+	cache.data("a", HistoryCache::RAW_LEVEL, 0, 10);
+	cache.insert("b", HistoryCache::RAW_LEVEL, 40, 50, Points({40, 50}));
+
+	QCOMPARE(cache.size(), 4);
+	QCOMPARE(cache.missing("a", HistoryCache::RAW_LEVEL, 0, 10), RangesContainer());
+	QCOMPARE(cache.missing("a", HistoryCache::RAW_LEVEL, 20, 30), RangesContainer({Range(20, 30)}));
+	QCOMPARE(cache.missing("b", HistoryCache::RAW_LEVEL, 40, 50), RangesContainer());
+}
+
+void tst_HistoryCache::keepInsertedSegment()
+{
+	HistoryCache cache(1);
+	cache.insert("a", HistoryCache::RAW_LEVEL, 0, 10, Points({0}));
+	// Segment, which has been just inserted, is kept even if it exceeds the budget on its own.
+	cache.insert("a", HistoryCache::RAW_LEVEL, 20, 30, Points({20, 25, 30}));
+
+	QCOMPARE(cache.size(), 3);
+	QCOMPARE(cache.missing("a", HistoryCache::RAW_LEVEL, 0, 10), RangesContainer({Range(0, 10)}));
+	QCOMPARE(cache.data("a", HistoryCache::RAW_LEVEL, 20, 30), Points({20, 25, 30}));
+}
+
+void tst_HistoryCache::shrinkBudget()
+{
+	HistoryCache cache;
+	cache.insert("a", HistoryCache::RAW_LEVEL, 0, 10, Points({0, 10}));
+	cache.insert("b", HistoryCache::RAW_LEVEL, 0, 10, Points({0, 10}));
+	QCOMPARE(cache.size(), 4);
+
+	cache.setBudget(2);
+	QCOMPARE(cache.size(), 2);
+	cache.setBudget(0);
+	QCOMPARE(cache.size(), 0);
+}
+
+void tst_HistoryCache::remove()
+{
+	HistoryCache cache;
+	cache.insert("a", HistoryCache::RAW_LEVEL, 0, 10, Points({0, 10}));
+	cache.insert("a", 3, 0, 10, Points({0}));
+	cache.insert("b", HistoryCache::RAW_LEVEL, 0, 10, Points({5}));
+
+	cache.remove("a");
+	QCOMPARE(cache.size(), 1);
+	QCOMPARE(cache.missing("a", 3, 0, 7), RangesContainer({Range(0, 7)}));
+	QCOMPARE(cache.data("b", HistoryCache::RAW_LEVEL, 0, 10), Points({5}));
+
+	cache.clear();
+	QCOMPARE(cache.size(), 0);
+}
+
+}
+}
+
+QTEST_GUILESS_MAIN(cutehmi::stupid::tst_HistoryCache)
+
+#include "tst_HistoryCache.moc"
+
+//(c)MP: Copyright © 2017, Michal Policht. All rights reserved.
+//(c)MP: This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/.